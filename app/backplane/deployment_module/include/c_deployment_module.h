@@ -3,7 +3,7 @@
 
 // F-Core Includes
 #include <f_core/c_project_configuration.h>
-#include <f_core/os/c_task.h>
+#include <f_core/os/c_static_task.h>
 #include <f_core/os/flight_log.hpp>
 #include <f_core/os/tenants/c_datalogger_tenant.h>
 #include <n_autocoder_network_defs.h>
@@ -46,7 +46,7 @@ class CDeploymentModule : public CProjectConfiguration {
     // TODO: Tenant for listening to events
 
     // Tasks
-    CTask networkTask{"Networking Task", 15, 1024, 0};
+    CStaticTask<1024, 1> networkTask{"Networking Task", 15, 0};
 };
 
 #endif //C_DEPLOYMENT_MODULE_H
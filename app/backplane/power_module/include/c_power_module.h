@@ -8,7 +8,11 @@
 // F-Core Includes
 #include <f_core/c_project_configuration.h>
 #include <f_core/messaging/c_message_port.h>
-#include <f_core/os/c_task.h>
+#include <f_core/messaging/c_topic.h>
+#include <f_core/net/application/c_message_port_stats_tenant.h>
+#include <f_core/net/application/c_tenant_profile_tenant.h>
+#include <f_core/os/c_framed_datalogger.h>
+#include <f_core/os/c_static_task.h>
 #include <f_core/os/tenants/c_datalogger_tenant.h>
 #include <f_core/net/application/c_udp_alert_tenant.h>
 #include <f_core/net/application/c_udp_broadcast_tenant.h>
@@ -46,22 +50,33 @@ public:
 private:
     const char* ipAddrStr = (CREATE_IP_ADDR(NNetworkDefs::POWER_MODULE_IP_ADDR_BASE, 2, CONFIG_MODULE_ID)).c_str();
     static constexpr int telemetryBroadcastPort = NNetworkDefs::POWER_MODULE_INA_DATA_PORT;
+    static constexpr uint32_t dataLogFlushIntervalMs = 1000;
+    static constexpr std::size_t sensorDataQueueLength = 10;
+    static constexpr std::size_t sensorDataPoolSize = 2 * sensorDataQueueLength + 1;
 
     // Message Ports
-    CMessagePort<NTypes::SensorData>& sensorDataBroadcastMessagePort;
-    CMessagePort<NTypes::SensorData>& sensorDataLogMessagePort;
+    // Each sample is published once. The broadcast tenant and the logger read the same copy
+    CTopic<NTypes::SensorData, sensorDataPoolSize> sensorDataTopic;
+    CTopicSubscriber<NTypes::SensorData, sensorDataQueueLength> sensorDataBroadcastSubscriber{sensorDataTopic,
+                                                                                            TopicOverflow::Block,
+                                                                                            "ina_bcast"};
+    CTopicSubscriber<NTypes::SensorData, sensorDataQueueLength> sensorDataLogSubscriber{sensorDataTopic,
+                                                                                      TopicOverflow::Block, "ina_log"};
 
     // Tenants
-    CSensingTenant sensingTenant{"Sensing Tenant", sensorDataBroadcastMessagePort, sensorDataLogMessagePort};
-    CUdpBroadcastTenant<NTypes::SensorData> broadcastTenant{"Broadcast Tenant", ipAddrStr, telemetryBroadcastPort, telemetryBroadcastPort, sensorDataBroadcastMessagePort};
-    CDataLoggerTenant<NTypes::SensorData> dataLoggerTenant{"Data Logger Tenant", "/lfs/sensor_data.bin", LogMode::Growing, 0, sensorDataLogMessagePort};
+    CSensingTenant sensingTenant{"Sensing Tenant", sensorDataTopic, sensorDataLogSubscriber};
+    CUdpBroadcastTenant<NTypes::SensorData> broadcastTenant{"Broadcast Tenant", ipAddrStr, telemetryBroadcastPort, telemetryBroadcastPort, sensorDataBroadcastSubscriber};
+    // Logging is switched on and off by alerts, so every sample is framed with its uptime to make the gaps visible
+    CDataLoggerTenant<NTypes::SensorData, 0, CFramedDataLogger<NTypes::SensorData>> dataLoggerTenant{"Data Logger Tenant", "/lfs/sensor_data.flog", sensorDataLogSubscriber, dataLogFlushIntervalMs, true};
     CTftpServerTenant tftpServerTenant = *CTftpServerTenant::getInstance(CIPv4(ipAddrStr));
     CUdpAlertTenant alertTenant{"Alert Tenant", ipAddrStr, NNetworkDefs::ALERT_PORT};
+    CMessagePortStatsTenant statsTenant{"Message Port Stats Tenant", ipAddrStr, NNetworkDefs::STATS_PORT};
+    CTenantProfileTenant profileTenant{"Tenant Profile Tenant", ipAddrStr, NNetworkDefs::PROFILE_PORT};
 
     // Tasks
-    CTask networkTask{"Networking Task", 15, 3072, 0};
-    CTask sensingTask{"Sensing Task", 15, 1024, 0};
-    CTask dataLoggingTask{"Data Logging Task", 15, 1500, 0};
+    CStaticTask<3072, 5> networkTask{"Networking Task", 15, 0};
+    CStaticTask<1024, 1> sensingTask{"Sensing Task", 15, 0};
+    CStaticTask<1500, 1> dataLoggingTask{"Data Logging Task", 15, 0};
 };
 
 
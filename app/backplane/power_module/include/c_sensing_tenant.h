@@ -4,13 +4,22 @@
 #include <n_autocoder_types.h>
 
 #include <f_core/messaging/c_message_port.h>
+#include <f_core/messaging/c_topic.h>
 #include <f_core/os/c_tenant.h>
 #include <f_core/utils/c_observer.h>
 
 class CSensingTenant : public CTenant, public CObserver {
 public:
-    explicit CSensingTenant(const char* name, CMessagePort<NTypes::SensorData> &dataToBroadcast, CMessagePort<NTypes::SensorData> &dataToLog)
-        : CTenant(name), dataToBroadcast(dataToBroadcast), dataToLog(dataToLog) {}
+    /**
+     * Constructor
+     * @param name Name of the tenant
+     * @param sensorData Port each sample is published to (the sensor data topic)
+     * @param logSubscription Subscription of the logger to the topic. Only resumed between boost and landing
+     */
+    explicit CSensingTenant(const char* name, CMessagePort<NTypes::SensorData> &sensorData, CTopicSubscription<NTypes::SensorData> &logSubscription)
+        : CTenant(name), sensorData(sensorData), logSubscription(logSubscription) {
+        logSubscription.Pause();
+    }
 
     ~CSensingTenant() override = default;
 
@@ -23,9 +32,8 @@ public:
     void Notify(void *ctx) override;
 
 private:
-    CMessagePort<NTypes::SensorData> &dataToBroadcast;
-    CMessagePort<NTypes::SensorData> &dataToLog;
-    bool logData = false;
+    CMessagePort<NTypes::SensorData> &sensorData;
+    CTopicSubscription<NTypes::SensorData> &logSubscription;
 };
 
 
@@ -4,21 +4,16 @@
 
 // F-Core Tenant
 #include <f_core/os/n_rtos.h>
-#include <f_core/messaging/c_msgq_message_port.h>
 
-K_MSGQ_DEFINE(broadcastQueue, sizeof(NTypes::SensorData), 10, 4);
-static auto broadcastMsgQueue = CMsgqMessagePort<NTypes::SensorData>(broadcastQueue);
-
-K_MSGQ_DEFINE(dataLogQueue, sizeof(NTypes::SensorData), 10, 4);
-static auto dataLogMsgQueue = CMsgqMessagePort<NTypes::SensorData>(dataLogQueue);
-
-CPowerModule::CPowerModule() : CProjectConfiguration(), sensorDataBroadcastMessagePort(broadcastMsgQueue), sensorDataLogMessagePort(dataLogMsgQueue) {}
+CPowerModule::CPowerModule() : CProjectConfiguration() {}
 
 void CPowerModule::AddTenantsToTasks() {
     // Networking
     networkTask.AddTenant(broadcastTenant);
     networkTask.AddTenant(tftpServerTenant);
     networkTask.AddTenant(alertTenant);
+    networkTask.AddTenant(statsTenant);
+    networkTask.AddTenant(profileTenant);
 
     // Sensing
     sensingTask.AddTenant(sensingTenant);
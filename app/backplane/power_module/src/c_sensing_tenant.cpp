@@ -58,24 +58,19 @@ void CSensingTenant::Run() {
     data.Rail5v0.Power = shunt5v0.GetSensorValueFloat(SENSOR_CHAN_POWER);
 #endif
 
-    dataToBroadcast.Send(data, K_MSEC(5));
-
-    if (logData) {
-        dataToLog.Send(data, K_MSEC(5));
-    }
+    sensorData.Send(data, K_MSEC(5));
 }
 
 void CSensingTenant::Notify(void *ctx) {
-    // TODO: Knock, knock! Race condition...
     switch (*static_cast<NAlerts::AlertType*>(ctx)) {
         case NAlerts::BOOST:
             LOG_INF("Boost detected. Logging data.");
-            logData = true;
+            logSubscription.Resume();
             break;
 
         case NAlerts::LANDED:
             LOG_INF("Landing detected. Disabling logging.");
-            logData = false;
+            logSubscription.Pause();
             break;
 
         default:
@@ -15,6 +15,9 @@ void shutoffTimerExpirationFn(k_timer* timer);
 
 class CLoraReceiveTenant : public CTenant, public CPadFlightLandedStateMachine {
 public:
+    // Longest receive() waits for a packet
+    static constexpr uint32_t receiveTimeoutMs = 3000;
+
     explicit CLoraReceiveTenant(const char* name, CLoraTransmitTenant& loraTransmitTenant, const char* ip, const uint16_t srcPort)
         : CTenant(name), loraTransmitTenant(loraTransmitTenant), udp(CUdpSocket(CIPv4(ip), srcPort, srcPort)) {}
 
@@ -2,13 +2,31 @@
 #define C_LORA_TRANSMIT_TENANT_H
 
 #include "n_radio_module_types.h"
+#include <f_core/messaging/c_mailbox_port.h>
 #include <f_core/messaging/c_message_port.h>
+#include <f_core/messaging/c_pooled_message_port.h>
 #include <f_core/os/c_tenant.h>
 
 #include <f_core/radio/c_lora.h>
 #include <f_core/c_pad_flight_landing_state_machine.h>
 #include <f_core/utils/c_observer.h>
-#include <f_core/utils/c_hashmap.h>
+#include <f_core/utils/c_flat_map.h>
+
+#include <array>
+#include <n_autocoder_network_defs.h>
+
+/**
+ * Ports whose latest data the rocket sends over LoRa
+ */
+static constexpr std::array<uint16_t, 3> loraBroadcastPorts = {NNetworkDefs::POWER_MODULE_INA_DATA_PORT,
+                                                               NNetworkDefs::RADIO_MODULE_GNSS_DATA_PORT,
+                                                               NNetworkDefs::SENSOR_MODULE_TELEMETRY_PORT};
+
+/**
+ * Latest data from each of the loraBroadcastPorts
+ */
+using LoraBroadcastMailbox =
+    CKeyedMailboxPort<NTypes::RadioBroadcastData, &NTypes::RadioBroadcastData::port, loraBroadcastPorts.size()>;
 
 class CLoraTransmitTenant : public CTenant, public CPadFlightLandedStateMachine {
 public:
@@ -18,6 +36,19 @@ public:
                                  CMessagePort<NTypes::RadioBroadcastData>* loraTransmitPort)
         : CTenant(name), lora(lora), loraTransmitPort(*loraTransmitPort) {}
 
+    /**
+     * Constructor for transmitting the latest data of each port, so requests on the pad get the freshest data
+     */
+    explicit CLoraTransmitTenant(const char* name, CLora& lora, LoraBroadcastMailbox* loraBroadcastMailbox)
+        : CTenant(name), lora(lora), loraTransmitPort(*loraBroadcastMailbox), latestPortData(loraBroadcastMailbox) {}
+
+    /**
+     * Constructor for transmitting packets straight out of pooled buffers, without copying them out first
+     */
+    explicit CLoraTransmitTenant(const char* name, CLora& lora,
+                                 CPooledMessagePortBase<NTypes::RadioBroadcastData>* loraTransmitPool)
+        : CTenant(name), lora(lora), loraTransmitPort(*loraTransmitPool), loraTransmitPool(loraTransmitPool) {}
+
     ~CLoraTransmitTenant() override = default;
 
     /**
@@ -56,8 +87,6 @@ public:
     void GroundRun() override;
 
 private:
-    static constexpr uint8_t totalPortsListenedTo = 3;
-
     /**
      * Helper function for converting struct into a uint8_t buffer and transmitting over LoRa
      * @param[in] data Radio broadcast data structure
@@ -73,8 +102,10 @@ private:
 
     CLora& lora;
     CMessagePort<NTypes::RadioBroadcastData>& loraTransmitPort;
-    CHashMap<uint16_t, NTypes::RadioBroadcastData> portDataMap; // 254 bytes to leave room for port
-    CHashMap<uint16_t, bool> padDataRequestedMap;
+    LoraBroadcastMailbox* latestPortData = nullptr;
+    CPooledMessagePortBase<NTypes::RadioBroadcastData>* loraTransmitPool = nullptr;
+    // Every port that can be requested is known up front, so the map is filled when it's constructed
+    CFlatMap<uint16_t, bool, loraBroadcastPorts.size()> padDataRequestedMap{loraBroadcastPorts, false};
 };
 
 #endif //C_LORA_TRANSMIT_TENANT_H
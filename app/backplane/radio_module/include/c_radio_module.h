@@ -14,9 +14,12 @@
 #include <f_core/c_project_configuration.h>
 #include <f_core/net/application/c_tftp_server_tenant.h>
 #include <f_core/messaging/c_message_port.h>
+#include <f_core/net/application/c_message_port_stats_tenant.h>
+#include <f_core/net/application/c_tenant_profile_tenant.h>
 #include <f_core/net/application/c_udp_alert_tenant.h>
-#include <f_core/os/c_task.h>
+#include <f_core/os/c_static_task.h>
 #include <f_core/os/tenants/c_datalogger_tenant.h>
+#include <f_core/os/tenants/c_health_monitor_tenant.h>
 #include <f_core/radio/c_lora.h>
 
 // Autocoder Includes
@@ -50,6 +53,10 @@ private:
     static constexpr uint16_t powerModuleTelemetryPort = NNetworkDefs::POWER_MODULE_INA_DATA_PORT;
     static constexpr uint16_t radioModuleSourcePort = NNetworkDefs::RADIO_BASE_PORT;
     static constexpr uint16_t sensorModuleTelemetryPort = NNetworkDefs::SENSOR_MODULE_TELEMETRY_PORT;
+    static constexpr uint32_t healthCheckIntervalMs = 100;
+    // Longest a single LoRa transmit or receive should block before the radio is considered hung. Time spent waiting
+    // for a packet counts, so this has to sit above the receive timeout
+    static constexpr uint32_t loraDeadlineMs = CLoraReceiveTenant::receiveTimeoutMs + 1000;
 
     // Devices
 #ifndef CONFIG_ARCH_POSIX
@@ -57,7 +64,7 @@ private:
 #endif
 
     // Message Ports
-    CMessagePort<NTypes::RadioBroadcastData>& loraBroadcastMessagePort;
+    LoraBroadcastMailbox& loraBroadcastMessagePort;
     CMessagePort<NTypes::RadioBroadcastData>& udpBroadcastMessagePort;
     CMessagePort<NTypes::GnssLoggingData>& gnssDataLogMessagePort;
 
@@ -68,6 +75,11 @@ private:
     CUdpListenerTenant powerModuleListenerTenant{"Power Module Listener Tenant", ipAddrStr, powerModuleTelemetryPort, &loraBroadcastMessagePort};
 
     CUdpAlertTenant alertTenant{"Alert Tenant", ipAddrStr, NNetworkDefs::ALERT_PORT};
+    CMessagePortStatsTenant statsTenant{"Message Port Stats Tenant", ipAddrStr, NNetworkDefs::STATS_PORT};
+    CTenantProfileTenant profileTenant{"Tenant Profile Tenant", ipAddrStr, NNetworkDefs::PROFILE_PORT};
+    // No flight log on this module, so problems only go to the log and the counters
+    CHealthMonitorTenant healthMonitorTenant{"Health Monitor Tenant", nullptr, healthCheckIntervalMs,
+                                             DEVICE_DT_GET_OR_NULL(DT_ALIAS(watchdog0))};
 
 #ifndef CONFIG_ARCH_POSIX
     CLoraTransmitTenant loraTransmitTenant{"LoRa Transmit Tenant", lora, &loraBroadcastMessagePort};
@@ -80,11 +92,13 @@ private:
     CStateMachineUpdater stateMachineUpdater;
 
     // Tasks
-    CTask networkingTask{"Networking Task", 14, 3072, 0};
-    CTask gnssTask{"GNSS Task", 15, 1024, 2000};
+    CStaticTask<3072, 7> networkingTask{"Networking Task", 14, 0};
+    CStaticTask<1024, 1> gnssTask{"GNSS Task", 15, CTask::Period{.us = 2000000}};
 
-    CTask dataLoggingTask{"Data Logging Task", 15, 2048, 0};
-    CTask loraTask{"LoRa Task", 15, 2048, 0};
+    CStaticTask<2048, 1> dataLoggingTask{"Data Logging Task", 15, 0};
+    CStaticTask<2048, 2> loraTask{"LoRa Task", 15, 0};
+    // Alone and above the tasks it watches, so nothing it shares a task with can block it from checking
+    CStaticTask<1024, 1> healthTask{"Health Task", 13, 0};
 
 };
 
@@ -11,7 +11,8 @@
 // F-Core Includes
 #include <f_core/c_project_configuration.h>
 #include <f_core/messaging/c_message_port.h>
-#include <f_core/os/c_task.h>
+#include <f_core/messaging/c_pooled_message_port.h>
+#include <f_core/os/c_static_task.h>
 #include <f_core/radio/c_lora.h>
 
 #include <n_autocoder_network_defs.h>
@@ -47,8 +48,9 @@ private:
     CLora lora;
 
     // Message Ports
-    CMessagePort<NTypes::RadioBroadcastData>& loraBroadcastMessagePort;
-    CMessagePort<NTypes::RadioBroadcastData>& udpBroadcastMessagePort;
+    // Both listeners hold a buffer while waiting on their sockets and the transmit tenant holds one while sending
+    static constexpr std::size_t loraBroadcastQueueLength = 10;
+    CPooledMessagePort<NTypes::RadioBroadcastData, loraBroadcastQueueLength + 3> loraBroadcastMessagePort;
 
     // Tenants
     CLoraTransmitTenant loraTransmitTenant{"LoRa Transmit Tenant", lora, &loraBroadcastMessagePort};
@@ -58,8 +60,8 @@ private:
     CLoraReceiveTenant loraReceiveTenant{"LoRa Receive Tenant", loraTransmitTenant, ipAddrStr, NNetworkDefs::RADIO_BASE_PORT};
 
     // Tasks
-    CTask networkingTask{"UDP Listener Task", 15, 1024, 0};
-    CTask loraTask{"LoRa Rx Task", 15, 2048, 0};
+    CStaticTask<1024, 2> networkingTask{"UDP Listener Task", 15, 0};
+    CStaticTask<2048, 2> loraTask{"LoRa Rx Task", 15, 0};
 };
 
 #endif //C_RECEIVER_MODULE_H
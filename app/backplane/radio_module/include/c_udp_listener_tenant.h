@@ -4,6 +4,7 @@
 #include "n_radio_module_types.h"
 
 #include <f_core/messaging/c_message_port.h>
+#include <f_core/messaging/c_pooled_message_port.h>
 #include <f_core/os/c_tenant.h>
 
 #include <f_core/net/network/c_ipv4.h>
@@ -15,19 +16,38 @@ public:
         : CTenant(name), ip(CIPv4{ipStr}), udp(CUdpSocket{ip, listenPort, listenPort}),
           loraTransmitPort(*loraTransmitPort), listenPort(listenPort) {}
 
+    /**
+     * Constructor for receiving packets straight into pooled buffers, which are then queued without a copy
+     */
+    explicit CUdpListenerTenant(const char* name, const char *ipStr, const uint16_t listenPort, CPooledMessagePortBase<NTypes::RadioBroadcastData>* loraTransmitPool)
+        : CTenant(name), ip(CIPv4{ipStr}), udp(CUdpSocket{ip, listenPort, listenPort}),
+          loraTransmitPort(*loraTransmitPool), loraTransmitPool(loraTransmitPool), listenPort(listenPort) {}
+
     ~CUdpListenerTenant() override = default;
 
     void Startup() override;
 
     void PostStartup() override;
 
+    void AddWaitSources(CWaitSet& waitSet) override;
+
     void Run() override;
 
+    /**
+     * Get the number of packets dropped because every pooled buffer was in use
+     * @return Packets dropped since construction
+     */
+    uint32_t GetDroppedPackets() const { return droppedPackets; }
+
 private:
     CIPv4 ip;
     CUdpSocket udp;
     CMessagePort<NTypes::RadioBroadcastData>& loraTransmitPort;
+    CPooledMessagePortBase<NTypes::RadioBroadcastData>* loraTransmitPool = nullptr;
     const uint16_t listenPort;
+    uint32_t droppedPackets = 0;
+
+    void runPooled();
 };
 
 
@@ -8,20 +8,7 @@
 LOG_MODULE_REGISTER(CLoraTransmitTenant);
 
 void CLoraTransmitTenant::Startup() {
-#ifndef RADIO_MODULE_RECEIVER
-    bool success = portDataMap.Insert(NNetworkDefs::POWER_MODULE_INA_DATA_PORT, {.port = 0, .size = 0});
-    success &= portDataMap.Insert(NNetworkDefs::RADIO_MODULE_GNSS_DATA_PORT, {.port = 0, .size = 0});
-    success &= portDataMap.Insert(NNetworkDefs::SENSOR_MODULE_TELEMETRY_PORT, {.port = 0, .size = 0});
-
-    success &= padDataRequestedMap.Insert(NNetworkDefs::POWER_MODULE_INA_DATA_PORT, false);
-    success &= padDataRequestedMap.Insert(NNetworkDefs::RADIO_MODULE_GNSS_DATA_PORT, false);
-    success &= padDataRequestedMap.Insert(NNetworkDefs::SENSOR_MODULE_TELEMETRY_PORT, false);
-
-    if (!success) {
-        LOG_ERR("Failed to insert all ports into hashmap");
-        k_oops();
-    }
-#endif
+    // Nothing to do here
 }
 
 void CLoraTransmitTenant::PostStartup() {
@@ -39,19 +26,20 @@ void CLoraTransmitTenant::Run() {
 }
 
 void CLoraTransmitTenant::PadRun() {
-    NTypes::RadioBroadcastData rxData{};
-    readTransmitQueue(rxData);
-    portDataMap.Set(rxData.port, rxData);
+    if (latestPortData == nullptr) {
+        return;
+    }
+
+    // Waiting for new data paces the loop like the other states do. Requests get the latest data regardless
+    NTypes::RadioBroadcastData data{};
+    readTransmitQueue(data);
 
-    for (const auto &[port, requested] : padDataRequestedMap) {
+    for (auto &&[port, requested] : padDataRequestedMap) {
         if (requested) {
-            NTypes::RadioBroadcastData data = portDataMap.Get(port).value_or(NTypes::RadioBroadcastData{.port = 0, .size = 0});
-            if (port == 0) {
-                continue;
+            if (latestPortData->Read(port, data)) {
+                transmit(data);
             }
-
-            transmit(data);
-            padDataRequestedMap[port] = false;
+            requested = false;
         }
     }
 }
@@ -66,15 +54,26 @@ void CLoraTransmitTenant::FlightRun() {
 
 
 void CLoraTransmitTenant::LandedRun() {
-    NTypes::RadioBroadcastData data{};
+    if (latestPortData == nullptr) {
+        return;
+    }
 
-    if (readTransmitQueue(data) && data.port == NNetworkDefs::RADIO_MODULE_GNSS_DATA_PORT) {
+    NTypes::RadioBroadcastData data{};
+    if (latestPortData->Receive(NNetworkDefs::RADIO_MODULE_GNSS_DATA_PORT, data, K_MSEC(10)) == 0) {
         transmit(data);
     }
 }
 
 
 void CLoraTransmitTenant::GroundRun() {
+    if (loraTransmitPool != nullptr) {
+        CPooledMessage<NTypes::RadioBroadcastData> data;
+        if (loraTransmitPool->Receive(data, K_MSEC(10)) == 0) {
+            transmit(*data);
+        }
+        return;
+    }
+
     NTypes::RadioBroadcastData data{};
     if (readTransmitQueue(data)) {
         transmit(data);
@@ -102,7 +101,6 @@ void CLoraTransmitTenant::transmit(const NTypes::RadioBroadcastData& data) const
     lora.TransmitSynchronous(txData.data(), data.size + 2);
 }
 
-// TODO: Maybe make a thread safe HashMap that directly writes instead of all this overhead
 bool CLoraTransmitTenant::readTransmitQueue(NTypes::RadioBroadcastData& data) const {
     if (int ret = loraTransmitPort.Receive(data, K_MSEC(10)); ret < 0) {
         LOG_WRN_ONCE("Failed to receive from message port (%d)", ret);
@@ -4,22 +4,23 @@
 
 // F-Core Tenant
 #include <f_core/os/n_rtos.h>
+#include <f_core/messaging/c_instrumented_message_port.h>
 #include <f_core/messaging/c_msgq_message_port.h>
 #include <zephyr/drivers/gnss.h>
 
-K_MSGQ_DEFINE(loraBroadcastQueue, sizeof(NTypes::RadioBroadcastData), 10, 4);
 K_MSGQ_DEFINE(udpBroadcastQueue, sizeof(NTypes::RadioBroadcastData), 10, 4);
 K_MSGQ_DEFINE(gnssDataLogQueue, sizeof(NTypes::GnssLoggingData), 10, 4);
-static auto loraBroadcastMsgQueue = CMsgqMessagePort<NTypes::RadioBroadcastData>(loraBroadcastQueue);
+static LoraBroadcastMailbox loraBroadcastMailbox{loraBroadcastPorts};
 static auto udpBroadcastMsgQueue = CMsgqMessagePort<NTypes::RadioBroadcastData>(udpBroadcastQueue);
 static auto gnssLogMsgQueue = CMsgqMessagePort<NTypes::GnssLoggingData>(gnssDataLogQueue);
+static CInstrumentedMessagePort<NTypes::GnssLoggingData, 10> gnssLogPort{"gnss_log", gnssLogMsgQueue};
 
 CRadioModule::CRadioModule() : CProjectConfiguration(),
 #ifndef CONFIG_ARCH_POSIX
                                lora(*DEVICE_DT_GET(DT_ALIAS(lora))),
 #endif
-                               loraBroadcastMessagePort(loraBroadcastMsgQueue),
-                               udpBroadcastMessagePort(udpBroadcastMsgQueue), gnssDataLogMessagePort(gnssLogMsgQueue) {}
+                               loraBroadcastMessagePort(loraBroadcastMailbox),
+                               udpBroadcastMessagePort(udpBroadcastMsgQueue), gnssDataLogMessagePort(gnssLogPort) {}
 
 void CRadioModule::AddTenantsToTasks() {
     // Networking
@@ -27,6 +28,8 @@ void CRadioModule::AddTenantsToTasks() {
     networkingTask.AddTenant(powerModuleListenerTenant);
     networkingTask.AddTenant(tftpServerTenant);
     networkingTask.AddTenant(alertTenant);
+    networkingTask.AddTenant(statsTenant);
+    networkingTask.AddTenant(profileTenant);
 
 #ifndef CONFIG_ARCH_POSIX
     // LoRa
@@ -38,9 +41,17 @@ void CRadioModule::AddTenantsToTasks() {
 
     // GNSS
     gnssTask.AddTenant(gnssTenant);
+
+    // Health
+    healthTask.AddTenant(healthMonitorTenant);
 }
 
 void CRadioModule::AddTasksToRtos() {
+    // Health
+    healthMonitorTenant.Watch(loraTask, loraDeadlineMs);
+    healthMonitorTenant.Watch(gnssTask);
+    NRtos::AddTask(healthTask);
+
     // Networking
     NRtos::AddTask(networkingTask);
     NRtos::AddTask(loraTask);
@@ -4,14 +4,8 @@
 
 // F-Core Tenant
 #include <f_core/os/n_rtos.h>
-#include <f_core/messaging/c_msgq_message_port.h>
 
-K_MSGQ_DEFINE(broadcastQueue, 256, 10, 4);
-static auto loraBroadcastMsgQueue = CMsgqMessagePort<NTypes::RadioBroadcastData>(broadcastQueue);
-static auto udpBroadcastMsgQueue = CMsgqMessagePort<NTypes::RadioBroadcastData>(broadcastQueue);
-
-CReceiverModule::CReceiverModule() : CProjectConfiguration(), lora(*DEVICE_DT_GET(DT_ALIAS(lora))),
-                               loraBroadcastMessagePort(loraBroadcastMsgQueue), udpBroadcastMessagePort(udpBroadcastMsgQueue) {
+CReceiverModule::CReceiverModule() : CProjectConfiguration(), lora(*DEVICE_DT_GET(DT_ALIAS(lora))) {
 }
 
 void CReceiverModule::AddTenantsToTasks() {
@@ -1,6 +1,7 @@
 #include "c_udp_listener_tenant.h"
 #include "c_radio_module.h"
 
+#include <f_core/os/c_wait_set.h>
 #include <zephyr/logging/log.h>
 
 LOG_MODULE_REGISTER(CUdpListenerTenant);
@@ -13,7 +14,16 @@ void CUdpListenerTenant::PostStartup() {
     udp.SetRxTimeout(10);
 }
 
+void CUdpListenerTenant::AddWaitSources(CWaitSet& waitSet) {
+    waitSet.AddSocket(udp.GetSocket());
+}
+
 void CUdpListenerTenant::Run() {
+    if (loraTransmitPool != nullptr) {
+        runPooled();
+        return;
+    }
+
     NTypes::RadioBroadcastData radioBroadcastData{0};
     // Note len argument is the size of the data buffer, not how much data to receive! rcvResult will contain the actual amount of data received or -1 on error
     const int rcvResult = udp.ReceiveAsynchronous(&radioBroadcastData.data, sizeof(radioBroadcastData.data));
@@ -24,8 +34,35 @@ void CUdpListenerTenant::Run() {
     radioBroadcastData.port = listenPort;
     radioBroadcastData.size = static_cast<uint8_t>(rcvResult);
 
-    if (loraTransmitPort.Send(radioBroadcastData) == -ENOMSG) {
-        LOG_WRN_ONCE("Failed to send to broadcast queue");
-        loraTransmitPort.Clear();
+    if (int ret = loraTransmitPort.Send(radioBroadcastData); ret < 0) {
+        // Drop this packet rather than everything already waiting to go out
+        LOG_WRN_ONCE("Failed to send to broadcast port (%d)", ret);
+    }
+}
+
+void CUdpListenerTenant::runPooled() {
+    CPooledMessage<NTypes::RadioBroadcastData> radioBroadcastData = loraTransmitPool->Allocate();
+    if (!radioBroadcastData) {
+        // Still read the datagram, or the socket stays readable and this task spins instead of letting the LoRa task
+        // send and free buffers
+        NTypes::RadioBroadcastData discarded{0};
+        if (udp.ReceiveAsynchronous(&discarded.data, sizeof(discarded.data)) > 0) {
+            droppedPackets++;
+            LOG_WRN_ONCE("No free broadcast buffers. Dropping packets");
+        }
+        return;
+    }
+
+    // The buffer goes back to the pool on any early return
+    const int rcvResult = udp.ReceiveAsynchronous(&radioBroadcastData->data, sizeof(radioBroadcastData->data));
+    if (rcvResult <= 0) {
+        return;
+    }
+
+    radioBroadcastData->port = listenPort;
+    radioBroadcastData->size = static_cast<uint8_t>(rcvResult);
+
+    if (int ret = loraTransmitPool->Send(std::move(radioBroadcastData)); ret < 0) {
+        LOG_WRN_ONCE("Failed to send to broadcast port (%d)", ret);
     }
 }
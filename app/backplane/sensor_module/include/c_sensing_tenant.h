@@ -11,6 +11,7 @@
 #include <f_core/device/sensor/c_temperature_sensor.h>
 #include <f_core/messaging/c_message_port.h>
 #include <f_core/os/c_tenant.h>
+#include <f_core/os/flight_log.hpp>
 #include <n_autocoder_types.h>
 #include <zephyr/device.h>
 
@@ -18,8 +19,15 @@ class CSensorDevice;
 
 class CSensingTenant : public CTenant {
   public:
-    explicit CSensingTenant(const char *name, CMessagePort<NTypes::SensorData> &dataToBroadcast,
-                            CMessagePort<NTypes::SensorData> &dataToLog, CDetectionHandler &handler);
+    /**
+     * Constructor
+     * @param name Name of the tenant
+     * @param sensorData Port each sample is published to (the sensor data topic)
+     * @param handler Detection handler each sample is checked against
+     * @param flightLog Flight log the message port stats, task timings and tenant profiles are written to at landing
+     */
+    explicit CSensingTenant(const char *name, CMessagePort<NTypes::SensorData> &sensorData,
+                            CDetectionHandler &handler, CFlightLog &flightLog);
     ~CSensingTenant() override = default;
 
     void Startup() override;
@@ -27,8 +35,16 @@ class CSensingTenant : public CTenant {
     void Run() override;
 
   private:
-    CMessagePort<NTypes::SensorData> &dataToBroadcast;
-    CMessagePort<NTypes::SensorData> &dataToLog;
+    CMessagePort<NTypes::SensorData> &sensorData;
+
+    // Written from the system work queue, like the phase controller's entries, so the two never write the log at once
+    struct StatsWork {
+        k_work work;
+        CFlightLog *flightLog;
+    } statsWork;
+    bool statsLogged = false;
+
+    static void logStats(k_work *work);
 
     CDetectionHandler &detection_handler;
     // Sensor instances
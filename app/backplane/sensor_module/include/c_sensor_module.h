@@ -7,11 +7,17 @@
 // F-Core Includes
 #include <f_core/c_project_configuration.h>
 #include <f_core/messaging/c_message_port.h>
+#include <f_core/messaging/c_pre_trigger_message_port.h>
+#include <f_core/messaging/c_topic.h>
+#include <f_core/net/application/c_message_port_stats_tenant.h>
+#include <f_core/net/application/c_tenant_profile_tenant.h>
 #include <f_core/net/application/c_udp_broadcast_tenant.h>
 #include <f_core/net/application/c_tftp_server_tenant.h>
-#include <f_core/os/c_task.h>
+#include <f_core/os/c_compressed_datalogger.h>
+#include <f_core/os/c_static_task.h>
 #include <f_core/os/flight_log.hpp>
-#include <f_core/os/tenants/c_datalogger_tenant.h>
+#include <f_core/os/tenants/c_async_datalogger_tenant.h>
+#include <f_core/os/tenants/c_health_monitor_tenant.h>
 #include <n_autocoder_network_defs.h>
 #include <n_autocoder_types.h>
 
@@ -48,26 +54,59 @@ class CSensorModule : public CProjectConfiguration {
     std::string ipAddrStr = CREATE_IP_ADDR(NNetworkDefs::SENSOR_MODULE_IP_ADDR_BASE, 1, CONFIG_MODULE_ID);
     static constexpr int telemetryBroadcastPort = NNetworkDefs::SENSOR_MODULE_TELEMETRY_PORT;
 
+    // Producers fill one erase block (4 KiB on the W25Q) of RAM while the other is written out
+    static constexpr std::size_t dataLogBlockSize = 4096;
+    static constexpr std::size_t dataLogNumBlocks = 2;
+    static constexpr uint32_t dataLogFlushIntervalMs = 1000;
+    // Compressed in small chunks on its way out, so LittleFS still sees program-sized writes
+    static constexpr std::size_t dataLogCompressedBlockSize = 512;
+    // Samples kept in RAM on the pad and written out at boost (~2 s at the sensing rate)
+    static constexpr std::size_t preBoostSamples = 200;
+    static constexpr uint32_t sensingPeriodUs = 10000; // 100 Hz
+    static constexpr std::size_t broadcastQueueLength = 10;
+    static constexpr uint32_t healthCheckIntervalMs = 100;
+    // The logger waits up to a flush interval for a full block, and the block write can then wait on a flash erase.
+    // Both count against the deadline
+    static constexpr uint32_t dataLogDeadlineMs = dataLogFlushIntervalMs + 1000;
+    // The logger path forwards each sample straight on, so only the broadcast queue holds slots
+    static constexpr std::size_t sensorDataPoolSize = broadcastQueueLength + 1;
+
     // Message Ports
-    CMessagePort<NTypes::SensorData>& sensorDataBroadcastMessagePort;
-    CMessagePort<NTypes::SensorData>& sensorDataLogMessagePort;
+    // Each sample is published once. The broadcast tenant and the logger read the same copy
+    CTopic<NTypes::SensorData, sensorDataPoolSize> sensorDataTopic;
+    // Telemetry should be as fresh as possible, so a slow network drops old samples
+    CTopicSubscriber<NTypes::SensorData, broadcastQueueLength> sensorDataBroadcastSubscriber{sensorDataTopic,
+                                                                                           TopicOverflow::DropOldest,
+                                                                                           "sensor_bcast"};
 
     CFlightLog flight_log;
     SensorModulePhaseController controller{sourceNames, eventNames, timer_events, deciders, &flight_log};
     CDetectionHandler detectionHandler{controller};
 
     // Tenants
-    CSensingTenant sensingTenant{"Sensing Tenant", sensorDataBroadcastMessagePort, sensorDataLogMessagePort,
-                             detectionHandler};
-    CUdpBroadcastTenant<NTypes::SensorData> broadcastTenant{"Broadcast Tenant", ipAddrStr.c_str(), telemetryBroadcastPort, telemetryBroadcastPort, sensorDataBroadcastMessagePort};
-    CDataLoggerTenant<NTypes::SensorData> dataLoggerTenant{"Data Logger Tenant", "/lfs/sensor_module_data.bin", LogMode::Growing, 0, sensorDataLogMessagePort};
+    // The sensing tenant logs through these, so they have to be constructed first
+    CAsyncDataLoggerTenant<NTypes::SensorData, dataLogBlockSize, dataLogNumBlocks,
+                           CCompressedDataLogger<NTypes::SensorData, dataLogCompressedBlockSize>>
+        dataLoggerTenant{"Data Logger Tenant", "/lfs/sensor_module_data.clog", dataLogFlushIntervalMs, true};
+    CPreTriggerMessagePort<NTypes::SensorData, preBoostSamples, SensorModulePhaseController> preBoostLogPort{
+        dataLoggerTenant, controller, Events::Boost};
+    CTopicForwarder<NTypes::SensorData> sensorDataLogForwarder{sensorDataTopic, preBoostLogPort};
+    CSensingTenant sensingTenant{"Sensing Tenant", sensorDataTopic, detectionHandler, flight_log};
+    CUdpBroadcastTenant<NTypes::SensorData> broadcastTenant{"Broadcast Tenant", ipAddrStr.c_str(), telemetryBroadcastPort, telemetryBroadcastPort, sensorDataBroadcastSubscriber};
     CTftpServerTenant tftpServerTenant = *CTftpServerTenant::getInstance(CIPv4(ipAddrStr.c_str()));
+    CMessagePortStatsTenant statsTenant{"Message Port Stats Tenant", ipAddrStr.c_str(), NNetworkDefs::STATS_PORT};
+    CTenantProfileTenant profileTenant{"Tenant Profile Tenant", ipAddrStr.c_str(), NNetworkDefs::PROFILE_PORT};
+    CHealthMonitorTenant healthMonitorTenant{"Health Monitor Tenant", &flight_log, healthCheckIntervalMs,
+                                             DEVICE_DT_GET_OR_NULL(DT_ALIAS(watchdog0))};
 
 
     // Tasks
-    CTask networkTask{"Networking Task", 15, 3072, 0};
-    CTask sensingTask{"Sensing Task", 15, 1024, 0};
-    CTask dataLogTask{"Data Logging Task", 15, 1300, 0};
+    CStaticTask<3072, 5> networkTask{"Networking Task", 15, 0};
+    // Detection depends on a steady sample rate, so sensing runs at fixed deadlines
+    CStaticTask<1024, 1> sensingTask{"Sensing Task", 15, CTask::Period{.us = sensingPeriodUs}};
+    CStaticTask<1300, 1> dataLogTask{"Data Logging Task", 15, 0};
+    // Alone and above the tasks it watches, so nothing it shares a task with can block it from checking
+    CStaticTask<1024, 1> healthTask{"Health Task", 14, 0};
 };
 
 #endif //C_SENSOR_MODULE_H
@@ -7,13 +7,15 @@
 #include <f_core/device/sensor/c_gyroscope.h>
 #include <f_core/device/sensor/c_magnetometer.h>
 #include <f_core/device/sensor/c_temperature_sensor.h>
+#include <f_core/messaging/c_message_port_stats.h>
+#include <f_core/os/n_rtos.h>
 #include <zephyr/logging/log.h>
 
 LOG_MODULE_REGISTER(CSensingTenant);
 
-CSensingTenant::CSensingTenant(const char* name, CMessagePort<NTypes::SensorData>& dataToBroadcast,
-                               CMessagePort<NTypes::SensorData>& dataToLog, CDetectionHandler& handler)
-    : CTenant(name), dataToBroadcast(dataToBroadcast), dataToLog(dataToLog), detection_handler(handler),
+CSensingTenant::CSensingTenant(const char* name, CMessagePort<NTypes::SensorData>& sensorData,
+                               CDetectionHandler& handler, CFlightLog& flightLog)
+    : CTenant(name), sensorData(sensorData), statsWork{.work = {}, .flightLog = &flightLog}, detection_handler(handler),
       imuAccelerometer(*DEVICE_DT_GET(DT_ALIAS(imu))), imuGyroscope(*DEVICE_DT_GET(DT_ALIAS(imu))),
       primaryBarometer(*DEVICE_DT_GET(DT_ALIAS(primary_barometer))),
       secondaryBarometer(*DEVICE_DT_GET(DT_ALIAS(secondary_barometer))),
@@ -24,6 +26,7 @@ CSensingTenant::CSensingTenant(const char* name, CMessagePort<NTypes::SensorData
               &magnetometer
 #endif
       } {
+    k_work_init(&statsWork.work, logStats);
 }
 
 void CSensingTenant::Startup() {
@@ -45,6 +48,10 @@ void CSensingTenant::PostStartup() {}
 
 void CSensingTenant::Run() {
     if (!detection_handler.ContinueCollecting()) {
+        if (!statsLogged) {
+            statsLogged = true;
+            k_work_submit(&statsWork.work);
+        }
         return;
     }
     NTypes::SensorData data{};
@@ -87,7 +94,14 @@ void CSensingTenant::Run() {
 
     detection_handler.HandleData(uptime, data, sensor_states);
     // If we can't send immediately, drop the packet
-    // we're gonna sleep then give it new data anywas
-    dataToBroadcast.Send(data, K_NO_WAIT);
-    dataToLog.Send(data, K_NO_WAIT);
+    // we're gonna sleep then give it new data anywas. Drops show up in the subscribers' message port stats
+    sensorData.Send(data, K_NO_WAIT);
+}
+
+void CSensingTenant::logStats(k_work* work) {
+    StatsWork* statsWork = CONTAINER_OF(work, StatsWork, work);
+    CMessagePortStats::WriteAll(*statsWork->flightLog);
+    NRtos::WriteTaskTimings(*statsWork->flightLog);
+    NRtos::WriteTenantProfiles(*statsWork->flightLog);
+    NRtos::WriteStackUsage(*statsWork->flightLog);
 }
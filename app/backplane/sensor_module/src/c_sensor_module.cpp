@@ -1,20 +1,11 @@
 #include "c_sensor_module.h"
 
 // F-Core Tenant
-#include <f_core/messaging/c_msgq_message_port.h>
 #include <f_core/os/n_rtos.h>
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(sensor_module);
 
-K_MSGQ_DEFINE(broadcastQueue, sizeof(NTypes::SensorData), 10, 4);
-static auto broadcastMsgQueue = CMsgqMessagePort<NTypes::SensorData>(broadcastQueue);
-
-K_MSGQ_DEFINE(dataLogQueue, sizeof(NTypes::SensorData), 10, 4);
-static auto dataLogMsgQueue = CMsgqMessagePort<NTypes::SensorData>(dataLogQueue);
-
-CSensorModule::CSensorModule()
-    : CProjectConfiguration(), sensorDataBroadcastMessagePort(broadcastMsgQueue),
-      sensorDataLogMessagePort(dataLogMsgQueue), flight_log{generateFlightLogPath()} {}
+CSensorModule::CSensorModule() : CProjectConfiguration(), flight_log{generateFlightLogPath()} {}
 
 std::string CSensorModule::generateFlightLogPath() {
     constexpr size_t MAX_FLIGHT_LOG_PATH_SIZE = 32;
@@ -40,15 +31,25 @@ void CSensorModule::AddTenantsToTasks() {
     // Networking
     networkTask.AddTenant(broadcastTenant);
     networkTask.AddTenant(tftpServerTenant);
+    networkTask.AddTenant(statsTenant);
+    networkTask.AddTenant(profileTenant);
 
     // Sensing
     sensingTask.AddTenant(sensingTenant);
 
     // Data Logging
     dataLogTask.AddTenant(dataLoggerTenant);
+
+    // Health
+    healthTask.AddTenant(healthMonitorTenant);
 }
 
 void CSensorModule::AddTasksToRtos() {
+    // Health
+    healthMonitorTenant.Watch(sensingTask);
+    healthMonitorTenant.Watch(dataLogTask, dataLogDeadlineMs, false);
+    NRtos::AddTask(healthTask);
+
     // Networking
     NRtos::AddTask(networkTask);
 
@@ -0,0 +1,35 @@
+#ifndef BENCHMARK_TIMER_H
+#define BENCHMARK_TIMER_H
+
+#include <zephyr/kernel.h>
+#ifdef CONFIG_BOARD_NATIVE_SIM
+#include <native_rtc.h>
+#endif
+
+/**
+ * Start timing something. On native_sim the cycle counter follows simulated time, which stands still while code runs,
+ * so the host clock is read instead, to the microsecond
+ * @return Opaque start time for nsSince()
+ */
+inline uint64_t timerStart() {
+#ifdef CONFIG_BOARD_NATIVE_SIM
+    return native_rtc_gettime_us(RTC_CLOCK_PSEUDOHOSTREALTIME);
+#else
+    return k_cycle_get_32();
+#endif
+}
+
+/**
+ * Time since a timerStart()
+ * @param start Start time from timerStart()
+ * @return Nanoseconds since start
+ */
+inline uint64_t nsSince(uint64_t start) {
+#ifdef CONFIG_BOARD_NATIVE_SIM
+    return (native_rtc_gettime_us(RTC_CLOCK_PSEUDOHOSTREALTIME) - start) * 1000;
+#else
+    return k_cyc_to_ns_floor64(static_cast<uint32_t>(k_cycle_get_32() - start));
+#endif
+}
+
+#endif // BENCHMARK_TIMER_H
@@ -1,4 +1,5 @@
 #include "f_core/os/c_datalogger.h"
+#include "f_core/os/c_multi_stream_logger.h"
 
 #include <zephyr/kernel.h>
 
@@ -6,20 +7,53 @@ struct Packet {
     uint8_t a;
     uint8_t b;
 };
+struct Event {
+    uint16_t id;
+};
 CDataLogger<Packet> expand_logger{"/lfs/expand.bin"};
 CDataLogger<Packet> fill_logger{"/lfs/fill.bin", LogMode::FixedSize, 10};
 CDataLogger<Packet> wrap_logger{"/lfs/wrap.bin", LogMode::Circular, 10};
+// Stages packets in RAM and writes them out 64 bytes at a time (or at least every 250ms)
+CDataLogger<Packet, 64> buffered_logger{"/lfs/buffered.bin", LogMode::Growing, 0, 250};
+// Two streams sharing one file (and one 64 byte staging buffer)
+CMultiStreamLogger<64> multi_logger{"/lfs/multi.mlog", 250};
+CLogStream<Packet> packet_stream = multi_logger.AddStream<Packet>("packets");
+CLogStream<Event> event_stream = multi_logger.AddStream<Event>("events");
 
 int main() {
     for (uint8_t i = 0; i < 100; i++) {
         expand_logger.write({i, (uint8_t) (100 - i)});
         fill_logger.write({i, (uint8_t) (100 - i)});
         wrap_logger.write({i, (uint8_t) (100 - i)});
+        buffered_logger.write({i, (uint8_t) (100 - i)});
+        packet_stream.write({i, (uint8_t) (100 - i)});
+        if (i % 25 == 0) {
+            event_stream.write({i});
+        }
         k_msleep(10);
     }
     expand_logger.close();
     fill_logger.close();
     wrap_logger.close();
+    buffered_logger.close();
+    multi_logger.close();
+
+    // Circular logs keep their place across reboots. Read back what survived, oldest first
+    CDataLogReader<Packet> wrap_reader{"/lfs/wrap.bin", LogMode::Circular};
+    for (std::size_t i = 0; i < wrap_reader.Count(); i++) {
+        Packet packet{};
+        if (wrap_reader.Read(i, packet) == 0) {
+            printk("wrap[%u] = {%u, %u}\n", i, packet.a, packet.b);
+        }
+    }
+
+    // Pull one stream back out of the shared file
+    CMultiStreamReader<Event> event_reader{"/lfs/multi.mlog", "events"};
+    Event event{};
+    uint32_t uptime = 0;
+    while (event_reader.Next(event, uptime) == 0) {
+        printk("event %u at %u ms\n", event.id, uptime);
+    }
     printk("Finished!\n");
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include "benchmark_timer.h"
+#include "f_core/os/c_datalogger.h"
+#include "f_core/os/c_file.h"
+#include "f_core/os/flight_log.hpp"
+
+#include <algorithm>
+#include <array>
+#include <zephyr/fs/fs.h>
+#include <zephyr/kernel.h>
+
+/**
+ * Sweeps the filesystem loggers over record size, log mode, sync interval and buffering, and prints one CSV row per
+ * combination to stdout. Latencies are of single writes, so they include any block write or sync a write triggered.
+ * Totals also include the final flush and close.
+ *
+ * On native_sim everything is timed with the host clock, so latencies only resolve to the microsecond and the numbers
+ * compare the loggers on the host machine. Run on hardware for the latencies a flight would see.
+ */
+
+template <std::size_t Size>
+struct Record {
+    uint8_t data[Size];
+};
+
+static constexpr std::size_t maxRecords = 2000;
+// Keeps the big records from filling the simulated flash and taking forever
+static constexpr std::size_t maxBytesPerRun = 256 * 1024;
+static constexpr const char *benchmarkFile = "/lfs/benchmark.bin";
+
+static constexpr std::array<LogMode, 3> modes = {LogMode::Growing, LogMode::Circular, LogMode::FixedSize};
+static constexpr std::array<uint32_t, 3> flushIntervalsMs = {0, 100, 1000};
+
+static std::array<uint64_t, maxRecords> latencies; //< ns
+
+static const char *modeName(LogMode mode) {
+    switch (mode) {
+        case LogMode::Growing:
+            return "growing";
+        case LogMode::Circular:
+            return "circular";
+        case LogMode::FixedSize:
+            return "fixed";
+    }
+    return "unknown";
+}
+
+/**
+ * Times count writes of recordSize bytes, then the cleanup after them, and prints the row
+ * @param write called with the index of each record. Returns a negative errno code on error
+ * @param finish called once after the last write (flush, close, ...)
+ */
+template <typename Write, typename Finish>
+static void run(const char *backend, std::size_t recordSize, const char *mode, std::size_t blockSize,
+                uint32_t flushIntervalMs, std::size_t count, Write write, Finish finish) {
+    const uint64_t start = timerStart();
+    for (std::size_t i = 0; i < count; i++) {
+        const uint64_t before = timerStart();
+        int ret = write(i);
+        latencies[i] = nsSince(before);
+        if (ret < 0) {
+            printk("# %s %zu %s: write %zu failed: %d\n", backend, recordSize, mode, i, ret);
+            return;
+        }
+    }
+    finish();
+    const uint64_t totalNs = nsSince(start);
+
+    std::sort(latencies.begin(), latencies.begin() + count);
+    const unsigned long long p50 = latencies[count / 2];
+    const unsigned long long p99 = latencies[count * 99 / 100];
+    const unsigned long long max = latencies[count - 1];
+    const unsigned long long recordsPerSecond = totalNs > 0 ? count * 1000000000ull / totalNs : 0;
+
+    printk("%s,%zu,%s,%zu,%u,%zu,%llu,%llu,%llu,%llu,%llu,%llu\n", backend, recordSize, mode, blockSize,
+           flushIntervalMs, count, static_cast<unsigned long long>(totalNs / 1000), recordsPerSecond,
+           recordsPerSecond * recordSize, p50, p99, max);
+}
+
+template <std::size_t RecordSize, std::size_t BlockSize>
+static void sweepDataLogger(std::size_t count) {
+    for (LogMode mode : modes) {
+        for (uint32_t flushIntervalMs : flushIntervalsMs) {
+            fs_unlink(benchmarkFile);
+            // Circular logs wrap a few times. FixedSize is sized to fit the run so it never refuses a write
+            const std::size_t numPackets = mode == LogMode::Circular ? count / 4 : count;
+            CDataLogger<Record<RecordSize>, BlockSize> logger{benchmarkFile, mode, numPackets, flushIntervalMs};
+            Record<RecordSize> record{};
+            run(
+                "datalogger", RecordSize, modeName(mode), BlockSize, flushIntervalMs, count,
+                [&](std::size_t i) {
+                    record.data[0] = i;
+                    return logger.write(record);
+                },
+                [&]() { logger.close(); });
+        }
+    }
+}
+
+template <std::size_t RecordSize>
+static void sweepRecordSize() {
+    constexpr std::size_t count = std::min(maxRecords, maxBytesPerRun / RecordSize);
+
+    sweepDataLogger<RecordSize, 0>(count);
+    sweepDataLogger<RecordSize, 512>(count);
+    sweepDataLogger<RecordSize, 4096>(count);
+
+    // Plain file writes, for a baseline
+    fs_unlink(benchmarkFile);
+    {
+        CFile file{benchmarkFile, CFile::WRITE_FLAG | CFile::CREATE_FLAG};
+        Record<RecordSize> record{};
+        run(
+            "file", RecordSize, "growing", 0, 0, count, [&](std::size_t) { return file.Write(&record, RecordSize); },
+            []() {});
+    }
+
+    // Flight log lines of the same length
+    fs_unlink(benchmarkFile);
+    {
+        static std::array<char, RecordSize> line;
+        line.fill('x');
+        CFlightLog flightLog{benchmarkFile};
+        run(
+            "flight_log", RecordSize, "growing", 0, 0, count,
+            [&](std::size_t) { return flightLog.Write(line.data(), line.size()); }, [&]() { flightLog.Sync(); });
+    }
+    fs_unlink(benchmarkFile);
+}
+
+int main() {
+    printk("backend,record_size,mode,block_size,flush_interval_ms,records,total_us,records_per_s,bytes_per_s,p50_ns,"
+           "p99_ns,max_ns\n");
+
+    sweepRecordSize<8>();
+    sweepRecordSize<64>();
+    sweepRecordSize<256>();
+
+    printk("# Finished\n");
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include "benchmark_timer.h"
+#include "f_core/utils/c_flat_map.h"
+#include "f_core/utils/c_hashmap.h"
+
+#include <array>
+#include <zephyr/kernel.h>
+
+/**
+ * Compares CFlatMap against CHashMap, printing one CSV row per run to stdout.
+ *
+ * "get" looks up keys that are in the map and "miss" keys that aren't. "index" goes through operator[], like
+ * CLoraTransmitTenant does when a request comes in. "iterate" walks the whole map once per op, like PadRun() does every
+ * cycle. Keys are spaced like the network ports the radio module uses.
+ *
+ * On native_sim the ops are timed with the host clock, so the numbers only compare the two maps on the host machine.
+ * Run on hardware before drawing conclusions about flight code.
+ */
+
+static constexpr std::size_t numOps = 4096;
+
+static void printRow(const char *map, std::size_t entries, const char *test, uint64_t totalNs) {
+    printk("%s,%zu,%s,%zu,%llu,%llu\n", map, entries, test, numOps, static_cast<unsigned long long>(totalNs / 1000),
+           static_cast<unsigned long long>(totalNs / numOps));
+}
+
+/**
+ * Time numOps calls of op, all at once so timer reads don't dominate the shorter ops
+ * @param op called with the index of the op
+ */
+template <typename Op>
+static void timeOps(const char *map, std::size_t entries, const char *test, Op op) {
+    const uint64_t start = timerStart();
+    for (std::size_t i = 0; i < numOps; i++) {
+        op(i);
+    }
+    printRow(map, entries, test, nsSince(start));
+}
+
+template <std::size_t Entries>
+static void benchmark() {
+    static constexpr std::array<uint16_t, Entries> keys = [] {
+        std::array<uint16_t, Entries> ports{};
+        for (std::size_t i = 0; i < Entries; i++) {
+            ports[i] = 12000 + i * 100;
+        }
+        return ports;
+    }();
+
+    static CFlatMap<uint16_t, uint32_t, Entries> flatMap{keys, 0};
+    static CHashMap<uint16_t, uint32_t> hashMap;
+    for (const uint16_t key : keys) {
+        hashMap.Insert(key, 0);
+    }
+
+    // Read through a volatile so lookups aren't optimized away
+    volatile uint32_t sink = 0;
+
+    timeOps("flat", Entries, "get", [&](std::size_t i) { sink = *flatMap.Get(keys[i % Entries]); });
+    timeOps("hash", Entries, "get", [&](std::size_t i) { sink = *hashMap.Get(keys[i % Entries]); });
+
+    timeOps("flat", Entries, "miss", [&](std::size_t i) { sink = flatMap.Contains(keys[i % Entries] + 1); });
+    timeOps("hash", Entries, "miss", [&](std::size_t i) { sink = hashMap.Contains(keys[i % Entries] + 1); });
+
+    timeOps("flat", Entries, "index", [&](std::size_t i) { flatMap[keys[i % Entries]] = i; });
+    timeOps("hash", Entries, "index", [&](std::size_t i) { hashMap[keys[i % Entries]] = i; });
+
+    timeOps("flat", Entries, "iterate", [&](std::size_t) {
+        for (const auto &[key, value] : flatMap) {
+            sink = value;
+        }
+    });
+    timeOps("hash", Entries, "iterate", [&](std::size_t) {
+        for (const auto &[key, value] : hashMap) {
+            sink = value;
+        }
+    });
+}
+
+int main() {
+    printk("map,entries,test,ops,total_us,ns_per_op\n");
+
+    benchmark<3>();
+    benchmark<16>();
+    benchmark<64>();
+
+    printk("# Finished\n");
+    return 0;
+}
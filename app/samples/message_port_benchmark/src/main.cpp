@@ -0,0 +1,154 @@
+#include "benchmark_timer.h"
+#include "f_core/messaging/c_msgq_message_port.h"
+#include "f_core/messaging/c_spsc_message_port.h"
+
+#include <algorithm>
+#include <array>
+#include <zephyr/kernel.h>
+
+/**
+ * Compares CSpscMessagePort against CMsgqMessagePort, printing one CSV row per run to stdout.
+ *
+ * "send" and "receive" time single calls from one thread with the queue never full or empty, so they are the cost of
+ * the port itself. "in_place" does the same through TryReserve()/Commit() and TryPeek()/Release(). "threads" has a
+ * producer and a consumer thread blocking on each other through a small queue, and only reports the total.
+ *
+ * On native_sim everything is timed with the host clock to the microsecond, which is longer than most single calls
+ * take, so only the totals mean much there. Run on hardware for per-call latencies.
+ */
+
+template <std::size_t Size>
+struct Message {
+    uint8_t data[Size];
+};
+
+static constexpr std::size_t numMessages = 4096;
+static constexpr std::size_t queueLength = 64;
+static constexpr std::size_t threadStackSize = 1024;
+
+static std::array<uint64_t, numMessages> latencies; //< ns
+
+K_THREAD_STACK_DEFINE(producerStack, threadStackSize);
+static k_thread producerThread;
+
+static void printRow(const char *port, std::size_t messageSize, const char *test, uint64_t totalNs,
+                     bool withLatencies) {
+    const unsigned long long messagesPerSecond = totalNs > 0 ? numMessages * 1000000000ull / totalNs : 0;
+
+    unsigned long long p50 = 0;
+    unsigned long long p99 = 0;
+    unsigned long long max = 0;
+    if (withLatencies) {
+        std::sort(latencies.begin(), latencies.end());
+        p50 = latencies[numMessages / 2];
+        p99 = latencies[numMessages * 99 / 100];
+        max = latencies[numMessages - 1];
+    }
+
+    printk("%s,%zu,%s,%zu,%llu,%llu,%llu,%llu,%llu\n", port, messageSize, test, numMessages,
+           static_cast<unsigned long long>(totalNs / 1000), messagesPerSecond, p50, p99, max);
+}
+
+/**
+ * Time each call of op for numMessages calls, in batches of queueLength so the queue never fills or empties
+ * @param op called with the index of the message. One call is one send or one receive
+ * @param other the opposite op, run untimed before each batch to empty or fill the queue for it
+ */
+template <typename Op, typename Other>
+static void timeSingleThread(const char *port, std::size_t messageSize, const char *test, Op op, Other other) {
+    uint64_t totalNs = 0;
+    for (std::size_t batch = 0; batch < numMessages; batch += queueLength) {
+        for (std::size_t i = batch; i < batch + queueLength; i++) {
+            other(i);
+        }
+        for (std::size_t i = batch; i < batch + queueLength; i++) {
+            const uint64_t before = timerStart();
+            op(i);
+            latencies[i] = nsSince(before);
+            totalNs += latencies[i];
+        }
+    }
+    printRow(port, messageSize, test, totalNs, true);
+}
+
+template <std::size_t Size>
+static void timeThreads(const char *port, CMessagePort<Message<Size>> &messagePort) {
+    const uint64_t start = timerStart();
+    k_thread_create(
+        &producerThread, producerStack, K_THREAD_STACK_SIZEOF(producerStack),
+        [](void *p1, void *, void *) {
+            auto &producerPort = *static_cast<CMessagePort<Message<Size>> *>(p1);
+            Message<Size> message{};
+            for (std::size_t i = 0; i < numMessages; i++) {
+                message.data[0] = i;
+                producerPort.Send(message, K_FOREVER);
+            }
+        },
+        &messagePort, nullptr, nullptr, K_PRIO_PREEMPT(1), 0, K_NO_WAIT);
+
+    Message<Size> message{};
+    for (std::size_t i = 0; i < numMessages; i++) {
+        messagePort.Receive(message, K_FOREVER);
+    }
+    const uint64_t totalNs = nsSince(start);
+    k_thread_join(&producerThread, K_FOREVER);
+    printRow(port, Size, "threads", totalNs, false);
+}
+
+template <std::size_t Size>
+static void benchmark() {
+    using MessageType = Message<Size>;
+    static char __aligned(4) msgqBuffer[queueLength * sizeof(MessageType)];
+    static k_msgq msgq;
+    k_msgq_init(&msgq, msgqBuffer, sizeof(MessageType), queueLength);
+
+    static CMsgqMessagePort<MessageType> msgqPort{msgq};
+    static CSpscMessagePort<MessageType, queueLength> spscPort;
+    MessageType message{};
+
+    timeSingleThread(
+        "msgq", Size, "send", [&](std::size_t) { msgqPort.Send(message, K_NO_WAIT); },
+        [&](std::size_t) { msgqPort.Receive(message, K_NO_WAIT); });
+    timeSingleThread(
+        "spsc", Size, "send", [&](std::size_t) { spscPort.Send(message, K_NO_WAIT); },
+        [&](std::size_t) { spscPort.Receive(message, K_NO_WAIT); });
+    msgqPort.Clear();
+    spscPort.Clear();
+
+    timeSingleThread(
+        "msgq", Size, "receive", [&](std::size_t) { msgqPort.Receive(message, K_NO_WAIT); },
+        [&](std::size_t) { msgqPort.Send(message, K_NO_WAIT); });
+    timeSingleThread(
+        "spsc", Size, "receive", [&](std::size_t) { spscPort.Receive(message, K_NO_WAIT); },
+        [&](std::size_t) { spscPort.Send(message, K_NO_WAIT); });
+    msgqPort.Clear();
+    spscPort.Clear();
+
+    timeSingleThread(
+        "spsc", Size, "in_place",
+        [&](std::size_t i) {
+            MessageType *slot = spscPort.TryReserve();
+            slot->data[0] = i;
+            spscPort.Commit();
+        },
+        [&](std::size_t) {
+            if (spscPort.TryPeek() != nullptr) {
+                spscPort.Release();
+            }
+        });
+    spscPort.Clear();
+
+    timeThreads<Size>("msgq", msgqPort);
+    timeThreads<Size>("spsc", spscPort);
+}
+
+int main() {
+    printk("port,message_size,test,messages,total_us,messages_per_s,p50_ns,p99_ns,max_ns\n");
+
+    benchmark<4>();
+    benchmark<64>();
+    benchmark<256>();
+
+    printk("# Finished\n");
+    return 0;
+}
@@ -280,6 +280,8 @@ int main() {
     controller.WaitUntilEvent(Events::CamerasOff);
     LOG_DBG("Flight over:\tTurn off cameras");
 
+    controller.FlushLog();
+    LOG_INF("Worst event dispatch latency: %llu ns", controller.GetMaxDispatchLatencyNs());
     fl.Sync();
     LOG_INF("Closed flight log");
     return 0;
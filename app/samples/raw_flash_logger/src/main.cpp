@@ -0,0 +1,62 @@
+#include "benchmark_timer.h"
+#include "f_core/os/c_datalogger.h"
+#include "f_core/os/c_raw_flash_logger.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/storage/flash_map.h>
+
+// About the size of a sensor module sample
+struct Packet {
+    uint32_t index;
+    float values[15];
+};
+
+static constexpr uint32_t numPackets = 5000;
+
+/**
+ * Write numPackets through a logger, timing every write. On native_sim the flash is simulated in RAM and timed with the
+ * host clock, so the numbers only compare the two loggers. Run on hardware for real erase and program times
+ * @return 0 on success, negative errno code from the first failed write
+ */
+template <typename Logger>
+int benchmark(const char *name, Logger &logger) {
+    uint64_t maxNs = 0;
+    const uint64_t start = timerStart();
+
+    for (uint32_t i = 0; i < numPackets; i++) {
+        Packet packet{.index = i, .values = {0}};
+        const uint64_t before = timerStart();
+        int ret = logger.write(packet);
+        const uint64_t ns = nsSince(before);
+        if (ret < 0) {
+            printk("%s: write %u failed: %d\n", name, i, ret);
+            return ret;
+        }
+        maxNs = MAX(maxNs, ns);
+    }
+    logger.Flush();
+
+    const unsigned long long totalUs = nsSince(start) / 1000;
+    const unsigned long long bytesPerSecond = totalUs > 0 ? numPackets * sizeof(Packet) * 1000000ull / totalUs : 0;
+    printk("%s: %u packets in %llu us (%llu B/s), slowest write %llu us\n", name, numPackets, totalUs, bytesPerSecond,
+           static_cast<unsigned long long>(maxNs / 1000));
+    return 0;
+}
+
+int main() {
+    CDataLogger<Packet, 4096> littlefsLogger{"/lfs/benchmark.bin"};
+    benchmark("LittleFS", littlefsLogger);
+    littlefsLogger.close();
+
+    CRawFlashLogger<Packet, FIXED_PARTITION_ID(flight_data_partition)> rawLogger{"/lfs/flight_data.bin"};
+    benchmark("Raw flash", rawLogger);
+    printk("Raw flash: %u erase stalls\n", rawLogger.GetEraseStalls());
+    rawLogger.close();
+
+    // What a module does once landed, so the data can be pulled over TFTP
+    int exported = rawLogger.Export();
+    printk("Exported %d packets to /lfs/flight_data.bin\n", exported);
+
+    printk("Finished!\n");
+    return 0;
+}
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2025 RIT Launch Initiative
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "f_core/os/c_datalogger.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include <zephyr/ztest.h>
+
+/*
+ * Just enough of a filesystem for CDataLogger, kept in RAM, that runs out of space like a real one: the write that
+ * reaches the end of the free space is cut short, and writes after it fail with -ENOSPC
+ */
+namespace {
+struct FakeFile {
+    std::vector<uint8_t> *data;
+    std::size_t position;
+};
+
+std::map<std::string, std::vector<uint8_t>> files;
+std::size_t spaceLeft = SIZE_MAX;
+} // namespace
+
+extern "C" {
+int fs_open(fs_file_t *zfp, const char *fileName, fs_mode_t flags) {
+    auto file = files.find(fileName);
+    if (file == files.end()) {
+        if ((flags & FS_O_CREATE) == 0) {
+            return -ENOENT;
+        }
+        file = files.emplace(fileName, std::vector<uint8_t>{}).first;
+    }
+    zfp->filep = new FakeFile{&file->second, 0};
+    return 0;
+}
+
+int fs_close(fs_file_t *zfp) {
+    delete static_cast<FakeFile *>(zfp->filep);
+    zfp->filep = nullptr;
+    return 0;
+}
+
+ssize_t fs_write(fs_file_t *zfp, const void *ptr, size_t size) {
+    auto *file = static_cast<FakeFile *>(zfp->filep);
+    if (size > 0 && spaceLeft == 0) {
+        return -ENOSPC;
+    }
+
+    size = MIN(size, spaceLeft);
+    if (spaceLeft != SIZE_MAX) {
+        spaceLeft -= size;
+    }
+    if (file->data->size() < file->position + size) {
+        file->data->resize(file->position + size);
+    }
+    memcpy(file->data->data() + file->position, ptr, size);
+    file->position += size;
+    return size;
+}
+
+ssize_t fs_read(fs_file_t *zfp, void *ptr, size_t size) {
+    auto *file = static_cast<FakeFile *>(zfp->filep);
+    size = file->position < file->data->size() ? MIN(size, file->data->size() - file->position) : 0;
+    memcpy(ptr, file->data->data() + file->position, size);
+    file->position += size;
+    return size;
+}
+
+int fs_seek(fs_file_t *zfp, off_t offset, int whence) {
+    auto *file = static_cast<FakeFile *>(zfp->filep);
+    const off_t base = whence == FS_SEEK_SET ? 0 : whence == FS_SEEK_CUR ? file->position : file->data->size();
+    file->position = base + offset;
+    return 0;
+}
+
+off_t fs_tell(fs_file_t *zfp) {
+    return static_cast<FakeFile *>(zfp->filep)->position;
+}
+
+int fs_truncate(fs_file_t *zfp, off_t length) {
+    static_cast<FakeFile *>(zfp->filep)->data->resize(length);
+    return 0;
+}
+
+int fs_sync(fs_file_t *) {
+    return 0;
+}
+
+int64_t z_impl_k_uptime_ticks(void) {
+    return 0;
+}
+}
+
+namespace {
+struct Record {
+    uint32_t index;
+    uint8_t fill[20]; //< every byte is the low byte of index, so a record shifted by any amount stands out
+};
+
+constexpr std::size_t blockSize = 64;
+constexpr uint32_t numRecords = 40;
+constexpr const char *logPath = "/lfs/records.bin";
+
+Record makeRecord(uint32_t index) {
+    Record record{.index = index, .fill = {}};
+    memset(record.fill, static_cast<uint8_t>(index), sizeof(record.fill));
+    return record;
+}
+
+/**
+ * Log numRecords records with the filesystem running out of space after freeSpace bytes, free up space partway
+ * through, then check that the file holds whole records, in order, including every record a write reported as logged
+ */
+void checkAlignedAfterFullDisk(std::size_t freeSpace) {
+    files.clear();
+    spaceLeft = freeSpace;
+
+    std::vector<bool> logged(numRecords, false);
+    {
+        CDataLogger<Record, blockSize> logger{logPath};
+        for (uint32_t i = 0; i < numRecords; i++) {
+            if (i == numRecords / 2) {
+                spaceLeft = SIZE_MAX;
+            }
+            logged[i] = logger.write(makeRecord(i)) == sizeof(Record);
+        }
+        logger.close();
+    }
+
+    const std::vector<uint8_t> &data = files[logPath];
+    zassert_equal(data.size() % sizeof(Record), 0, "%zu free: torn record in a %zu byte file", freeSpace,
+                  data.size());
+
+    int64_t lastIndex = -1;
+    std::size_t found = 0;
+    for (std::size_t offset = 0; offset < data.size(); offset += sizeof(Record)) {
+        Record record{};
+        memcpy(&record, &data[offset], sizeof(record));
+        const Record expected = makeRecord(record.index);
+        zassert_true(record.index < numRecords && record.index > lastIndex, "%zu free: record %u out of order at %zu",
+                     freeSpace, record.index, offset);
+        zassert_mem_equal(&record, &expected, sizeof(record), "%zu free: record %u corrupt",
+                          freeSpace, record.index);
+
+        // Skipped records must have reported an error
+        for (int64_t skipped = lastIndex + 1; skipped < record.index; skipped++) {
+            zassert_false(logged[skipped], "%zu free: logged record %lld is missing", freeSpace, static_cast<long long>(skipped));
+        }
+        lastIndex = record.index;
+        found++;
+    }
+    zassert_equal(lastIndex, numRecords - 1, "%zu free: last record missing", freeSpace);
+    zassert_true(found >= static_cast<std::size_t>(std::count(logged.begin(), logged.end(), true)));
+}
+} // namespace
+
+ZTEST(datalogger, test_full_disk_keeps_records_aligned) {
+    // Every cut point across the first few blocks, so short writes land before, inside and after a record that
+    // straddles a block boundary
+    for (std::size_t freeSpace = 0; freeSpace <= 4 * blockSize; freeSpace++) {
+        checkAlignedAfterFullDisk(freeSpace);
+    }
+}
+
+ZTEST(datalogger, test_reopen_growing_drops_old_records) {
+    files.clear();
+    spaceLeft = SIZE_MAX;
+
+    {
+        CDataLogger<Record, blockSize> logger{logPath};
+        for (uint32_t i = 0; i < numRecords; i++) {
+            logger.write(makeRecord(i));
+        }
+        logger.close();
+    }
+    {
+        CDataLogger<Record, blockSize> logger{logPath};
+        logger.write(makeRecord(numRecords));
+        logger.close();
+    }
+
+    const std::vector<uint8_t> &data = files[logPath];
+    const Record expected = makeRecord(numRecords);
+    zassert_equal(data.size(), sizeof(Record), "Old records left behind a %zu byte file", data.size());
+    zassert_mem_equal(data.data(), &expected, sizeof(expected));
+}
+
+ZTEST_SUITE(datalogger, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2025 RIT Launch Initiative
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "f_core/utils/c_flat_map.h"
+
+#include <array>
+#include <map>
+#include <zephyr/ztest.h>
+
+namespace {
+// Sends every key to the same slot, so every lookup and removal has to walk a probe sequence
+struct CollidingHash {
+    constexpr uint32_t operator()(const uint16_t &) const { return 0; }
+};
+
+// Sends keys to slots near each other, so probe sequences of different home slots run into each other
+struct ClusteringHash {
+    constexpr uint32_t operator()(const uint16_t &key) const { return key / 3; }
+};
+
+constexpr std::array<uint16_t, 4> ports = {12000, 12100, 12200, 12300};
+
+template <typename Hash>
+constexpr bool insertGetRemove() {
+    CFlatMap<uint16_t, int, 4, Hash> map;
+    for (std::size_t i = 0; i < ports.size(); i++) {
+        if (!map.Insert(ports[i], static_cast<int>(i))) {
+            return false;
+        }
+    }
+
+    if (!map.Remove(ports[1]) || map.Contains(ports[1]) || map.Get(ports[1]).has_value() || map.Size() != 3) {
+        return false;
+    }
+    // The rest are still found after the entries and slots around them moved
+    return map.Get(ports[0]) == 0 && map.Get(ports[2]) == 2 && map.Get(ports[3]) == 3 && !map.Remove(ports[1]);
+}
+
+constexpr bool rejectsDuplicatesAndOverflow() {
+    CFlatMap<uint16_t, int, 2> map;
+    return map.Insert(1, 10) && !map.Insert(1, 20) && map.Get(1) == 10 && map.Insert(2, 20) && !map.Insert(3, 30) &&
+           map.Size() == 2 && !map.Contains(3);
+}
+
+constexpr int sumValues() {
+    CFlatMap<uint16_t, int, 4> map{ports, 1};
+    map.Set(ports[2], 5);
+    int sum = 0;
+    for (const auto &[key, value] : map) {
+        sum += value;
+    }
+    return sum;
+}
+
+constexpr CFlatMap<uint16_t, int, 4> compileTimeMap{ports, 7};
+
+static_assert(insertGetRemove<CFlatMapHash<uint16_t>>());
+static_assert(insertGetRemove<CollidingHash>());
+static_assert(insertGetRemove<ClusteringHash>());
+static_assert(rejectsDuplicatesAndOverflow());
+static_assert(sumValues() == 8);
+static_assert(compileTimeMap.Size() == 4 && compileTimeMap.Get(12300) == 7 && !compileTimeMap.Contains(12050));
+static_assert(decltype(compileTimeMap)::MaxSize() == 4);
+
+/**
+ * Run the same random inserts, sets and removes against a map and std::map, checking they always agree
+ */
+template <typename Hash>
+void checkAgainstStdMap(uint32_t seed) {
+    static constexpr std::size_t capacity = 24;
+    CFlatMap<uint16_t, uint32_t, capacity, Hash> map;
+    std::map<uint16_t, uint32_t> reference;
+
+    // xorshift, so the sequence is the same on every platform
+    uint32_t state = seed;
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    };
+
+    for (uint32_t i = 0; i < 5000; i++) {
+        // Few enough keys that the map is often full and removes often hit
+        const uint16_t key = next() % 40;
+        const bool exists = reference.contains(key);
+        switch (next() % 3) {
+            case 0: {
+                const bool inserted = map.Insert(key, i);
+                zassert_equal(inserted, !exists && reference.size() < capacity, "Insert of %u", key);
+                if (inserted) {
+                    reference[key] = i;
+                }
+                break;
+            }
+            case 1:
+                zassert_equal(map.Set(key, i), exists, "Set of %u", key);
+                if (exists) {
+                    reference[key] = i;
+                }
+                break;
+            default:
+                zassert_equal(map.Remove(key), exists, "Remove of %u", key);
+                reference.erase(key);
+                break;
+        }
+
+        zassert_equal(map.Size(), reference.size());
+    }
+
+    for (uint16_t key = 0; key < 40; key++) {
+        const auto expected = reference.find(key);
+        const std::optional<uint32_t> value = map.Get(key);
+        zassert_equal(value.has_value(), expected != reference.end(), "Get of %u", key);
+        if (value) {
+            zassert_equal(*value, expected->second, "Value of %u", key);
+        }
+    }
+
+    std::size_t iterated = 0;
+    for (const auto &[key, value] : map) {
+        zassert_equal(reference.at(key), value, "Iterated value of %u", key);
+        iterated++;
+    }
+    zassert_equal(iterated, reference.size());
+}
+} // namespace
+
+ZTEST(flat_map, test_matches_std_map) {
+    checkAgainstStdMap<CFlatMapHash<uint16_t>>(1);
+    checkAgainstStdMap<CFlatMapHash<uint16_t>>(2);
+}
+
+ZTEST(flat_map, test_matches_std_map_with_collisions) {
+    checkAgainstStdMap<CollidingHash>(3);
+    checkAgainstStdMap<ClusteringHash>(4);
+}
+
+ZTEST(flat_map, test_index_and_iterate) {
+    CFlatMap<uint16_t, int, 4> map{ports, 0};
+    map[ports[3]] = 4;
+
+    for (auto &&[key, value] : map) {
+        value++;
+    }
+
+    zassert_equal(map.Get(ports[0]), 1);
+    zassert_equal(map.Get(ports[3]), 5);
+    zassert_equal(map[ports[1]], 1);
+}
+
+ZTEST_SUITE(flat_map, NULL, NULL, NULL, NULL, NULL);
@@ -49,3 +49,23 @@ function(AutocodeTypes)
 
     add_custom_target(ac_types DEPENDS ${OUTPUT})
 endfunction()
+
+function(FlightLogDictionary)
+    set(AC_SCRIPT ${FSW_ROOT}/tools/autocoders/ac_flight_log_dict.py)
+    set(DEFAULT_SOURCES ${FSW_ROOT}/include ${FSW_ROOT}/lib ${CMAKE_CURRENT_SOURCE_DIR}/src)
+    set(SOURCES ${DEFAULT_SOURCES})
+    if(ARGC GREATER 0)
+        foreach(SOURCE ${ARGV})
+            list(APPEND SOURCES ${SOURCE})
+        endforeach()
+    endif()
+    set(OUTPUT ${CMAKE_BINARY_DIR}/flight_log_dictionary.json)
+
+    # Format strings can be added to any source, so the sources are searched on every build
+    add_custom_target(
+        flight_log_dictionary ALL
+        COMMAND python3 ${AC_SCRIPT} -s ${SOURCES} -o ${OUTPUT}
+        BYPRODUCTS ${OUTPUT}
+        COMMENT "Collecting flight log format strings into ${OUTPUT}"
+    )
+endfunction()
@@ -7,6 +7,7 @@
 #include <f_core/os/flight_log.hpp>
 #include <zephyr/fs/fs.h>
 #include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
 
 /**
  * Phase Controller
@@ -18,14 +19,24 @@
  * @tparam SourceID an enum type identifying Sources. Any value of type SourceID should not exceed num_sources
  * @tparam num_sources the number of unique sources that will be passed to any member function. num_sources > any value of type SourceID
  * @tparam num_timers the number of timer-triggered events that will be used
+ * @tparam log_queue_length the number of flight log records that can wait to be written before new ones are dropped
+ *
+ * SubmitEvent is safe to call from ISRs (timer events are submitted from k_timer expiry). It only touches atomic state
+ * bitmaps, the k_event and a k_msgq, and leaves formatting and writing the flight log to a work item on the system
+ * work queue.
  */
-template <typename EventID, std::size_t num_events, typename SourceID, std::size_t num_sources, std::size_t num_timers>
+template <typename EventID, std::size_t num_events, typename SourceID, std::size_t num_sources, std::size_t num_timers,
+          std::size_t log_queue_length = 16>
 class CPhaseController {
   public:
     static_assert(num_events <= 32, "Current implementation is limited to 32 events");
+    static_assert(num_sources <= 32, "Current implementation is limited to 32 sources");
     static_assert(std::is_enum_v<EventID>, "EventIDs must be enums");
     static_assert(std::is_enum_v<SourceID>, "SourceID must be enums");
 
+    using EventType = EventID;
+    using SourceType = SourceID;
+
     /**
      * Description of a timer-triggered event
      */
@@ -76,6 +87,11 @@ class CPhaseController {
 
         k_event_init(&osEvents);
         k_event_clear(&osEvents, 0xFFFFFFFF);
+
+        k_msgq_init(&logQueue, logQueueBuffer, sizeof(LogRecord), log_queue_length);
+        logWork.controller = this;
+        k_work_init(&logWork.work, log_work_cb);
+
         if (flight_log != nullptr) {
             flight_log->Write("CPhaseController initialized");
         }
@@ -88,6 +104,9 @@ class CPhaseController {
         for (std::size_t i = 0; i < num_timers; i++) {
             k_timer_stop(&timers[i]);
         }
+        k_work_sync sync;
+        k_work_cancel_sync(&logWork.work, &sync);
+        drainLog();
     }
 
     /**
@@ -98,54 +117,82 @@ class CPhaseController {
 
     /**
      * Log a message like "1234ms: Boost from IMU1"
+     * Does filesystem I/O, so never call this from an ISR
      * @param event the event that occured 'Boost'
      * @param source the source that triggered this event 'IMU1'
+     * @param timestamp uptime the source reported the event at
      * @return 0 if successfully written to the flight log. Otherwise, the filesystem error from writing.
      */
-    int LogSourceEvent(EventID event, SourceID source) {
+    int LogSourceEvent(EventID event, SourceID source, int64_t timestamp = k_uptime_get()) {
         if (flight_log != nullptr) {
-            constexpr size_t buf_size = 64;
-            char string_buf[buf_size] = {0};
-            int num_wrote = snprintf(string_buf, buf_size, "%-10s from %s", eventNames[event], sourceNames[source]);
-            return flight_log->Write(string_buf, num_wrote);
+            return flight_log->Write(timestamp, FLIGHT_LOG_FORMAT("%-10s from %s"), eventNames[event],
+                                     sourceNames[source]);
         }
         return 0;
     }
 
     /**
      * Logs a message like "Boost confirmed" or "Noseover confirmed but already happened. Not Dispatching"
+     * Does filesystem I/O, so never call this from an ISR
      * @param event the event that was confirmed
      * @param currentState the state of that even as gotten from HasEventOccured(event) *before* this confirmation. 
+     * @param timestamp uptime the event was confirmed at
+     * @param dispatchNs time from the decision to the event being posted, if it was. Not logged if 0
      * @return 0 if successfully written to the flight log. Otherwise, the filesystem error from writing.
      */
-    int LogEventConfirmed(EventID event, bool currentState) {
-        if (flight_log != nullptr) {
-            constexpr size_t buf_size = 64;
-            char string_buf[buf_size] = {0};
-            int num_wrote = snprintf(string_buf, buf_size, "%-10s confirmed%s", eventNames[event],
-                                     currentState ? " but already happened. Not dispatching" : "");
-            return flight_log->Write(string_buf, num_wrote);
+    int LogEventConfirmed(EventID event, bool currentState, int64_t timestamp = k_uptime_get(),
+                          uint32_t dispatchNs = 0) {
+        if (flight_log == nullptr) {
+            return 0;
         }
-        return 0;
+        if (currentState) {
+            return flight_log->Write(timestamp,
+                                     FLIGHT_LOG_FORMAT("%-10s confirmed but already happened. Not dispatching"),
+                                     eventNames[event]);
+        } else if (dispatchNs > 0) {
+            return flight_log->Write(timestamp, FLIGHT_LOG_FORMAT("%-10s confirmed (dispatched in %u ns)"),
+                                     eventNames[event], dispatchNs);
+        }
+        return flight_log->Write(timestamp, FLIGHT_LOG_FORMAT("%-10s confirmed"), eventNames[event]);
     }
 
     /**
      * Tell the controller that a specific source thinks an event has happened
      * If this submission of an event causes the decider to return true, the controller will start reporting that the event has occured
+     * ISR safe: the flight log entries are queued and written later by a work item
      * @param source the SourceID of the source that thinks an event has happened
      * @param event the event that the source thinks happened
      */
     void SubmitEvent(SourceID source, EventID event) {
-        uint32_t event_bit = (1 << (uint32_t) event);
-        sourceStates[event][source] = true;
+        const uint32_t start = k_cycle_get_32();
+        const uint32_t event_bit = BIT(static_cast<uint32_t>(event));
+
+        const uint32_t source_bits =
+            static_cast<uint32_t>(atomic_or(&sourceBits[event], BIT(static_cast<uint32_t>(source)))) |
+            BIT(static_cast<uint32_t>(source));
+        SourceStates states{};
+        for (std::size_t i = 0; i < num_sources; i++) {
+            states[i] = (source_bits & BIT(i)) != 0;
+        }
+
+        LogRecord record{
+            .timestamp = k_uptime_get(),
+            .dispatchCycles = 0,
+            .event = event,
+            .source = source,
+            .confirmed = false,
+            .alreadyHappened = false,
+        };
 
         // If that event submission caused the event to fully trigger, send message
-        if (deciders[event](sourceStates[event])) {
-            bool last_state = eventStates[event];
-            if (!last_state) {
-                // dispatch event
-                eventStates[event] = true;
+        if (deciders[event](states)) {
+            record.confirmed = true;
+            // Only the first submitter to set the bit dispatches, even if several race here
+            record.alreadyHappened = (atomic_or(&eventBits, event_bit) & event_bit) != 0;
+            if (!record.alreadyHappened) {
                 k_event_post(&osEvents, event_bit);
+                record.dispatchCycles = k_cycle_get_32() - start;
+                noteDispatchCycles(record.dispatchCycles);
 
                 // start any necessary timers
                 for (std::size_t i = 0; i < num_timers; i++) {
@@ -154,11 +201,32 @@ class CPhaseController {
                     }
                 }
             }
-            LogSourceEvent(event, source);
-            LogEventConfirmed(event, last_state);
-        } else {
-            LogSourceEvent(event, source);
         }
+
+        if (flight_log != nullptr) {
+            if (k_msgq_put(&logQueue, &record, K_NO_WAIT) != 0) {
+                atomic_inc(&droppedLogRecords);
+            }
+            k_work_submit(&logWork.work);
+        }
+    }
+
+    /**
+     * Write any queued flight log entries now, from the calling thread
+     * Call before closing the flight log so the last events make it in. Never call this from an ISR
+     */
+    void FlushLog() {
+        k_work_sync sync;
+        k_work_cancel_sync(&logWork.work, &sync);
+        drainLog();
+    }
+
+    /**
+     * Get the longest time an event took from its decision to being posted to waiting threads
+     * @return the worst dispatch latency seen so far in nanoseconds
+     */
+    uint64_t GetMaxDispatchLatencyNs() const {
+        return k_cyc_to_ns_floor64(static_cast<uint32_t>(atomic_get(&maxDispatchCycles)));
     }
 
     /**
@@ -166,7 +234,7 @@ class CPhaseController {
      * Checks the state of the event after the decision function NOT the per-source event states
      * @return true if the requested event has occured
      */
-    bool HasEventOccured(EventID event) { return eventStates[event]; }
+    bool HasEventOccured(EventID event) { return (atomic_get(&eventBits) & BIT(static_cast<uint32_t>(event))) != 0; }
 
     /**
      * Wait for an event to occur (or timeout first)
@@ -189,6 +257,60 @@ class CPhaseController {
         TimerEvent event;             //< information about the event
     };
 
+    /**
+     * Flight log entry waiting to be written
+     */
+    struct LogRecord {
+        int64_t timestamp;       //< uptime the event was submitted at
+        uint32_t dispatchCycles; //< cycles from the decision to k_event_post. 0 if not dispatched
+        EventID event;
+        SourceID source;
+        bool confirmed;       //< the decider agreed the event happened
+        bool alreadyHappened; //< the event had already been dispatched before this submission
+    };
+
+    /**
+     * Work item that can find its way back to the controller
+     */
+    struct LogWork {
+        k_work work;
+        CPhaseController *controller;
+    };
+
+    /**
+     * Writes queued log records to the flight log. Runs on the system work queue
+     */
+    static void log_work_cb(struct k_work *work) { CONTAINER_OF(work, LogWork, work)->controller->drainLog(); }
+
+    void drainLog() {
+        if (flight_log == nullptr) {
+            return;
+        }
+
+        const atomic_val_t dropped = atomic_clear(&droppedLogRecords);
+        if (dropped > 0) {
+            flight_log->Write(FLIGHT_LOG_FORMAT("%ld phase log records dropped"), static_cast<long>(dropped));
+        }
+
+        LogRecord record;
+        while (k_msgq_get(&logQueue, &record, K_NO_WAIT) == 0) {
+            LogSourceEvent(record.event, record.source, record.timestamp);
+            if (record.confirmed) {
+                // 0 for events that weren't dispatched, so LogEventConfirmed leaves the time out
+                const uint64_t dispatch_ns = k_cyc_to_ns_floor64(record.dispatchCycles);
+                LogEventConfirmed(record.event, record.alreadyHappened, record.timestamp,
+                                  static_cast<uint32_t>(MIN(dispatch_ns, static_cast<uint64_t>(UINT32_MAX))));
+            }
+        }
+    }
+
+    void noteDispatchCycles(uint32_t cycles) {
+        atomic_val_t current = atomic_get(&maxDispatchCycles);
+        while (static_cast<uint32_t>(current) < cycles && !atomic_cas(&maxDispatchCycles, current, cycles)) {
+            current = atomic_get(&maxDispatchCycles);
+        }
+    }
+
     /**
      * Callback function for timer events. 
      * 'this' is stored in the InternalTimerEvent data
@@ -202,10 +324,10 @@ class CPhaseController {
 
     // Current State of the system
 
-    /// state of events per source
-    std::array<SourceStates, num_events> sourceStates = {false};
-    /// the state of events that have been agreed to have happened based on deciders and per-source states
-    std::array<bool, num_events> eventStates = {false};
+    /// state of events per source, one bit per SourceID
+    std::array<atomic_t, num_events> sourceBits = {0};
+    /// the state of events that have been agreed to have happened based on deciders and per-source states, one bit per EventID
+    atomic_t eventBits = ATOMIC_INIT(0);
 
     // Timer handling
     std::array<struct k_timer, num_timers> timers = {0};
@@ -214,6 +336,13 @@ class CPhaseController {
     // OS events for handling synchronization
     k_event osEvents;
 
+    // Deferred flight logging
+    k_msgq logQueue;
+    alignas(LogRecord) char logQueueBuffer[sizeof(LogRecord) * log_queue_length];
+    LogWork logWork;
+    atomic_t droppedLogRecords = ATOMIC_INIT(0);
+    atomic_t maxDispatchCycles = ATOMIC_INIT(0);
+
     // consts for logging and deciding. These will not change after construction
     const std::array<const char *, num_sources> &sourceNames;
     const std::array<const char *, num_events> &eventNames;
@@ -0,0 +1,193 @@
+#ifndef C_INSTRUMENTED_MESSAGE_PORT_H
+#define C_INSTRUMENTED_MESSAGE_PORT_H
+
+#include <f_core/messaging/c_message_port.h>
+#include <f_core/messaging/c_message_port_stats.h>
+
+#include <array>
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+
+/**
+ * Wraps another message port and records its CMessagePortStats. Send and receive through the wrapper instead of the
+ * port itself.
+ *
+ * Latency comes from timestamps kept in send order, which matches the order messages come out of first in first out
+ * ports (e.g. CMsgqMessagePort, CSpscMessagePort). Messages sent while more than StampCapacity are queued get no
+ * latency sample. Ports that drop or overwrite messages internally (e.g. CMailboxPort) still get their counts, but
+ * depth and latency don't mean much for them.
+ * @tparam T the message type
+ * @tparam StampCapacity most queued messages timestamped at once. Set it to the port's capacity
+ */
+template <typename T, std::size_t StampCapacity = 16>
+class CInstrumentedMessagePort : public CMessagePort<T> {
+  public:
+    /**
+     * Constructor
+     * @param name Name to report the port's stats under
+     * @param port Port to wrap
+     */
+    CInstrumentedMessagePort(const char *name, CMessagePort<T> &port) : port(port), stats(name) {}
+
+    /**
+     * See parent docs
+     */
+    int Send(const T &message, const k_timeout_t timeout = K_NO_WAIT) override {
+        const uint32_t now = k_cycle_get_32();
+        int ret = port.Send(message, timeout);
+        if (ret < 0) {
+            stats.RecordDrop();
+            return ret;
+        }
+        stamp(now, 1);
+        stats.RecordSend();
+        return ret;
+    }
+
+    /**
+     * See parent docs. A refused message is offered again later, so it isn't recorded as a drop
+     */
+    int TrySend(const T &message, uint32_t sentMs) override {
+        const uint32_t now = k_cycle_get_32();
+        int ret = port.TrySend(message, sentMs);
+        if (ret < 0) {
+            return ret;
+        }
+        stamp(now, 1);
+        stats.RecordSend();
+        return ret;
+    }
+
+    /**
+     * See parent docs
+     */
+    int Receive(T &message, const k_timeout_t timeout = K_NO_WAIT) override {
+        int ret = port.Receive(message, timeout);
+        if (ret == 0) {
+            received(1);
+        }
+        return ret;
+    }
+
+    /**
+     * See parent docs
+     */
+    int SendMany(std::span<const T> messages, const k_timeout_t timeout = K_NO_WAIT) override {
+        const uint32_t now = k_cycle_get_32();
+        int ret = port.SendMany(messages, timeout);
+        const std::size_t sent = MAX(ret, 0);
+        if (sent > 0) {
+            stamp(now, sent);
+            stats.RecordSend(sent);
+        }
+        if (sent < messages.size()) {
+            stats.RecordDrop(messages.size() - sent);
+        }
+        return ret;
+    }
+
+    /**
+     * See parent docs
+     */
+    int ReceiveMany(std::span<T> messages, const k_timeout_t timeout = K_NO_WAIT) override {
+        int ret = port.ReceiveMany(messages, timeout);
+        if (ret > 0) {
+            received(ret);
+        }
+        return ret;
+    }
+
+    /**
+     * See parent docs
+     */
+    int ReceiveManyStamped(std::span<T> messages, std::span<uint32_t> sentMs,
+                           const k_timeout_t timeout = K_NO_WAIT) override {
+        int ret = port.ReceiveManyStamped(messages, sentMs, timeout);
+        if (ret > 0) {
+            received(ret);
+        }
+        return ret;
+    }
+
+    /**
+     * See parent docs
+     */
+    uint32_t GetDropped() const override { return port.GetDropped(); }
+
+    /**
+     * See parent docs
+     */
+    void Clear() override {
+        port.Clear();
+        stats.RecordClear();
+#ifdef CONFIG_F_CORE_MESSAGE_PORT_STATS
+        k_spinlock_key_t key = k_spin_lock(&lock);
+        receiveSequence = sendSequence;
+        k_spin_unlock(&lock, key);
+#endif
+    }
+
+#ifdef CONFIG_POLL
+    /**
+     * See parent docs
+     */
+    bool InitPollEvent(k_poll_event &event) override { return port.InitPollEvent(event); }
+#endif
+
+    /**
+     * Get the wrapped port's stats
+     * @return the stats
+     */
+    const CMessagePortStats &GetStats() const { return stats; }
+
+  private:
+    CMessagePort<T> &port;
+    CMessagePortStats stats;
+#ifdef CONFIG_F_CORE_MESSAGE_PORT_STATS
+    struct Stamp {
+        uint32_t sequence;
+        uint32_t cycles;
+    };
+
+    k_spinlock lock;
+    // Sequences start at 1 so the zeroed stamps don't match anything
+    std::array<Stamp, StampCapacity> stamps{};
+    uint32_t sendSequence = 1;
+    uint32_t receiveSequence = 1;
+#endif
+
+    /**
+     * Timestamp messages that were just sent
+     */
+    void stamp(uint32_t cycles, std::size_t count) {
+#ifdef CONFIG_F_CORE_MESSAGE_PORT_STATS
+        k_spinlock_key_t key = k_spin_lock(&lock);
+        for (std::size_t i = 0; i < count; i++) {
+            const uint32_t sequence = sendSequence++;
+            stamps[sequence % StampCapacity] = {.sequence = sequence, .cycles = cycles};
+        }
+        k_spin_unlock(&lock, key);
+#endif
+    }
+
+    /**
+     * Count messages that were just received and record the latency of the ones with a timestamp
+     */
+    void received(std::size_t count) {
+        stats.RecordReceive(count);
+#ifdef CONFIG_F_CORE_MESSAGE_PORT_STATS
+        for (std::size_t i = 0; i < count; i++) {
+            k_spinlock_key_t key = k_spin_lock(&lock);
+            const uint32_t sequence = receiveSequence++;
+            const Stamp sent = stamps[sequence % StampCapacity];
+            k_spin_unlock(&lock, key);
+            // A newer message took the slot, or the sender hasn't stamped this one yet
+            if (sent.sequence == sequence) {
+                stats.RecordLatency(sent.cycles);
+            }
+        }
+#endif
+    }
+};
+
+#endif // C_INSTRUMENTED_MESSAGE_PORT_H
@@ -0,0 +1,308 @@
+#ifndef C_MAILBOX_PORT_H
+#define C_MAILBOX_PORT_H
+
+#include <f_core/messaging/c_message_port.h>
+
+#include <array>
+#include <type_traits>
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/barrier.h>
+
+namespace detail {
+/**
+ * A value guarded by a sequence lock. The sequence is odd while a write is in progress and goes up by two with every
+ * write, so readers copy the value and retry if the sequence moved underneath them. Writers never wait on readers.
+ */
+template <typename T>
+class seqlock_value {
+  public:
+    static_assert(std::is_trivially_copyable_v<T>, "Values must be trivially copyable");
+
+    /**
+     * Replace the value. Writers are serialized among themselves
+     */
+    void write(const T &new_value) {
+        k_spinlock_key_t key = k_spin_lock(&write_lock);
+        atomic_inc(&sequence);
+        value = new_value;
+        atomic_inc(&sequence);
+        k_spin_unlock(&write_lock, key);
+    }
+
+    /**
+     * Copy out a consistent snapshot of the value
+     * @return the sequence of the snapshot. 0 if nothing has been written yet
+     */
+    uint32_t read(T &out) const {
+        while (true) {
+            const uint32_t before = atomic_get(&sequence);
+            if ((before & 1) != 0) {
+                // Only possible with the writer on another CPU, which is about to finish
+                continue;
+            }
+            out = value;
+            // Keep the copy from being reordered past the second load
+            barrier_dmem_fence_full();
+            if (static_cast<uint32_t>(atomic_get(&sequence)) == before) {
+                return before;
+            }
+        }
+    }
+
+    /**
+     * Get the sequence of the last completed write, without reading the value
+     */
+    uint32_t current() const { return atomic_get(&sequence) & ~1u; }
+
+  private:
+    atomic_t sequence = ATOMIC_INIT(0);
+    k_spinlock write_lock;
+    T value{};
+};
+} // namespace detail
+
+/**
+ * Message port that only holds the latest message. Sending overwrites whatever was there, so it never fails or
+ * blocks, and receivers always get the freshest value. Readers never hold up writers (see detail::seqlock_value).
+ *
+ * Receive() only returns a message that changed since the last Receive(). Read() always returns the latest one.
+ * Meant for one receiving thread, since the "changed since" state is shared. Any number of threads or ISRs may send.
+ * @tparam T the message type
+ */
+template <typename T>
+class CMailboxPort : public CMessagePort<T> {
+  public:
+    /**
+     * Constructor
+     */
+    CMailboxPort() { k_sem_init(&updated, 0, 1); }
+
+    /**
+     * Overwrite the message
+     * @param message Message to send
+     * @param timeout Unused. Sending never waits
+     * @return 0
+     */
+    int Send(const T &message, const k_timeout_t timeout = K_NO_WAIT) override {
+        value.write(message);
+        k_sem_give(&updated);
+        return 0;
+    }
+
+    /**
+     * Receive the message if it changed since the last Receive()
+     * @param message Message to receive
+     * @param timeout Time to wait for a change
+     * @return 0 on success, -ENOMSG if unchanged and not waiting, -EAGAIN if it didn't change in time
+     */
+    int Receive(T &message, const k_timeout_t timeout = K_NO_WAIT) override {
+        const k_timepoint_t end = sys_timepoint_calc(timeout);
+        while (!HasChanged()) {
+            if (K_TIMEOUT_EQ(timeout, K_NO_WAIT)) {
+                // Drop the stale wakeup so a poller sleeps, then look again in case a send gave it in between
+                k_sem_reset(&updated);
+                if (!HasChanged()) {
+                    return -ENOMSG;
+                }
+                break;
+            }
+            if (k_sem_take(&updated, sys_timepoint_timeout(end)) != 0) {
+                return -EAGAIN;
+            }
+        }
+        lastReceived = value.read(message);
+        return 0;
+    }
+
+    /**
+     * Mark the current message as received
+     */
+    void Clear() override { lastReceived = value.current(); }
+
+#ifdef CONFIG_POLL
+    /**
+     * See parent docs
+     */
+    bool InitPollEvent(k_poll_event &event) override {
+        k_poll_event_init(&event, K_POLL_TYPE_SEM_AVAILABLE, K_POLL_MODE_NOTIFY_ONLY, &updated);
+        return true;
+    }
+#endif
+
+    /**
+     * Read the latest message, whether or not it changed
+     * @param message Message to read into
+     * @return true if a message has ever been sent
+     */
+    bool Read(T &message) const { return value.read(message) != 0; }
+
+    /**
+     * Check for a new message
+     * @return true if a message was sent since the last Receive()
+     */
+    bool HasChanged() const { return value.current() != lastReceived; }
+
+  private:
+    detail::seqlock_value<T> value;
+    uint32_t lastReceived = 0;
+    k_sem updated;
+};
+
+/**
+ * Mailboxes for a fixed set of keys, such as one per UDP port, each holding the latest message sent with that key.
+ * Messages carry their own key in the Key member.
+ *
+ * Receive() takes the next changed mailbox in turn, so a key that's sent to often can't starve the others.
+ * Meant for one receiving thread. Any number of threads or ISRs may send.
+ * @tparam T the message type
+ * @tparam Key pointer to the member of T holding the key (e.g. &RadioBroadcastData::port)
+ * @tparam NumKeys number of keys
+ */
+template <typename T, auto Key, std::size_t NumKeys>
+class CKeyedMailboxPort : public CMessagePort<T> {
+  public:
+    using KeyType = std::remove_cvref_t<decltype(std::declval<T>().*Key)>;
+
+    /**
+     * Constructor
+     * @param keys The keys to hold a mailbox for. Messages with any other key are refused
+     */
+    explicit CKeyedMailboxPort(const std::array<KeyType, NumKeys> &keys) : keys(keys) { k_sem_init(&updated, 0, 1); }
+
+    /**
+     * Overwrite the message in the mailbox of its key
+     * @param message Message to send
+     * @param timeout Unused. Sending never waits
+     * @return 0 on success, -EINVAL if there is no mailbox for the message's key
+     */
+    int Send(const T &message, const k_timeout_t timeout = K_NO_WAIT) override {
+        const int index = indexOf(message.*Key);
+        if (index < 0) {
+            return -EINVAL;
+        }
+        values[index].write(message);
+        k_sem_give(&updated);
+        return 0;
+    }
+
+    /**
+     * Receive the next message that changed since it was last received, taking the keys in turn
+     * @param message Message to receive
+     * @param timeout Time to wait for a change
+     * @return 0 on success, -ENOMSG if nothing changed and not waiting, -EAGAIN if nothing changed in time
+     */
+    int Receive(T &message, const k_timeout_t timeout = K_NO_WAIT) override {
+        const k_timepoint_t end = sys_timepoint_calc(timeout);
+        bool rescanned = false;
+        while (true) {
+            for (std::size_t i = 1; i <= NumKeys; i++) {
+                const std::size_t index = (next + i) % NumKeys;
+                if (values[index].current() != lastReceived[index]) {
+                    lastReceived[index] = values[index].read(message);
+                    next = index;
+                    return 0;
+                }
+            }
+
+            if (K_TIMEOUT_EQ(timeout, K_NO_WAIT)) {
+                if (rescanned) {
+                    return -ENOMSG;
+                }
+                // Drop the stale wakeup so a poller sleeps, then look again in case a send gave it in between
+                k_sem_reset(&updated);
+                rescanned = true;
+                continue;
+            }
+            if (k_sem_take(&updated, sys_timepoint_timeout(end)) != 0) {
+                return -EAGAIN;
+            }
+        }
+    }
+
+    /**
+     * Receive the message with a key if it changed since it was last received
+     * @param key Key of the mailbox
+     * @param message Message to receive
+     * @param timeout Time to wait for a change
+     * @return 0 on success, -EINVAL for an unknown key, -ENOMSG if unchanged and not waiting, -EAGAIN if it didn't
+     * change in time
+     */
+    int Receive(const KeyType &key, T &message, const k_timeout_t timeout = K_NO_WAIT) {
+        const int index = indexOf(key);
+        if (index < 0) {
+            return -EINVAL;
+        }
+
+        const k_timepoint_t end = sys_timepoint_calc(timeout);
+        while (values[index].current() == lastReceived[index]) {
+            if (K_TIMEOUT_EQ(timeout, K_NO_WAIT)) {
+                return -ENOMSG;
+            }
+            if (k_sem_take(&updated, sys_timepoint_timeout(end)) != 0) {
+                return -EAGAIN;
+            }
+        }
+        lastReceived[index] = values[index].read(message);
+        return 0;
+    }
+
+    /**
+     * Mark every mailbox as received
+     */
+    void Clear() override {
+        for (std::size_t i = 0; i < NumKeys; i++) {
+            lastReceived[i] = values[i].current();
+        }
+    }
+
+#ifdef CONFIG_POLL
+    /**
+     * See parent docs. Only Receive() without a key resets the event
+     */
+    bool InitPollEvent(k_poll_event &event) override {
+        k_poll_event_init(&event, K_POLL_TYPE_SEM_AVAILABLE, K_POLL_MODE_NOTIFY_ONLY, &updated);
+        return true;
+    }
+#endif
+
+    /**
+     * Read the latest message with a key, whether or not it changed
+     * @param key Key of the mailbox
+     * @param message Message to read into
+     * @return true if a message with the key has ever been sent
+     */
+    bool Read(const KeyType &key, T &message) const {
+        const int index = indexOf(key);
+        return index >= 0 && values[index].read(message) != 0;
+    }
+
+    /**
+     * Check for a new message with a key
+     * @param key Key of the mailbox
+     * @return true if a message with the key was sent since it was last received
+     */
+    bool HasChanged(const KeyType &key) const {
+        const int index = indexOf(key);
+        return index >= 0 && values[index].current() != lastReceived[index];
+    }
+
+  private:
+    const std::array<KeyType, NumKeys> keys;
+    std::array<detail::seqlock_value<T>, NumKeys> values;
+    std::array<uint32_t, NumKeys> lastReceived{};
+    std::size_t next = NumKeys - 1;
+    k_sem updated;
+
+    int indexOf(const KeyType &key) const {
+        for (std::size_t i = 0; i < NumKeys; i++) {
+            if (keys[i] == key) {
+                return i;
+            }
+        }
+        return -1;
+    }
+};
+
+#endif // C_MAILBOX_PORT_H
@@ -1,6 +1,7 @@
 #ifndef CMESSAGEPORT_H
 #define CMESSAGEPORT_H
 
+#include <span>
 #include <zephyr/kernel.h>
 
 template <typename T>
@@ -34,10 +35,101 @@ public:
      */
     virtual int Receive(T& message, const k_timeout_t timeout = K_NO_WAIT) = 0;
 
+    /**
+     * Offer a message without waiting, for senders that hold on to it and offer it again later. A refusal isn't a
+     * lost message, so ports that count failed sends as drops don't count it
+     * @param message Message to send
+     * @param sentMs Uptime the message was first sent at, for ports that keep send times
+     * @return Zephyr status code
+     */
+    virtual int TrySend(const T &message, uint32_t sentMs) {
+        return Send(message, K_NO_WAIT);
+    }
+
+    /**
+     * Send several messages, in order
+     * @param messages Messages to send
+     * @param timeout Time to wait for room for each message
+     * @return Number of messages sent (stopping at the first that couldn't be), or a Zephyr status code if none were
+     */
+    virtual int SendMany(std::span<const T> messages, const k_timeout_t timeout = K_NO_WAIT) {
+        std::size_t sent = 0;
+        for (; sent < messages.size(); sent++) {
+            int ret = Send(messages[sent], timeout);
+            if (ret < 0) {
+                return sent > 0 ? static_cast<int>(sent) : ret;
+            }
+        }
+        return sent;
+    }
+
+    /**
+     * Receive every waiting message that fits, waiting only for the first
+     * @param messages Buffer to receive messages into
+     * @param timeout Time to wait for the first message
+     * @return Number of messages received, or a Zephyr status code if none were
+     */
+    virtual int ReceiveMany(std::span<T> messages, const k_timeout_t timeout = K_NO_WAIT) {
+        if (messages.empty()) {
+            return 0;
+        }
+
+        int ret = Receive(messages[0], timeout);
+        if (ret < 0) {
+            return ret;
+        }
+
+        std::size_t received = 1;
+        while (received < messages.size() && Receive(messages[received], K_NO_WAIT) == 0) {
+            received++;
+        }
+        return received;
+    }
+
+    /**
+     * Receive like ReceiveMany(), along with the uptime each message was sent at, for loggers that stamp every record.
+     * Ports that don't keep send times stamp the messages with when they were received
+     * @param messages Buffer to receive messages into
+     * @param sentMs Buffer for the uptime in ms each message was sent at. Must be at least as long as messages
+     * @param timeout Time to wait for the first message
+     * @return Number of messages received, or a Zephyr status code if none were
+     */
+    virtual int ReceiveManyStamped(std::span<T> messages, std::span<uint32_t> sentMs,
+                                   const k_timeout_t timeout = K_NO_WAIT) {
+        int received = ReceiveMany(messages, timeout);
+        const uint32_t now = k_uptime_get_32();
+        for (int i = 0; i < received; i++) {
+            sentMs[i] = now;
+        }
+        return received;
+    }
+
+    /**
+     * Get the number of messages the port itself has dropped, such as a topic subscriber overflowing. Messages a
+     * sender failed to send aren't counted, since the sender already got an error
+     * @return Messages dropped since construction
+     */
+    virtual uint32_t GetDropped() const {
+        return 0;
+    }
+
     /**
      * Clear the message port
      */
     virtual void Clear() = 0;
+
+#ifdef CONFIG_POLL
+    /**
+     * Set up a poll event that is ready while the port may have a message, so the receiver can wait on it with k_poll
+     * alongside other objects (see CWaitSet). It can be ready with nothing to receive, but stops being ready once a
+     * receive without a timeout finds the port empty
+     * @param event Event to set up
+     * @return True on success, false if the port can't be waited on this way
+     */
+    virtual bool InitPollEvent(k_poll_event &event) {
+        return false;
+    }
+#endif
 };
 
 
@@ -0,0 +1,225 @@
+#ifndef C_MESSAGE_PORT_STATS_H
+#define C_MESSAGE_PORT_STATS_H
+
+#include <f_core/os/flight_log.hpp>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/atomic.h>
+
+/**
+ * Statistics of one message port, as sent over UDP. Multi-byte fields are little endian
+ */
+struct __attribute__((packed)) MessagePortStatsSnapshot {
+    static constexpr std::size_t nameSize = 16;
+    // Bucket i counts latencies in [2^i, 2^(i+1)) us, except bucket 0 also counts 0 us and the last bucket counts
+    // everything longer
+    static constexpr std::size_t latencyBuckets = 24;
+
+    char name[nameSize];
+    uint32_t sends;
+    uint32_t receives;
+    uint32_t drops;
+    uint32_t depth;
+    uint32_t maxDepth;
+    uint32_t latencyUs[latencyBuckets];
+};
+
+/**
+ * Counters for a message port: messages sent, received and dropped, the current and highest queue depth, and a log2
+ * histogram of how long messages waited between being sent and received. Every port constructed with a name is added
+ * to a list so the whole lot can be sent over UDP (CMessagePortStatsTenant) or written to a flight log (WriteAll()).
+ *
+ * Recording is a handful of atomic operations, cheap enough to leave on in flight. Turning off
+ * CONFIG_F_CORE_MESSAGE_PORT_STATS compiles it all out.
+ *
+ * Ports record into this themselves (see CTopicSubscriber), or get wrapped in a CInstrumentedMessagePort.
+ */
+class CMessagePortStats {
+  public:
+    /**
+     * Constructor
+     * @param name Name to report the port under, or nullptr to not report it. Construct named stats before the RTOS
+     * starts
+     */
+    explicit CMessagePortStats(const char *name = nullptr) : name(name) {
+#ifdef CONFIG_F_CORE_MESSAGE_PORT_STATS
+        if (name != nullptr) {
+            k_spinlock_key_t key = k_spin_lock(&listLock);
+            next = head;
+            head = this;
+            k_spin_unlock(&listLock, key);
+        }
+#endif
+    }
+
+    /**
+     * Destructor
+     */
+    ~CMessagePortStats() {
+#ifdef CONFIG_F_CORE_MESSAGE_PORT_STATS
+        k_spinlock_key_t key = k_spin_lock(&listLock);
+        for (CMessagePortStats **link = &head; *link != nullptr; link = &(*link)->next) {
+            if (*link == this) {
+                *link = next;
+                break;
+            }
+        }
+        k_spin_unlock(&listLock, key);
+#endif
+    }
+
+    CMessagePortStats(const CMessagePortStats &) = delete;
+    CMessagePortStats &operator=(const CMessagePortStats &) = delete;
+
+    /**
+     * Record messages being queued
+     * @param count number of messages
+     */
+    void RecordSend(uint32_t count = 1) {
+#ifdef CONFIG_F_CORE_MESSAGE_PORT_STATS
+        atomic_add(&sends, count);
+        const atomic_val_t newDepth = atomic_add(&depth, count) + count;
+        atomic_val_t highest = atomic_get(&maxDepth);
+        while (newDepth > highest && !atomic_cas(&maxDepth, highest, newDepth)) {
+            highest = atomic_get(&maxDepth);
+        }
+#endif
+    }
+
+    /**
+     * Record messages being taken off the queue by the receiver
+     * @param count number of messages
+     */
+    void RecordReceive(uint32_t count = 1) {
+#ifdef CONFIG_F_CORE_MESSAGE_PORT_STATS
+        atomic_add(&receives, count);
+        atomic_sub(&depth, count);
+#endif
+    }
+
+    /**
+     * Record messages that were lost
+     * @param count number of messages
+     * @param queued true if they had been queued (e.g. dropped to make room), false if they never made it in
+     */
+    void RecordDrop(uint32_t count = 1, bool queued = false) {
+#ifdef CONFIG_F_CORE_MESSAGE_PORT_STATS
+        atomic_add(&drops, count);
+        if (queued) {
+            atomic_sub(&depth, count);
+        }
+#endif
+    }
+
+    /**
+     * Record everything queued being dropped at once (e.g. the port was cleared)
+     */
+    void RecordClear() {
+#ifdef CONFIG_F_CORE_MESSAGE_PORT_STATS
+        const atomic_val_t cleared = atomic_set(&depth, 0);
+        if (cleared > 0) {
+            atomic_add(&drops, cleared);
+        }
+#endif
+    }
+
+    /**
+     * Record how long a message waited in the queue
+     * @param sentCycles k_cycle_get_32() when the message was sent
+     */
+    void RecordLatency(uint32_t sentCycles) {
+#ifdef CONFIG_F_CORE_MESSAGE_PORT_STATS
+        const uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - sentCycles);
+        const std::size_t bucket = us < 2 ? 0 : 31 - __builtin_clz(us);
+        atomic_inc(&latencyUs[MIN(bucket, latencyUs.size() - 1)]);
+#endif
+    }
+
+    /**
+     * Copy out the current counters
+     * @param snapshot Snapshot to fill in
+     */
+    void GetSnapshot(MessagePortStatsSnapshot &snapshot) const {
+        memset(&snapshot, 0, sizeof(snapshot));
+        if (name != nullptr) {
+            strncpy(snapshot.name, name, sizeof(snapshot.name));
+        }
+#ifdef CONFIG_F_CORE_MESSAGE_PORT_STATS
+        snapshot.sends = atomic_get(&sends);
+        snapshot.receives = atomic_get(&receives);
+        snapshot.drops = atomic_get(&drops);
+        // A receiver can take a message before its sender gets to count it
+        snapshot.depth = MAX(atomic_get(&depth), 0);
+        snapshot.maxDepth = atomic_get(&maxDepth);
+        for (std::size_t i = 0; i < latencyUs.size(); i++) {
+            snapshot.latencyUs[i] = atomic_get(&latencyUs[i]);
+        }
+#endif
+    }
+
+    /**
+     * Get the name the port is reported under
+     * @return the name, or nullptr if it isn't reported
+     */
+    const char *GetName() const { return name; }
+
+    /**
+     * Call a function with every named port's stats
+     * @param fn called with a const CMessagePortStats&
+     */
+    template <typename Fn>
+    static void ForEach(Fn fn) {
+#ifdef CONFIG_F_CORE_MESSAGE_PORT_STATS
+        // Ports live as long as their modules, so the list doesn't change once the RTOS is running
+        for (const CMessagePortStats *stats = head; stats != nullptr; stats = stats->next) {
+            fn(*stats);
+        }
+#endif
+    }
+
+    /**
+     * Write every named port's stats to a flight log, one line for the counters and one for the latency histogram
+     * @param flightLog Flight log to write to
+     */
+    static void WriteAll(CFlightLog &flightLog) {
+        ForEach([&flightLog](const CMessagePortStats &stats) {
+            MessagePortStatsSnapshot snapshot{};
+            stats.GetSnapshot(snapshot);
+            flightLog.Write(FLIGHT_LOG_FORMAT("Port %s: %u sent, %u received, %u dropped, depth %u (max %u)"),
+                            stats.GetName(), snapshot.sends, snapshot.receives, snapshot.drops, snapshot.depth,
+                            snapshot.maxDepth);
+
+            // Only the buckets with anything in them, as "<2us:count <16us:count ..."
+            char histogram[96] = {0};
+            std::size_t len = 0;
+            for (std::size_t i = 0; i < MessagePortStatsSnapshot::latencyBuckets && len < sizeof(histogram); i++) {
+                if (snapshot.latencyUs[i] != 0) {
+                    len += snprintf(histogram + len, sizeof(histogram) - len, "%s<%uus:%u", len == 0 ? "" : " ",
+                                    2u << i, snapshot.latencyUs[i]);
+                }
+            }
+            flightLog.Write(FLIGHT_LOG_FORMAT("Port %s latency: %s"), stats.GetName(), histogram);
+        });
+    }
+
+  private:
+    const char *name;
+#ifdef CONFIG_F_CORE_MESSAGE_PORT_STATS
+    atomic_t sends = ATOMIC_INIT(0);
+    atomic_t receives = ATOMIC_INIT(0);
+    atomic_t drops = ATOMIC_INIT(0);
+    atomic_t depth = ATOMIC_INIT(0);
+    atomic_t maxDepth = ATOMIC_INIT(0);
+    std::array<atomic_t, MessagePortStatsSnapshot::latencyBuckets> latencyUs{};
+
+    CMessagePortStats *next = nullptr;
+    static inline CMessagePortStats *head = nullptr;
+    static inline k_spinlock listLock;
+#endif
+};
+
+#endif // C_MESSAGE_PORT_STATS_H
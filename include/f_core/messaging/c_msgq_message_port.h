@@ -37,6 +37,42 @@ public:
         return k_msgq_get(queue, &message, timeout);
     }
 
+    /**
+     * See parent docs
+     */
+    int SendMany(std::span<const T> messages, const k_timeout_t timeout) override {
+        std::size_t sent = 0;
+        for (; sent < messages.size(); sent++) {
+            int ret = k_msgq_put(queue, &messages[sent], timeout);
+            if (ret < 0) {
+                return sent > 0 ? static_cast<int>(sent) : ret;
+            }
+        }
+        return sent;
+    }
+
+    /**
+     * See parent docs
+     */
+    int ReceiveMany(std::span<T> messages, const k_timeout_t timeout) override {
+        if (messages.empty()) {
+            return 0;
+        }
+
+        int ret = k_msgq_get(queue, &messages[0], timeout);
+        if (ret < 0) {
+            return ret;
+        }
+
+        // Only take what was already waiting, so a producer refilling the queue can't keep us here
+        const std::size_t count = MIN(messages.size(), 1 + k_msgq_num_used_get(queue));
+        std::size_t received = 1;
+        while (received < count && k_msgq_get(queue, &messages[received], K_NO_WAIT) == 0) {
+            received++;
+        }
+        return received;
+    }
+
     /**
      * See parent docs
      */
@@ -44,6 +80,16 @@ public:
         k_msgq_purge(queue);
     }
 
+#ifdef CONFIG_POLL
+    /**
+     * See parent docs
+     */
+    bool InitPollEvent(k_poll_event& event) override {
+        k_poll_event_init(&event, K_POLL_TYPE_MSGQ_DATA_AVAILABLE, K_POLL_MODE_NOTIFY_ONLY, queue);
+        return true;
+    }
+#endif
+
 private:
     k_msgq *queue;
 };
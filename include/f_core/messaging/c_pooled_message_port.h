@@ -0,0 +1,255 @@
+#ifndef C_POOLED_MESSAGE_PORT_H
+#define C_POOLED_MESSAGE_PORT_H
+
+#include <f_core/messaging/c_message_port.h>
+
+#include <array>
+#include <new>
+#include <type_traits>
+#include <zephyr/kernel.h>
+
+template <typename T>
+class CPooledMessagePortBase;
+
+/**
+ * Owning handle to a message buffer from a CPooledMessagePortBase. The buffer goes back to the pool when the handle is
+ * destroyed or reset, unless it was sent on first, which hands ownership to the receiver. Move only
+ * @tparam T the message type
+ */
+template <typename T>
+class CPooledMessage {
+  public:
+    /**
+     * Constructor for an empty handle
+     */
+    CPooledMessage() = default;
+
+    CPooledMessage(CPooledMessage &&other) noexcept : slab(other.slab), message(other.message) {
+        other.message = nullptr;
+    }
+
+    CPooledMessage &operator=(CPooledMessage &&other) noexcept {
+        if (this != &other) {
+            Reset();
+            slab = other.slab;
+            message = other.message;
+            other.message = nullptr;
+        }
+        return *this;
+    }
+
+    CPooledMessage(const CPooledMessage &) = delete;
+    CPooledMessage &operator=(const CPooledMessage &) = delete;
+
+    /**
+     * Destructor. Returns the buffer to the pool
+     */
+    ~CPooledMessage() { Reset(); }
+
+    /**
+     * Return the buffer to the pool now, leaving the handle empty
+     */
+    void Reset() {
+        if (message != nullptr) {
+            message->~T();
+            k_mem_slab_free(slab, message);
+            message = nullptr;
+        }
+    }
+
+    /**
+     * Get the message
+     * @return the message, or nullptr if the handle is empty
+     */
+    T *Get() const { return message; }
+
+    T &operator*() const { return *message; }
+    T *operator->() const { return message; }
+
+    /**
+     * Check if the handle holds a buffer
+     */
+    explicit operator bool() const { return message != nullptr; }
+
+  private:
+    friend class CPooledMessagePortBase<T>;
+
+    k_mem_slab *slab = nullptr;
+    T *message = nullptr;
+
+    CPooledMessage(k_mem_slab *slab, T *message) : slab(slab), message(message) {}
+
+    /**
+     * Give up ownership of the buffer without freeing it
+     */
+    T *detach() {
+        T *detached = message;
+        message = nullptr;
+        return detached;
+    }
+};
+
+/**
+ * Message port for large messages. Messages live in buffers from a k_mem_slab and only pointers to them are queued, so
+ * a message is built in place, passed on and used in place without ever being copied.
+ *
+ * Allocate() a buffer, fill it in and Send() it. Receive() hands the receiver the buffer, which goes back to the pool
+ * when its handle goes away. The plain CMessagePort Send()/Receive() copy in and out of a buffer, so the port still
+ * works with code that only knows CMessagePort.
+ *
+ * Since every queued message holds a buffer, the queue is as long as the pool and only running out of buffers stops a
+ * send.
+ * @tparam T the message type
+ */
+template <typename T>
+class CPooledMessagePortBase : public CMessagePort<T> {
+  public:
+    static_assert(std::is_trivially_copyable_v<T>, "Messages must be trivially copyable");
+
+    /**
+     * Take a buffer from the pool
+     * @param timeout Time to wait for a buffer to be returned if there are none
+     * @return handle to a value initialized message, empty if no buffer was free in time
+     */
+    CPooledMessage<T> Allocate(const k_timeout_t timeout = K_NO_WAIT) {
+        void *block = nullptr;
+        if (k_mem_slab_alloc(&slab, &block, timeout) != 0) {
+            return {};
+        }
+        return CPooledMessage<T>(&slab, new (block) T{});
+    }
+
+    /**
+     * Queue a message from Allocate(). On success the receiver owns the buffer and the handle is left empty
+     * @param message Message to send
+     * @param timeout Unused, since the queue has room for every buffer
+     * @return 0 on success, -EINVAL for an empty handle or one from another port
+     */
+    int Send(CPooledMessage<T> &&message, const k_timeout_t timeout = K_NO_WAIT) {
+        if (!message || message.slab != &slab) {
+            return -EINVAL;
+        }
+        T *pointer = message.Get();
+        int ret = k_msgq_put(&queue, &pointer, K_NO_WAIT);
+        if (ret == 0) {
+            message.detach();
+        }
+        return ret;
+    }
+
+    /**
+     * Take the next message, along with ownership of its buffer
+     * @param message Handle to receive into. Anything it held goes back to the pool
+     * @param timeout Time to wait for a message
+     * @return 0 on success, -ENOMSG if empty and not waiting, -EAGAIN if the wait timed out
+     */
+    int Receive(CPooledMessage<T> &message, const k_timeout_t timeout = K_NO_WAIT) {
+        T *pointer = nullptr;
+        int ret = k_msgq_get(&queue, &pointer, timeout);
+        if (ret == 0) {
+            message = CPooledMessage<T>(&slab, pointer);
+        }
+        return ret;
+    }
+
+    /**
+     * Copy a message into a buffer and queue it
+     * @param message Message to send
+     * @param timeout Time to wait for a free buffer
+     * @return 0 on success, -ENOMEM if no buffer was free in time
+     */
+    int Send(const T &message, const k_timeout_t timeout = K_NO_WAIT) override {
+        CPooledMessage<T> pooled = Allocate(timeout);
+        if (!pooled) {
+            return -ENOMEM;
+        }
+        *pooled = message;
+        return Send(std::move(pooled));
+    }
+
+    /**
+     * Take the next message, copy it out and return its buffer to the pool
+     * @param message Message to receive
+     * @param timeout Time to wait for a message
+     * @return 0 on success, -ENOMSG if empty and not waiting, -EAGAIN if the wait timed out
+     */
+    int Receive(T &message, const k_timeout_t timeout = K_NO_WAIT) override {
+        CPooledMessage<T> pooled;
+        int ret = Receive(pooled, timeout);
+        if (ret == 0) {
+            message = *pooled;
+        }
+        return ret;
+    }
+
+    /**
+     * Drop every queued message, returning their buffers to the pool
+     */
+    void Clear() override {
+        CPooledMessage<T> pooled;
+        while (Receive(pooled) == 0) {
+            pooled.Reset();
+        }
+    }
+
+#ifdef CONFIG_POLL
+    /**
+     * See parent docs
+     */
+    bool InitPollEvent(k_poll_event &event) override {
+        k_poll_event_init(&event, K_POLL_TYPE_MSGQ_DATA_AVAILABLE, K_POLL_MODE_NOTIFY_ONLY, &queue);
+        return true;
+    }
+#endif
+
+    /**
+     * Get the number of messages waiting
+     * @return queued messages
+     */
+    uint32_t Count() { return k_msgq_num_used_get(&queue); }
+
+    /**
+     * Get the number of buffers left to allocate
+     * @return free buffers
+     */
+    uint32_t GetFreeBuffers() { return k_mem_slab_num_free_get(&slab); }
+
+  protected:
+    CPooledMessagePortBase(void *buffers, std::size_t blockSize, T **queueBuffer, std::size_t poolSize) {
+        k_mem_slab_init(&slab, buffers, blockSize, poolSize);
+        k_msgq_init(&queue, reinterpret_cast<char *>(queueBuffer), sizeof(T *), poolSize);
+    }
+
+    ~CPooledMessagePortBase() override {
+        Clear();
+        k_msgq_cleanup(&queue);
+    }
+
+  private:
+    k_mem_slab slab;
+    k_msgq queue;
+};
+
+/**
+ * A pooled message port with its own buffers. See CPooledMessagePortBase
+ * @tparam T the message type
+ * @tparam PoolSize number of message buffers, i.e. messages queued or held by a handle at once
+ */
+template <typename T, std::size_t PoolSize>
+class CPooledMessagePort : public CPooledMessagePortBase<T> {
+  public:
+    static_assert(PoolSize > 0, "Pool must have at least one buffer");
+
+    CPooledMessagePort() : CPooledMessagePortBase<T>(buffers.data(), blockSize, queueBuffer.data(), PoolSize) {}
+
+  private:
+    // Slab blocks have to be a multiple of the word size, and aligned for T
+    static constexpr std::size_t blockAlignment = MAX(alignof(T), sizeof(void *));
+    static constexpr std::size_t blockSize = ROUND_UP(sizeof(T), blockAlignment);
+
+    // Not initialized here, since the base constructor has already threaded the slab's free list through it
+    alignas(blockAlignment) std::array<uint8_t, blockSize * PoolSize> buffers;
+    std::array<T *, PoolSize> queueBuffer;
+};
+
+#endif // C_POOLED_MESSAGE_PORT_H
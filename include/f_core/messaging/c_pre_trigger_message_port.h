@@ -0,0 +1,144 @@
+#ifndef C_PRE_TRIGGER_MESSAGE_PORT_H
+#define C_PRE_TRIGGER_MESSAGE_PORT_H
+
+#include <f_core/messaging/c_message_port.h>
+#include <f_core/utils/circular_buffer.hpp>
+#include <zephyr/kernel.h>
+
+/**
+ * Holds messages in RAM until a flight event happens, then hands them on to another port.
+ *
+ * Until the trigger event, every message goes into a ring of the last Length messages and nothing reaches the
+ * downstream port, so a datalogger behind it does no filesystem work on the pad. Once the phase controller reports the
+ * event, the ring is drained oldest first ahead of any new messages, then messages stream straight through.
+ *
+ * The drain only hands over what the downstream port will take without blocking, and picks up where it left off on
+ * the next Send(), so sending never stalls at the moment of the trigger. New messages queue up behind the backlog until
+ * it is gone, so order is preserved. Offers the downstream port refuses while draining are retried, not dropped; a
+ * message is only lost if the backlog is still full when another one arrives (see GetDropped()).
+ *
+ * Meant for a single producer (e.g. the sensing tenant).
+ * @tparam T the message type
+ * @tparam Length number of messages to keep from before the trigger
+ * @tparam PhaseController the CPhaseController type reporting the trigger event
+ */
+template <typename T, std::size_t Length, typename PhaseController>
+class CPreTriggerMessagePort : public CMessagePort<T> {
+  public:
+    using EventID = typename PhaseController::EventType;
+
+    /**
+     * Constructor
+     * @param downstream Port messages are handed on to once triggered
+     * @param controller Phase controller to watch
+     * @param triggerEvent Event to start passing messages on at (e.g. Boost)
+     */
+    CPreTriggerMessagePort(CMessagePort<T> &downstream, PhaseController &controller, EventID triggerEvent)
+        : downstream(downstream), controller(controller), triggerEvent(triggerEvent), ring(T{}), ringSentMs(0) {}
+
+    /**
+     * Hold on to the message until triggered, or pass it on once triggered
+     * @param message Message to send
+     * @param timeout Time to wait on the downstream port. Only used once the backlog has been drained
+     * @return 0 on success, -ENOMSG if the oldest held message had to be dropped
+     */
+    int Send(const T &message, const k_timeout_t timeout = K_NO_WAIT) override {
+        if (!triggered) {
+            triggered = controller.HasEventOccured(triggerEvent);
+        }
+        if (!triggered) {
+            hold(message);
+            return 0;
+        }
+
+        drainBacklog();
+        if (held == 0) {
+            return downstream.Send(message, timeout);
+        }
+
+        // Still catching up. Keep this one behind the rest so it is written in order
+        if (hold(message)) {
+            dropped++;
+            return -ENOMSG;
+        }
+        return 0;
+    }
+
+    /**
+     * See parent docs
+     */
+    int Receive(T &message, const k_timeout_t timeout = K_NO_WAIT) override {
+        return downstream.Receive(message, timeout);
+    }
+
+    /**
+     * Drop any held messages and clear the downstream port
+     */
+    void Clear() override {
+        held = 0;
+        downstream.Clear();
+    }
+
+#ifdef CONFIG_POLL
+    /**
+     * See parent docs
+     */
+    bool InitPollEvent(k_poll_event &event) override { return downstream.InitPollEvent(event); }
+#endif
+
+    /**
+     * Get the number of held messages overwritten after the trigger because the downstream port fell too far behind.
+     * Overwriting old messages before the trigger is the point of the ring, so those aren't counted
+     * @return Messages dropped since construction
+     */
+    uint32_t GetDropped() const override { return dropped; }
+
+    /**
+     * Get the number of messages waiting in RAM
+     * @return messages held from before the trigger (or not yet drained)
+     */
+    std::size_t HeldCount() const { return held; }
+
+    /**
+     * Check if the trigger event has been seen
+     * @return true once messages are being passed on
+     */
+    bool IsTriggered() const { return triggered; }
+
+  private:
+    CMessagePort<T> &downstream;
+    PhaseController &controller;
+    const EventID triggerEvent;
+
+    CCircularBuffer<T, Length> ring;
+    CCircularBuffer<uint32_t, Length> ringSentMs; //< uptime each message in the ring was sent at, passed on with it
+    std::size_t held = 0; //< newest messages in the ring that have not been passed on
+    uint32_t dropped = 0;
+    bool triggered = false;
+
+    /**
+     * Add a message to the ring
+     * @return true if the oldest held message was overwritten
+     */
+    bool hold(const T &message) {
+        ring.AddSample(message);
+        ringSentMs.AddSample(k_uptime_get_32());
+        if (held < Length) {
+            held++;
+            return false;
+        }
+        return true;
+    }
+
+    void drainBacklog() {
+        while (held > 0) {
+            // Index 0 of the ring is its oldest slot, so the oldest held message sits at Length - held
+            if (downstream.TrySend(ring[Length - held], ringSentMs[Length - held]) != 0) {
+                return;
+            }
+            held--;
+        }
+    }
+};
+
+#endif // C_PRE_TRIGGER_MESSAGE_PORT_H
@@ -0,0 +1,296 @@
+#ifndef C_SPSC_MESSAGE_PORT_H
+#define C_SPSC_MESSAGE_PORT_H
+
+#include <f_core/messaging/c_message_port.h>
+
+#include <algorithm>
+#include <array>
+#include <type_traits>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+
+/**
+ * Message port over a wait-free ring buffer, for links with exactly one sending thread (or ISR) and one receiving
+ * thread.
+ *
+ * Sending and receiving without a timeout never take a lock or enter the kernel. Each side only writes its own index,
+ * so all it takes is a load of the other side's index and a store of its own. A side only calls into the kernel
+ * (k_sem_give) when the other side is blocked waiting on it, or to raise the poll signal if one was set.
+ *
+ * TryReserve()/Commit() let the producer build a message in place, and TryPeek()/Release() let the consumer use it in
+ * place, so a message can go through without being copied at all.
+ *
+ * Clear() must be called from the receiving side.
+ * @tparam T the message type
+ * @tparam N capacity in messages. Must be a power of two
+ */
+template <typename T, std::size_t N>
+class CSpscMessagePort : public CMessagePort<T> {
+  public:
+    static_assert(N > 0 && (N & (N - 1)) == 0, "Capacity must be a power of two");
+    static_assert(N <= UINT32_MAX / 2, "Capacity must fit the ring indices");
+    static_assert(std::is_trivially_copyable_v<T>, "Messages must be trivially copyable");
+
+    /**
+     * Constructor
+     */
+    CSpscMessagePort() {
+        k_sem_init(&dataAvailable, 0, 1);
+        k_sem_init(&spaceAvailable, 0, 1);
+    }
+
+    /**
+     * Send a message
+     * @param message Message to send
+     * @param timeout Time to wait for space if the ring is full. Never wait from an ISR
+     * @return 0 on success, -ENOMSG if full and not waiting, -EAGAIN if the wait timed out
+     */
+    int Send(const T &message, const k_timeout_t timeout = K_NO_WAIT) override {
+        T *slot = TryReserve();
+        if (slot == nullptr) {
+            int ret = waitFor(spaceAvailable, producerWaiting, timeout, [this]() { return TryReserve(); }, slot);
+            if (ret < 0) {
+                return ret;
+            }
+        }
+        *slot = message;
+        Commit();
+        return 0;
+    }
+
+    /**
+     * Receive a message
+     * @param message Message to receive
+     * @param timeout Time to wait for a message if the ring is empty
+     * @return 0 on success, -ENOMSG if empty and not waiting, -EAGAIN if the wait timed out
+     */
+    int Receive(T &message, const k_timeout_t timeout = K_NO_WAIT) override {
+        const T *slot = peekOrReset();
+        if (slot == nullptr) {
+            int ret = waitFor(dataAvailable, consumerWaiting, timeout, [this]() { return TryPeek(); }, slot);
+            if (ret < 0) {
+                return ret;
+            }
+        }
+        message = *slot;
+        Release();
+        return 0;
+    }
+
+    /**
+     * Send several messages with one update of the ring's write index per run of free slots
+     * @param messages Messages to send
+     * @param timeout Time to wait for space for all of them. Never wait from an ISR
+     * @return Number of messages sent, or -ENOMSG/-EAGAIN if none were
+     */
+    int SendMany(std::span<const T> messages, const k_timeout_t timeout = K_NO_WAIT) override {
+        const k_timepoint_t end = sys_timepoint_calc(timeout);
+        std::size_t sent = 0;
+        int ret = 0;
+        while (sent < messages.size()) {
+            const std::size_t space = N - Count();
+            if (space == 0) {
+                T *slot = nullptr;
+                ret = waitFor(spaceAvailable, producerWaiting, sys_timepoint_timeout(end),
+                              [this]() { return TryReserve(); }, slot);
+                if (ret < 0) {
+                    break;
+                }
+                continue;
+            }
+
+            const std::size_t count = std::min(space, messages.size() - sent);
+            const uint32_t writeIndex = atomic_get(&head);
+            for (std::size_t i = 0; i < count; i++) {
+                ring[(writeIndex + i) & mask] = messages[sent + i];
+            }
+            atomic_add(&head, count);
+            published();
+            sent += count;
+        }
+        return sent > 0 ? static_cast<int>(sent) : ret;
+    }
+
+    /**
+     * Receive every waiting message that fits, with one update of the ring's read index
+     * @param messages Buffer to receive messages into
+     * @param timeout Time to wait for the first message
+     * @return Number of messages received, or -ENOMSG/-EAGAIN if none were
+     */
+    int ReceiveMany(std::span<T> messages, const k_timeout_t timeout = K_NO_WAIT) override {
+        if (messages.empty()) {
+            return 0;
+        }
+
+        if (peekOrReset() == nullptr) {
+            const T *slot = nullptr;
+            int ret = waitFor(dataAvailable, consumerWaiting, timeout, [this]() { return TryPeek(); }, slot);
+            if (ret < 0) {
+                return ret;
+            }
+        }
+
+        const std::size_t count = std::min(Count(), messages.size());
+        const uint32_t readIndex = atomic_get(&tail);
+        for (std::size_t i = 0; i < count; i++) {
+            messages[i] = ring[(readIndex + i) & mask];
+        }
+        atomic_add(&tail, count);
+        wake(spaceAvailable, producerWaiting);
+        return count;
+    }
+
+    /**
+     * Drop every message waiting in the ring. Receiving side only
+     */
+    void Clear() override {
+        atomic_set(&tail, atomic_get(&head));
+        wake(spaceAvailable, producerWaiting);
+    }
+
+    /**
+     * Get the slot the next message can be built in. Producer only
+     * @return the slot, or nullptr if the ring is full. Stays valid until Commit()
+     */
+    T *TryReserve() {
+        const uint32_t writeIndex = atomic_get(&head);
+        if (writeIndex - static_cast<uint32_t>(atomic_get(&tail)) == N) {
+            return nullptr;
+        }
+        return &ring[writeIndex & mask];
+    }
+
+    /**
+     * Publish the message built in the slot from TryReserve(). Producer only
+     */
+    void Commit() {
+        atomic_inc(&head);
+        published();
+    }
+
+    /**
+     * Get the oldest message without taking it off the ring. Consumer only
+     * @return the message, or nullptr if the ring is empty. Stays valid until Release()
+     */
+    const T *TryPeek() const {
+        const uint32_t readIndex = atomic_get(&tail);
+        if (static_cast<uint32_t>(atomic_get(&head)) == readIndex) {
+            return nullptr;
+        }
+        return &ring[readIndex & mask];
+    }
+
+    /**
+     * Take the message from TryPeek() off the ring. Consumer only
+     */
+    void Release() {
+        atomic_inc(&tail);
+        wake(spaceAvailable, producerWaiting);
+    }
+
+    /**
+     * Raise a poll signal on every message sent, so the receiver can wait on this port with k_poll alongside other
+     * objects. The port resets the signal when a receive finds it empty
+     * Needs CONFIG_POLL
+     * @param signal the signal to raise, or nullptr to stop
+     */
+#ifdef CONFIG_POLL
+    void SetPollSignal(k_poll_signal *signal) { pollSignal = signal; }
+
+    /**
+     * See parent docs. Raises a signal of the port's own on every message sent, replacing any from SetPollSignal()
+     */
+    bool InitPollEvent(k_poll_event &event) override {
+        k_poll_signal_init(&ownSignal);
+        SetPollSignal(&ownSignal);
+        k_poll_event_init(&event, K_POLL_TYPE_SIGNAL, K_POLL_MODE_NOTIFY_ONLY, &ownSignal);
+        return true;
+    }
+#endif
+
+    /**
+     * Get the number of messages waiting in the ring
+     * @return messages sent but not yet received
+     */
+    std::size_t Count() const {
+        return static_cast<uint32_t>(atomic_get(&head)) - static_cast<uint32_t>(atomic_get(&tail));
+    }
+
+  private:
+    static constexpr uint32_t mask = N - 1;
+
+    std::array<T, N> ring;
+    // Free running. Only the producer writes head and only the consumer writes tail
+    atomic_t head = ATOMIC_INIT(0);
+    atomic_t tail = ATOMIC_INIT(0);
+
+    // Set by a side before it blocks, so the other side only gives the semaphore when someone is waiting on it
+    atomic_t producerWaiting = ATOMIC_INIT(0);
+    atomic_t consumerWaiting = ATOMIC_INIT(0);
+    k_sem dataAvailable;
+    k_sem spaceAvailable;
+#ifdef CONFIG_POLL
+    k_poll_signal *pollSignal = nullptr;
+    k_poll_signal ownSignal;
+#endif
+
+    /**
+     * Let the consumer know about new messages
+     */
+    void published() {
+        wake(dataAvailable, consumerWaiting);
+#ifdef CONFIG_POLL
+        if (pollSignal != nullptr) {
+            k_poll_signal_raise(pollSignal, 0);
+        }
+#endif
+    }
+
+    /**
+     * TryPeek(), but if the ring is empty also reset the poll signal so a poller sleeps until the next message. Looks
+     * again after the reset in case a message was published in between
+     */
+    const T *peekOrReset() {
+        const T *slot = TryPeek();
+#ifdef CONFIG_POLL
+        if (slot == nullptr && pollSignal != nullptr) {
+            k_poll_signal_reset(pollSignal);
+            slot = TryPeek();
+        }
+#endif
+        return slot;
+    }
+
+    static void wake(k_sem &sem, atomic_t &waiting) {
+        if (atomic_get(&waiting) != 0) {
+            k_sem_give(&sem);
+        }
+    }
+
+    /**
+     * Block until tryGet() returns a slot or the timeout runs out
+     */
+    template <typename Slot, typename TryGet>
+    static int waitFor(k_sem &sem, atomic_t &waiting, const k_timeout_t timeout, TryGet tryGet, Slot *&slot) {
+        if (K_TIMEOUT_EQ(timeout, K_NO_WAIT)) {
+            return -ENOMSG;
+        }
+
+        const k_timepoint_t end = sys_timepoint_calc(timeout);
+        int ret = 0;
+        while (ret == 0) {
+            // Flag before checking again, so a message or space arriving in between still gives the semaphore
+            k_sem_reset(&sem);
+            atomic_set(&waiting, 1);
+            slot = tryGet();
+            if (slot != nullptr) {
+                break;
+            }
+            ret = k_sem_take(&sem, sys_timepoint_timeout(end));
+        }
+        atomic_clear(&waiting);
+        return ret == 0 ? 0 : -EAGAIN;
+    }
+};
+
+#endif // C_SPSC_MESSAGE_PORT_H
@@ -0,0 +1,500 @@
+#ifndef C_TOPIC_H
+#define C_TOPIC_H
+
+#include <f_core/messaging/c_message_port.h>
+#include <f_core/messaging/c_message_port_stats.h>
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+
+/**
+ * What a subscriber does with a new message when its queue is full
+ */
+enum class TopicOverflow {
+    DropOldest, //< Make room by dropping the oldest queued message. Publishing never waits
+    DropNewest, //< Drop the new message. Publishing never waits
+    Block,      //< Wait up to the publisher's timeout for room, then drop the new message
+};
+
+template <typename T>
+class CTopicBase;
+
+/**
+ * Something that gets every message published to a topic
+ */
+template <typename T>
+class CTopicSubscription {
+  public:
+    virtual ~CTopicSubscription() = default;
+
+    /**
+     * Stop getting messages until Resume(). Safe to call from any thread
+     */
+    void Pause() { atomic_set(&paused, 1); }
+
+    /**
+     * Get messages again after Pause(). Safe to call from any thread
+     */
+    void Resume() { atomic_clear(&paused); }
+
+    /**
+     * Check if the subscription is paused
+     * @return true if messages are being skipped
+     */
+    bool IsPaused() const { return atomic_get(&paused) != 0; }
+
+    /**
+     * Get the number of messages this subscriber has lost to overflow
+     * @return messages dropped since construction
+     */
+    uint32_t GetDropped() const { return atomic_get(&dropped); }
+
+  protected:
+    friend class CTopicBase<T>;
+
+    /**
+     * Hand a published message to the subscriber
+     * @param slot the pool slot holding the message. A reference to it was taken for the subscriber, which must
+     * release it once done with the message, unless this fails
+     * @param timeout publisher's timeout
+     * @return 0 if the subscriber took the message, negative errno code if not
+     */
+    virtual int deliver(uint8_t slot, const k_timeout_t timeout) = 0;
+
+    /**
+     * Drop the oldest queued message, if the overflow policy allows it, to free up a pool slot
+     * @return true if a message was dropped
+     */
+    virtual bool reclaim() { return false; }
+
+    /**
+     * Drop every queued message
+     */
+    virtual void clear() {}
+
+    atomic_t paused = ATOMIC_INIT(0);
+    atomic_t dropped = ATOMIC_INIT(0);
+};
+
+/**
+ * Publish/subscribe channel. Messages are copied once into a reference counted pool slot, and every subscriber gets
+ * the index of that slot rather than its own copy, so adding a subscriber costs no extra copy of the payload.
+ *
+ * Publishing (Send) hands the message to each subscriber in the order they subscribed. Each subscriber applies its own
+ * overflow policy, so a slow subscriber only loses its own messages (or, with TopicOverflow::Block, holds up the
+ * publisher). A slot is reused once every subscriber is done with it.
+ *
+ * If the pool runs out, subscribers that drop their oldest messages are asked to give slots back first. Sizing the pool
+ * to the sum of the subscriber queue lengths plus one per publisher means that never happens.
+ *
+ * Subscribe before anything is published. Any number of threads may publish.
+ * @tparam T the message type
+ */
+template <typename T>
+class CTopicBase : public CMessagePort<T> {
+  public:
+    static_assert(std::is_trivially_copyable_v<T>, "Messages must be trivially copyable");
+
+    /**
+     * Add a subscriber
+     * @param subscription the subscriber
+     * @return 0 on success, -ENOSPC if the topic has no room for more subscribers
+     */
+    int Subscribe(CTopicSubscription<T> &subscription) {
+        for (auto &subscriber : subscribers) {
+            if (subscriber == nullptr) {
+                subscriber = &subscription;
+                return 0;
+            }
+        }
+        return -ENOSPC;
+    }
+
+    /**
+     * Remove a subscriber. Its queued messages are dropped
+     * @param subscription the subscriber
+     */
+    void Unsubscribe(CTopicSubscription<T> &subscription) {
+        for (auto &subscriber : subscribers) {
+            if (subscriber == &subscription) {
+                subscriber = nullptr;
+                subscription.clear();
+            }
+        }
+    }
+
+    /**
+     * Publish a message to every subscriber
+     * @param message Message to send
+     * @param timeout Time to wait on subscribers with TopicOverflow::Block
+     * @return 0 if every subscriber took the message, -ENOMEM if there was no free slot, or the error of the last
+     * subscriber that didn't take it
+     */
+    int Send(const T &message, const k_timeout_t timeout = K_NO_WAIT) override {
+        int slot = allocate();
+        for (std::size_t i = 0; slot < 0 && i < subscribers.size(); i++) {
+            if (subscribers[i] != nullptr && subscribers[i]->reclaim()) {
+                slot = allocate();
+            }
+        }
+        if (slot < 0) {
+            atomic_inc(&failedPublishes);
+            return -ENOMEM;
+        }
+
+        pool[slot] = message;
+        publishedCycles[slot] = k_cycle_get_32();
+
+        int ret = 0;
+        for (CTopicSubscription<T> *subscriber : subscribers) {
+            if (subscriber == nullptr || subscriber->IsPaused()) {
+                continue;
+            }
+            atomic_inc(&references[slot]);
+            int err = subscriber->deliver(slot, timeout);
+            if (err < 0) {
+                Release(slot);
+                ret = err;
+            }
+        }
+
+        // The publisher's own reference
+        Release(slot);
+        return ret;
+    }
+
+    /**
+     * Topics are only published to. Receive through a subscriber
+     * @return -ENOTSUP
+     */
+    int Receive(T &message, const k_timeout_t timeout = K_NO_WAIT) override { return -ENOTSUP; }
+
+    /**
+     * Drop every message queued for every subscriber
+     */
+    void Clear() override {
+        for (CTopicSubscription<T> *subscriber : subscribers) {
+            if (subscriber != nullptr) {
+                subscriber->clear();
+            }
+        }
+    }
+
+    /**
+     * Get a message in the pool. For subscribers
+     * @param slot the slot the subscriber was given
+     * @return the message
+     */
+    const T &Get(uint8_t slot) const { return pool[slot]; }
+
+    /**
+     * Get when the message in a slot was published. For subscribers
+     * @param slot the slot the subscriber was given
+     * @return k_cycle_get_32() at publishing
+     */
+    uint32_t GetPublishedCycles(uint8_t slot) const { return publishedCycles[slot]; }
+
+    /**
+     * Give up a subscriber's reference to a slot. For subscribers
+     * @param slot the slot the subscriber was given
+     */
+    void Release(uint8_t slot) { atomic_dec(&references[slot]); }
+
+    /**
+     * Get the number of messages that could not be published because the pool was full
+     * @return failed publishes since construction
+     */
+    uint32_t GetFailedPublishes() const { return atomic_get(&failedPublishes); }
+
+  protected:
+    CTopicBase(T *pool, atomic_t *references, uint32_t *publishedCycles, std::size_t poolSize,
+               CTopicSubscription<T> **subscribers, std::size_t maxSubscribers)
+        : pool(pool), references(references), publishedCycles(publishedCycles), poolSize(poolSize),
+          subscribers(subscribers, maxSubscribers) {}
+
+  private:
+    /// Array of subscriber pointers owned by the derived class
+    struct SubscriberList {
+        CTopicSubscription<T> **list;
+        std::size_t count;
+
+        CTopicSubscription<T> **begin() const { return list; }
+        CTopicSubscription<T> **end() const { return list + count; }
+        std::size_t size() const { return count; }
+        CTopicSubscription<T> *&operator[](std::size_t i) const { return list[i]; }
+    };
+
+    T *pool;
+    atomic_t *references; //< 0 for a free slot
+    uint32_t *publishedCycles;
+    std::size_t poolSize;
+    SubscriberList subscribers;
+    atomic_t failedPublishes = ATOMIC_INIT(0);
+
+    /**
+     * Claim a free slot, holding the publisher's reference to it
+     * @return the slot, or -1 if none are free
+     */
+    int allocate() {
+        for (std::size_t i = 0; i < poolSize; i++) {
+            if (atomic_cas(&references[i], 0, 1)) {
+                return i;
+            }
+        }
+        return -1;
+    }
+};
+
+/**
+ * A topic with its own pool. See CTopicBase
+ * @tparam T the message type
+ * @tparam PoolSize number of messages in flight at once (queued for a subscriber or being published)
+ * @tparam MaxSubscribers most subscribers the topic can have
+ */
+template <typename T, std::size_t PoolSize, std::size_t MaxSubscribers = 4>
+class CTopic : public CTopicBase<T> {
+  public:
+    static_assert(PoolSize > 0 && PoolSize <= UINT8_MAX + 1, "Slots are handed out as 8 bit indices");
+
+    CTopic()
+        : CTopicBase<T>(pool.data(), references.data(), publishedCycles.data(), PoolSize, subscribers.data(),
+                        MaxSubscribers) {}
+
+  private:
+    std::array<T, PoolSize> pool{};
+    std::array<atomic_t, PoolSize> references{};
+    std::array<uint32_t, PoolSize> publishedCycles{};
+    std::array<CTopicSubscription<T> *, MaxSubscribers> subscribers{};
+};
+
+/**
+ * Queue of a topic's messages for one receiver, which reads them like any other message port
+ *
+ * Only slot indices are queued. Receive() copies the message out of the topic's pool. Peek()/Done() read it in place.
+ * Given a name, the subscriber reports its CMessagePortStats, with the latency measured from publishing.
+ * @tparam T the message type
+ * @tparam Length the most messages that can be queued
+ */
+template <typename T, std::size_t Length>
+class CTopicSubscriber : public CMessagePort<T>, public CTopicSubscription<T> {
+  public:
+    /**
+     * Constructor. Subscribes to the topic
+     * @param topic Topic to subscribe to
+     * @param overflow What to do with new messages when the queue is full
+     * @param name Name to report the subscriber's stats under, or nullptr to not report them
+     */
+    explicit CTopicSubscriber(CTopicBase<T> &topic, TopicOverflow overflow = TopicOverflow::DropOldest,
+                              const char *name = nullptr)
+        : topic(topic), overflow(overflow), stats(name) {
+        k_msgq_init(&queue, reinterpret_cast<char *>(slots.data()), sizeof(uint8_t), Length);
+        if (topic.Subscribe(*this) < 0) {
+            // Not enough subscriber slots for this topic
+            k_oops();
+        }
+    }
+
+    /**
+     * Destructor. Unsubscribes from the topic
+     */
+    ~CTopicSubscriber() override {
+        topic.Unsubscribe(*this);
+        k_msgq_cleanup(&queue);
+    }
+
+    /**
+     * Publish to the topic. See CTopicBase::Send()
+     */
+    int Send(const T &message, const k_timeout_t timeout = K_NO_WAIT) override { return topic.Send(message, timeout); }
+
+    /**
+     * See parent docs
+     */
+    int Receive(T &message, const k_timeout_t timeout = K_NO_WAIT) override {
+        uint8_t slot = 0;
+        int ret = k_msgq_get(&queue, &slot, timeout);
+        if (ret < 0) {
+            return ret;
+        }
+        message = topic.Get(slot);
+        received(slot);
+        topic.Release(slot);
+        return 0;
+    }
+
+    /**
+     * See parent docs. Messages are stamped with when they were published
+     */
+    int ReceiveManyStamped(std::span<T> messages, std::span<uint32_t> sentMs,
+                           const k_timeout_t timeout = K_NO_WAIT) override {
+        std::size_t count = 0;
+        int ret = 0;
+        while (count < messages.size()) {
+            uint8_t slot = 0;
+            ret = k_msgq_get(&queue, &slot, count == 0 ? timeout : K_NO_WAIT);
+            if (ret < 0) {
+                break;
+            }
+            messages[count] = topic.Get(slot);
+            sentMs[count] = publishedUptimeMs(slot);
+            received(slot);
+            topic.Release(slot);
+            count++;
+        }
+        return count > 0 ? static_cast<int>(count) : ret;
+    }
+
+    /**
+     * See parent docs
+     */
+    uint32_t GetDropped() const override { return CTopicSubscription<T>::GetDropped(); }
+
+    /**
+     * Get the next message without copying it. It stays valid until Done() is called
+     * @param timeout Time to wait for a message
+     * @return the message, or nullptr if there was none in time
+     */
+    const T *Peek(const k_timeout_t timeout = K_NO_WAIT) {
+        if (k_msgq_get(&queue, &peeked, timeout) < 0) {
+            return nullptr;
+        }
+        received(peeked);
+        return &topic.Get(peeked);
+    }
+
+    /**
+     * Finish with the message from Peek()
+     */
+    void Done() { topic.Release(peeked); }
+
+    /**
+     * See parent docs
+     */
+    void Clear() override { clear(); }
+
+#ifdef CONFIG_POLL
+    /**
+     * See parent docs
+     */
+    bool InitPollEvent(k_poll_event &event) override {
+        k_poll_event_init(&event, K_POLL_TYPE_MSGQ_DATA_AVAILABLE, K_POLL_MODE_NOTIFY_ONLY, &queue);
+        return true;
+    }
+#endif
+
+    /**
+     * Get the number of messages waiting
+     * @return queued messages
+     */
+    uint32_t Count() { return k_msgq_num_used_get(&queue); }
+
+    /**
+     * Get the subscriber's stats
+     * @return the stats
+     */
+    const CMessagePortStats &GetStats() const { return stats; }
+
+  protected:
+    int deliver(uint8_t slot, const k_timeout_t timeout) override {
+        int ret = k_msgq_put(&queue, &slot, overflow == TopicOverflow::Block ? timeout : K_NO_WAIT);
+        while (ret < 0 && overflow == TopicOverflow::DropOldest) {
+            reclaim();
+            ret = k_msgq_put(&queue, &slot, K_NO_WAIT);
+        }
+        if (ret < 0) {
+            atomic_inc(&this->dropped);
+            stats.RecordDrop();
+        } else {
+            stats.RecordSend();
+        }
+        return ret;
+    }
+
+    bool reclaim() override {
+        uint8_t oldest = 0;
+        if (overflow != TopicOverflow::DropOldest || k_msgq_get(&queue, &oldest, K_NO_WAIT) < 0) {
+            return false;
+        }
+        topic.Release(oldest);
+        atomic_inc(&this->dropped);
+        stats.RecordDrop(1, true);
+        return true;
+    }
+
+    void clear() override {
+        uint8_t slot = 0;
+        while (k_msgq_get(&queue, &slot, K_NO_WAIT) == 0) {
+            topic.Release(slot);
+        }
+        stats.RecordClear();
+    }
+
+  private:
+    CTopicBase<T> &topic;
+    const TopicOverflow overflow;
+    std::array<uint8_t, Length> slots;
+    k_msgq queue;
+    uint8_t peeked = 0;
+    CMessagePortStats stats;
+
+    void received(uint8_t slot) {
+        stats.RecordReceive();
+        stats.RecordLatency(topic.GetPublishedCycles(slot));
+    }
+
+    /**
+     * Convert when a slot was published to uptime. Going by the time since publishing keeps it right across cycle
+     * counter wraps
+     */
+    uint32_t publishedUptimeMs(uint8_t slot) const {
+        return k_uptime_get_32() - k_cyc_to_ms_floor32(k_cycle_get_32() - topic.GetPublishedCycles(slot));
+    }
+};
+
+/**
+ * Passes a topic's messages on to another message port, e.g. a datalogger tenant. The port's own queue does the
+ * buffering, so the message is copied into it
+ * @tparam T the message type
+ */
+template <typename T>
+class CTopicForwarder : public CTopicSubscription<T> {
+  public:
+    /**
+     * Constructor. Subscribes to the topic
+     * @param topic Topic to subscribe to
+     * @param port Port to send each message on to. Sent with the publisher's timeout
+     */
+    CTopicForwarder(CTopicBase<T> &topic, CMessagePort<T> &port) : topic(topic), port(port) {
+        if (topic.Subscribe(*this) < 0) {
+            // Not enough subscriber slots for this topic
+            k_oops();
+        }
+    }
+
+    /**
+     * Destructor. Unsubscribes from the topic
+     */
+    ~CTopicForwarder() override { topic.Unsubscribe(*this); }
+
+  protected:
+    int deliver(uint8_t slot, const k_timeout_t timeout) override {
+        int ret = port.Send(topic.Get(slot), timeout);
+        if (ret < 0) {
+            atomic_inc(&this->dropped);
+            return ret;
+        }
+        topic.Release(slot);
+        return 0;
+    }
+
+    void clear() override { port.Clear(); }
+
+  private:
+    CTopicBase<T> &topic;
+    CMessagePort<T> &port;
+};
+
+#endif // C_TOPIC_H
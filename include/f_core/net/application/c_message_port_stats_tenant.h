@@ -0,0 +1,46 @@
+#ifndef C_MESSAGE_PORT_STATS_TENANT_H
+#define C_MESSAGE_PORT_STATS_TENANT_H
+
+#include <f_core/net/network/c_ipv4.h>
+#include <f_core/net/transport/c_udp_socket.h>
+#include <f_core/os/c_tenant.h>
+#include <f_core/utils/c_soft_timer.h>
+
+/**
+ * Tenant that periodically broadcasts the stats of every named message port over UDP, one MessagePortStatsSnapshot
+ * datagram per port
+ */
+class CMessagePortStatsTenant : public CTenant {
+public:
+    /**
+     * Constructor
+     * @param name Name of the tenant
+     * @param ipAddr Source IP address to broadcast from
+     * @param port Port to broadcast from and to
+     * @param periodMs Time between broadcasts
+     */
+    CMessagePortStatsTenant(const char* name, const char* ipAddr, uint16_t port, uint32_t periodMs = 1000)
+        : CTenant(name), udp(CIPv4(ipAddr), port, port), periodMs(periodMs) {}
+
+    /**
+     * See parent docs
+     */
+    void Startup() override;
+
+    /**
+     * See parent docs
+     */
+    void AddWaitSources(CWaitSet& waitSet) override;
+
+    /**
+     * See parent docs
+     */
+    void Run() override;
+
+private:
+    CUdpSocket udp;
+    CSoftTimer timer;
+    const uint32_t periodMs;
+};
+
+#endif //C_MESSAGE_PORT_STATS_TENANT_H
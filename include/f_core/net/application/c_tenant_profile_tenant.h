@@ -0,0 +1,46 @@
+#ifndef C_TENANT_PROFILE_TENANT_H
+#define C_TENANT_PROFILE_TENANT_H
+
+#include <f_core/net/network/c_ipv4.h>
+#include <f_core/net/transport/c_udp_socket.h>
+#include <f_core/os/c_tenant.h>
+#include <f_core/utils/c_soft_timer.h>
+
+/**
+ * Tenant that periodically broadcasts how long every tenant of every task takes to run over UDP, one
+ * TenantProfileSnapshot datagram per tenant. Sends nothing unless CONFIG_F_CORE_TENANT_PROFILER is on
+ */
+class CTenantProfileTenant : public CTenant {
+public:
+    /**
+     * Constructor
+     * @param name Name of the tenant
+     * @param ipAddr Source IP address to broadcast from
+     * @param port Port to broadcast from and to
+     * @param periodMs Time between broadcasts
+     */
+    CTenantProfileTenant(const char* name, const char* ipAddr, uint16_t port, uint32_t periodMs = 1000)
+        : CTenant(name), udp(CIPv4(ipAddr), port, port), periodMs(periodMs) {}
+
+    /**
+     * See parent docs
+     */
+    void Startup() override;
+
+    /**
+     * See parent docs
+     */
+    void AddWaitSources(CWaitSet& waitSet) override;
+
+    /**
+     * See parent docs
+     */
+    void Run() override;
+
+private:
+    CUdpSocket udp;
+    CSoftTimer timer;
+    const uint32_t periodMs;
+};
+
+#endif //C_TENANT_PROFILE_TENANT_H
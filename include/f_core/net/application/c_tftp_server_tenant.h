@@ -30,6 +30,11 @@ public:
      */
     void Cleanup() override;
 
+    /**
+     * See parent docs
+     */
+    void AddWaitSources(CWaitSet &waitSet) override;
+
     /**
      * See parent docs
      */
@@ -104,6 +109,20 @@ private:
      */
     int waitForAck(CUdpSocket &dataSock, const sockaddr &srcAddr, uint16_t blockNum);
 
+    /**
+     * Non-standard TFTP extension for reading part of an indexed log. Requesting "<path>@<start ms>-<end ms>" serves
+     * only the part of the log sampled between those uptimes, found with the log's index (see CDataLogger). Logs whose
+     * packets weren't written with their sample times are indexed by write time instead, so the range is off by however
+     * long packets waited to be written (see CDataLogReader::SeekToTime). Either time can be left out to read from the
+     * start or to the end
+     * @param path Path of the log
+     * @param range Time range from the request, after the '@'
+     * @param[out] startOffset Offset to start serving from
+     * @param[in,out] endOffset Offset to stop serving at. Starts out as the file size
+     * @return 0 on success, negative error code on failure
+     */
+    int getTimeRange(const char *path, const char *range, off_t &startOffset, off_t &endOffset);
+
     /**
      * Non-standard TFTP function for generating a filesystem tree
      * @return 0 on success, negative error code on failure
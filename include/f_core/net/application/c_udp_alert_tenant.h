@@ -11,6 +11,11 @@ class CUdpAlertTenant : public CTenant {
 public:
     explicit CUdpAlertTenant(const char* name, const char* ipAddrStr, const uint16_t port) : CTenant(name), sock(CUdpSocket(CIPv4(ipAddrStr), port, port)) {};
 
+    /**
+     * See parent docs
+     */
+    void AddWaitSources(CWaitSet& waitSet) override;
+
     /**
      * See parent docs
      */
@@ -5,8 +5,17 @@
 #include <f_core/net/transport/c_udp_socket.h>
 #include <f_core/messaging/c_message_port.h>
 #include <f_core/os/c_tenant.h>
+#include <f_core/os/c_wait_set.h>
 
-template <typename T>
+#include <array>
+
+/**
+ * Tenant that broadcasts every message it receives over UDP, one datagram per message
+ * Each pass drains everything waiting on the message port (up to BatchSize messages) before sending
+ * @tparam T the message type
+ * @tparam BatchSize most messages taken off the message port at once
+ */
+template <typename T, std::size_t BatchSize = 4>
 class CUdpBroadcastTenant : public CTenant {
 public:
     /**
@@ -52,6 +61,16 @@ public:
         }
     }
 
+    /**
+     * Asynchronously transmit every message waiting on the message port (up to BatchSize) over UDP
+     */
+    void TransmitMessagesAsynchronous() {
+        int received = messagesToBroadcast->ReceiveMany(batch, K_NO_WAIT);
+        for (int i = 0; i < received; i++) {
+            udp.TransmitAsynchronous(&batch[i], sizeof(T));
+        }
+    }
+
     /**
      * See parent docs
      */
@@ -62,16 +81,24 @@ public:
      */
     void PostStartup() override {};
 
+    /**
+     * See parent docs
+     */
+    void AddWaitSources(CWaitSet &waitSet) override {
+        waitSet.AddMessagePort(*messagesToBroadcast);
+    }
+
     /**
      * See parent docs
      */
     void Run() override {
-        TransmitMessageAsynchronous();
+        TransmitMessagesAsynchronous();
     }
 
 private:
     CUdpSocket udp;
     CMessagePort<T> *messagesToBroadcast;
+    std::array<T, BatchSize> batch;
 };
 
 #endif //C_UDP_BROADCAST_TENANT_H
@@ -56,6 +56,14 @@ public:
         dstPort = port;
     }
 
+    /**
+     * Get the underlying socket descriptor, e.g. to wait on it with zsock_poll
+     * @return Socket descriptor, negative if the socket failed to open
+     */
+    int GetSocket() const {
+        return sock;
+    }
+
 private:
 // CONFIG_ARCH_POSIX uses loopback for broadcast
 #if defined(CONFIG_ARCH_POSIX) && defined(CONFIG_NET_NATIVE_OFFLOADED_SOCKETS)
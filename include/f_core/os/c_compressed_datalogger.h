@@ -0,0 +1,131 @@
+#ifndef C_COMPRESSED_DATALOGGER_H
+#define C_COMPRESSED_DATALOGGER_H
+
+#include <array>
+#include <f_core/os/c_datalogger.h>
+#include <n_autocoder_types.h>
+
+/**
+ * @brief A type-safe Growing datalogger that compresses each packet against the one before it
+ * Every primitive field of the autocoded type is encoded on its own, so slowly changing sensor data costs a few bits
+ * per field instead of its full width. The format is described in detail::compressed_datalogger. Every
+ * KeyframeInterval packets (and whenever a packet changes too much to delta encode) a raw keyframe is written, so a
+ * decoder can pick up from any keyframe if the start of the file is lost or a block is corrupted.
+ *
+ * Decode on the host with tools/data_log_check/compressed_log_decode.py, which reads the same type YAML files the
+ * autocoder does.
+ *
+ * Requires the packet type to come from the types autocoder (see NTypes::TypeInfo).
+ * @tparam T the packet type to log
+ * @tparam BlockSize size of the write-back staging buffer in bytes. 0 writes every encoded packet straight through
+ * @tparam KeyframeInterval number of packets between keyframes
+ */
+template <typename T, std::size_t BlockSize = 0, uint16_t KeyframeInterval = 100>
+class CCompressedDataLogger {
+  public:
+    using PacketType = T;
+    using Layout = NTypes::TypeInfo<T>;
+    static constexpr std::size_t NumFields = std::size(Layout::fields);
+    static_assert(KeyframeInterval > 0, "Need at least one keyframe to decode from");
+
+    /**
+     * Construct a compressed Datalogger for the specified filename
+     * @param filename the name of the file to write to
+     * @param flushIntervalMs the longest time staged data may go without being flushed. 0 only flushes full blocks (only used if BlockSize > 0)
+     * @param indexed keep a sparse time index next to the log (see CDataLogger)
+     */
+    CCompressedDataLogger(const char *filename, uint32_t flushIntervalMs = 0, bool indexed = false)
+        : internal(filename, fields.data(), NumFields, sizeof(PacketType), Layout::schemaHash, KeyframeInterval,
+                   previous.data(), states.data(), scratch.data(), BlockSize > 0 ? block.data() : nullptr, BlockSize,
+                   flushIntervalMs, indexed) {}
+
+    /**
+     * Write a packet to the file
+     * @param packet the data to write to the file
+     * @return sizeof(PacketType) on success, negative errno code on error
+     */
+    int write(const PacketType &packet) { return internal.write(&packet); }
+
+    /**
+     * Write a packet to the file that was sampled at a known time. The time only goes in the index (if any)
+     * @param packet the data to write to the file
+     * @param uptimeMs uptime the packet was sampled at
+     * @return sizeof(PacketType) on success, negative errno code on error
+     */
+    int write(const PacketType &packet, uint32_t uptimeMs) { return internal.write(&packet, uptimeMs); }
+
+    /**
+     * Write several contiguous packets to the file
+     * @param packets the packets to write
+     * @param count the number of packets to write
+     * @return number of uncompressed bytes written, or a negative errno code on error
+     */
+    int WriteMany(const PacketType *packets, std::size_t count) { return internal.write_many(packets, count); }
+
+    /**
+     * Write several contiguous packets to the file, each indexed by the uptime it was sampled at
+     * @param packets the packets to write
+     * @param uptimesMs uptime each packet was sampled at
+     * @param count the number of packets to write
+     * @return number of uncompressed bytes written, or a negative errno code on error
+     */
+    int WriteMany(const PacketType *packets, const uint32_t *uptimesMs, std::size_t count) {
+        return internal.write_many(packets, count, uptimesMs);
+    }
+
+    /**
+     * Write any staged data to the file and sync it to disk
+     * @return 0 on success, negative errno code on error
+     */
+    int Flush() { return internal.flush(); }
+
+    /**
+     * Get the time remaining before staged data is due to be flushed
+     * @return milliseconds until the next flush is due. 0 if overdue, -1 if nothing is waiting to be flushed
+     */
+    int64_t MsUntilFlush() const { return internal.ms_until_flush(); }
+
+    /**
+     * Get the number of bytes written to the file so far, to keep an eye on the compression ratio
+     * @return encoded bytes, including the file header
+     */
+    uint64_t GetBytesWritten() const { return internal.bytes_written; }
+
+    /**
+     * Close the file and flush to disk.
+     * Make sure to do this or some of your data may not be sent to the disk before power is cut/the chip is turned off
+     * @return 0 on success, negative errno code on error
+     */
+    int close() { return internal.close(); }
+
+  private:
+    static constexpr std::array<detail::field_desc, NumFields> fields = [] {
+        std::array<detail::field_desc, NumFields> descs{};
+        for (std::size_t i = 0; i < NumFields; i++) {
+            const NTypes::FieldInfo &info = Layout::fields[i];
+            descs[i].offset = info.offset;
+            descs[i].size = info.size;
+            switch (info.kind) {
+                case NTypes::FieldKind::Float:
+                    descs[i].kind = detail::field_desc::kind_t::Float;
+                    break;
+                case NTypes::FieldKind::Signed:
+                    descs[i].kind = detail::field_desc::kind_t::Signed;
+                    break;
+                case NTypes::FieldKind::Unsigned:
+                    descs[i].kind = detail::field_desc::kind_t::Unsigned;
+                    break;
+            }
+        }
+        return descs;
+    }();
+
+    // Declared before internal so they outlive every use by it
+    std::array<uint8_t, BlockSize> block;
+    std::array<uint8_t, sizeof(PacketType)> previous{};
+    std::array<detail::compressed_datalogger::field_state, NumFields> states{};
+    std::array<uint8_t, detail::compressed_datalogger::scratch_size(sizeof(PacketType))> scratch;
+    detail::compressed_datalogger internal;
+};
+
+#endif //C_COMPRESSED_DATALOGGER_H
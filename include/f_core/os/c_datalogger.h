@@ -1,36 +1,419 @@
 #ifndef C_DATALOGGER_H
 #define C_DATALOGGER_H
 
+#include <array>
 #include <cstdint>
 #include <type_traits>
 #include <zephyr/fs/fs.h>
+#include <zephyr/kernel.h>
 
 enum class LogMode { Growing, Circular, FixedSize };
 
 /// @brief Internal, type-unsafe datalogger. Don't use this directly. Use CDataLogger instead
 namespace detail {
+/**
+ * Header persisted at the start of Circular and FixedSize logs so a reopened log resumes where it left off.
+ * It is rewritten every time the file is synced. LittleFS only commits file contents on sync, so after a power loss
+ * the header and the data it describes always come back from the same commit.
+ */
+struct __attribute__((packed)) datalog_header {
+    static constexpr uint32_t MAGIC = 0x43474F4C; // "LOGC"
+    static constexpr uint16_t VERSION = 1;
+
+    uint32_t magic;
+    uint16_t version;
+    uint16_t packet_size;
+    uint32_t num_packets;
+    uint32_t cursor;     //< slot the next packet will be written to
+    uint32_t wraps;      //< times the cursor has wrapped back to slot 0
+    uint32_t generation; //< times the log has been opened
+    uint32_t crc;        //< crc32 of everything above
+};
+
+/**
+ * Entry in the sparse index kept next to an indexed Growing log (in <log filename>.idx)
+ * One entry is written for the first packet starting at or after every LOG_INDEX_INTERVAL bytes of the log, so the
+ * entries are sorted by both uptime and offset. The uptime is when the packet was sampled, if whoever wrote it said
+ * (e.g. CDataLoggerTenant and CAsyncDataLoggerTenant pass on the time each packet was sent), and when it was written
+ * otherwise. Raised to the previous entry's uptime if need be, so the entries stay sorted.
+ */
+struct __attribute__((packed)) log_index_entry {
+    uint32_t uptime_ms; //< uptime the packet was sampled (or written) at
+    uint32_t offset;    //< offset of the packet in the log
+};
+
+static constexpr std::size_t LOG_INDEX_INTERVAL = 4096;
+static constexpr std::size_t LOG_INDEX_PATH_SIZE = 64;
+
+/**
+ * Build the path of the index kept next to a log
+ * @return 0 on success, -ENAMETOOLONG if it doesn't fit in size bytes
+ */
+int log_index_path(const char *filename, char *path, std::size_t size);
+
+/**
+ * Binary search a log's index for a time
+ * @param filename the log (not the index) to look up
+ * @param uptime_ms uptime to look for
+ * @param[out] before offset of the last indexed packet written at or before uptime_ms. 0 if there is none
+ * @param[out] after offset of the first indexed packet written after uptime_ms. -1 if there is none
+ * @return 0 on success, negative errno code if the index can't be read
+ */
+int log_index_find(const char *filename, uint32_t uptime_ms, off_t &before, off_t &after);
+
 class datalogger {
   public:
-    datalogger(const char *filename, LogMode mode, std::size_t num_packets);
+    datalogger(const char *filename, LogMode mode, std::size_t num_packets, std::size_t packet_size,
+               uint8_t *block = nullptr, std::size_t block_size = 0, uint32_t flush_interval_ms = 0,
+               bool indexed = false);
     int write(const void *data, std::size_t size);
+    int write(const void *data, std::size_t size, uint32_t uptime_ms);
+    int write_many(const void *data, std::size_t size, std::size_t count, const uint32_t *uptimes_ms = nullptr);
+    int flush();
+    int64_t ms_until_flush() const;
     int close();
 
     const char *filename;
     fs_file_t file;
     LogMode mode;
     std::size_t num_packets;
+
+    // Persisted state (Circular and FixedSize only)
+    datalog_header header{};
+    off_t data_start = 0; //< offset of slot 0 in the file
+
+    // Write-back staging (block is nullptr when unbuffered)
+    uint8_t *block;
+    std::size_t block_size;
+    std::size_t block_fill = 0;
+    off_t block_offset = 0; //< offset in the file that block[0] will be written to
+    uint32_t flush_interval_ms;
+    bool dirty = false;         //< data has been accepted since the last sync
+    int64_t dirty_since_ms = 0; //< uptime of the oldest data not yet synced
+
+    // Sparse time index (Growing only)
+    bool indexed;
+    fs_file_t index_file;
+    off_t write_offset = 0;      //< offset the next packet will land at, counting staged data
+    off_t next_index_offset = 0; //< packets starting at or after this offset get an index entry
+    uint32_t last_index_uptime_ms = 0;
+
+  private:
+    void open_index();
+    void index_packet(std::size_t size, uint32_t uptime_ms);
+    int resume(std::size_t packet_size);
+    int write_header();
+    int wrap();
+    void mark_dirty();
+    int write_buffered(const void *data, std::size_t size, uint32_t uptime_ms);
+    int commit_block();
+};
+
+/**
+ * Reads back packets written by a datalogger, oldest first
+ */
+class datalog_reader {
+  public:
+    datalog_reader(const char *filename, LogMode mode, std::size_t size);
+    ~datalog_reader();
+    int read(std::size_t index, void *data);
+    int seek_to_time(uint32_t uptime_ms, std::size_t &index);
+
+    const char *filename;
+    LogMode mode;
+    fs_file_t file;
+    std::size_t size;
+    std::size_t count = 0;  //< number of packets available
+    std::size_t oldest = 0; //< slot holding the oldest packet
+    std::size_t num_slots = 0;
+    off_t data_start = 0;
+    int init_status;
+};
+
+/**
+ * A primitive field of a record, as seen by the compressor. Mirrors NTypes::FieldInfo so the library does not depend
+ * on autocoded types
+ */
+struct field_desc {
+    enum class kind_t : uint8_t { Float, Signed, Unsigned };
+
+    uint16_t offset;
+    uint8_t size;
+    kind_t kind;
+};
+
+/**
+ * Header at the start of a compressed log. Lets a decoder check it is using the same layout the log was written with
+ */
+struct __attribute__((packed)) compressed_log_header {
+    static constexpr uint32_t MAGIC = 0x474F4C43; // "CLOG"
+    static constexpr uint16_t VERSION = 1;
+
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint16_t num_fields;
+    uint16_t keyframe_interval;
+    uint32_t schema_hash; //< NTypes::TypeInfo<T>::schemaHash of the logged type
+};
+
+/**
+ * Field-wise delta compressor in front of a Growing datalogger.
+ *
+ * Every record is either a keyframe or a delta against the previous record:
+ * - keyframe: KEYFRAME_MARKER, record index (u32), the raw record, crc16-ccitt of the index and record
+ * - delta: length byte (1 - MAX_DELTA_SIZE) followed by that many bytes of MSB-first bitstream, one code per field
+ *
+ * Float fields are XORed with their previous value (Gorilla style):
+ * - '0' unchanged
+ * - '10' meaningful bits fit in the field's previous window, followed by those bits
+ * - '11' new window: leading zeros (5 bits, 6 for doubles), meaningful bit count - 1 (5 or 6 bits), meaningful bits
+ *
+ * Integer fields store the zigzagged difference from their previous value:
+ * - '0' unchanged, '10' 7 bits, '110' 16 bits, '1110' 32 bits, '1111' 64 bits
+ *
+ * Keyframes go out every keyframe_interval records, and whenever a delta would not fit its length byte, so decoding
+ * can start (or resume after corruption) at any keyframe.
+ */
+class compressed_datalogger {
+  public:
+    static constexpr std::size_t MAX_DELTA_SIZE = 254;
+    static constexpr uint8_t KEYFRAME_MARKER[4] = {0xFF, 'K', 'F', 'R'};
+    /// Bytes a keyframe adds around the record: marker, index and crc
+    static constexpr std::size_t KEYFRAME_OVERHEAD = sizeof(KEYFRAME_MARKER) + sizeof(uint32_t) + sizeof(uint16_t);
+
+    /**
+     * Size of the scratch buffer records are encoded into before being written, which must fit a keyframe or the
+     * largest delta
+     * @param record_size size of a record in bytes
+     */
+    static constexpr std::size_t scratch_size(std::size_t record_size) {
+        return MAX(1 + MAX_DELTA_SIZE, KEYFRAME_OVERHEAD + record_size);
+    }
+
+    /// Float window from the previous '11' code of a field. leading is NO_WINDOW until one has been sent
+    struct field_state {
+        static constexpr uint8_t NO_WINDOW = 0xFF;
+
+        uint8_t leading = NO_WINDOW;
+        uint8_t trailing = 0;
+    };
+
+    compressed_datalogger(const char *filename, const field_desc *fields, std::size_t num_fields,
+                          std::size_t record_size, uint32_t schema_hash, uint16_t keyframe_interval, uint8_t *previous,
+                          field_state *states, uint8_t *scratch, uint8_t *block = nullptr, std::size_t block_size = 0,
+                          uint32_t flush_interval_ms = 0, bool indexed = false);
+    int write(const void *record);
+    int write(const void *record, uint32_t uptime_ms);
+    int write_many(const void *records, std::size_t count, const uint32_t *uptimes_ms = nullptr);
+    int flush();
+    int64_t ms_until_flush() const;
+    int close();
+
+    datalogger file;
+    const field_desc *fields;
+    std::size_t num_fields;
+    std::size_t record_size;
+    uint16_t keyframe_interval;
+    uint8_t *previous; //< last record written, which the next delta is taken against
+    field_state *states;
+    uint8_t *scratch;  //< scratch_size(record_size) bytes to encode each record into, so it goes out in one write
+
+    uint32_t records_written = 0;
+    uint64_t bytes_written = 0; //< encoded bytes, including the header
+    bool keyframe_due = false;  //< set after a failed write, since the decoder may not have what the encoder has
+
+  private:
+    int write_keyframe(const uint8_t *record, uint32_t uptime_ms);
+    std::size_t encode_delta(const uint8_t *record);
+    int write_encoded(const void *data, std::size_t size, uint32_t uptime_ms);
+};
+
+/**
+ * Header at the start of a framed log, describing the records in it
+ */
+struct __attribute__((packed)) framed_log_header {
+    static constexpr uint32_t MAGIC = 0x474F4C46; // "FLOG"
+    static constexpr uint16_t VERSION = 1;
+    static constexpr std::size_t TYPE_NAME_SIZE = 32;
+
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint32_t schema_hash; //< NTypes::TypeInfo<T>::schemaHash of the logged type, 0 if it isn't autocoded
+    uint32_t block_size;  //< largest a block (header included) will ever be
+    char type_name[TYPE_NAME_SIZE];
+    uint32_t crc; //< crc32 of everything above
+};
+
+/**
+ * Header at the start of every block of records in a framed log
+ */
+struct __attribute__((packed)) frame_block_header {
+    static constexpr uint32_t MAGIC = 0x4B4C4246; // "FBLK"
+
+    uint32_t magic;
+    uint16_t length;         //< bytes of records following this header
+    uint16_t count;          //< number of records in the block
+    uint32_t first_sequence; //< sequence number the record offsets are relative to
+    uint32_t base_uptime_ms; //< uptime the first record's delta is relative to
+    uint32_t crc;            //< crc32 of this header up to here, then the records
+};
+
+/**
+ * Framing in front of each record in a block
+ */
+struct __attribute__((packed)) frame_record_header {
+    uint16_t uptime_delta_ms; //< time since the previous record in the block (or the block's base uptime)
+    uint16_t sequence_offset; //< sequence number minus the block's first_sequence. Gaps are dropped records
+};
+
+/**
+ * Groups records into crc-protected blocks, each record tagged with its uptime and sequence number.
+ * Blocks are built up in RAM and written with a single filesystem write once full, when a record can't be expressed
+ * relative to the block (more than 65 s or 65535 sequence numbers later), or on flush. A corrupt block only loses
+ * itself: the decoder skips it by its length, or searches forward for the next block magic if the length is bad too.
+ */
+class framed_datalogger {
+  public:
+    framed_datalogger(const char *filename, std::size_t record_size, const char *type_name, uint32_t schema_hash,
+                      uint8_t *block, std::size_t block_size, uint32_t flush_interval_ms = 0, bool indexed = false);
+    int write(const void *record, uint32_t uptime_ms, uint32_t sequence);
+    int flush();
+    int64_t ms_until_flush() const;
+    int close();
+
+    datalogger file;
+    std::size_t record_size;
+    uint32_t next_sequence = 0;
+
+  private:
+    int close_block();
+
+    uint8_t *block;
+    std::size_t block_size;
+    std::size_t block_fill = 0; //< 0 when no block is open, otherwise includes the block header
+    uint16_t block_count = 0;
+    uint32_t first_sequence = 0;
+    uint32_t base_uptime_ms = 0;
+    uint32_t last_uptime_ms = 0;
+    uint32_t flush_interval_ms;
+    int64_t opened_at_ms = 0; //< uptime the open block got its first record
+};
+
+/**
+ * Header at the start of a multi-stream log
+ */
+struct __attribute__((packed)) multi_stream_log_header {
+    static constexpr uint32_t MAGIC = 0x474F4C4D; // "MLOG"
+    static constexpr uint16_t VERSION = 1;
+
+    uint32_t magic;
+    uint16_t version;
+    uint16_t max_streams; //< stream ids are always below this
+};
+
+/**
+ * Tag in front of every record in a multi-stream log
+ */
+struct __attribute__((packed)) multi_stream_record_header {
+    /// Stream id of the records that define streams. Their payload is a multi_stream_definition
+    static constexpr uint8_t DEFINITION_STREAM = 0xFF;
+
+    uint8_t stream_id;
+    uint32_t uptime_ms; //< uptime the record was written (or sampled) at
+};
+
+/**
+ * Describes a stream. Written to the log as a record of its own when the stream is added, so readers learn the size
+ * of every record before they meet one
+ */
+struct __attribute__((packed)) multi_stream_definition {
+    static constexpr std::size_t NAME_SIZE = 24;
+
+    uint8_t stream_id;
+    uint16_t record_size;
+    uint32_t schema_hash; //< NTypes::TypeInfo<T>::schemaHash of the stream's type, 0 if it isn't autocoded
+    char name[NAME_SIZE];
+};
+
+static constexpr std::size_t MULTI_STREAM_MAX_STREAMS = 16;
+static constexpr std::size_t MULTI_STREAM_MAX_RECORD_SIZE = 256;
+
+/**
+ * Interleaves the records of several streams in one Growing datalogger.
+ * Every record is a multi_stream_record_header followed by the stream's fixed size record. Streams are defined in-line
+ * by DEFINITION_STREAM records, so streams can be added after others have started writing. Records are tagged and
+ * staged in one call under a mutex, so producers on different threads can share the log and the index always points
+ * at the start of a record.
+ */
+class multi_stream_logger {
+  public:
+    multi_stream_logger(const char *filename, uint8_t *block, std::size_t block_size, uint32_t flush_interval_ms = 0,
+                        bool indexed = false);
+    int add_stream(const char *name, std::size_t record_size, uint32_t schema_hash);
+    int write(uint8_t stream_id, const void *record, uint32_t uptime_ms);
+    int flush();
+    int64_t ms_until_flush();
+    int close();
+
+    datalogger file;
+    std::array<uint16_t, MULTI_STREAM_MAX_STREAMS> record_sizes{};
+    std::size_t num_streams = 0;
+
+  private:
+    int write_tagged(uint8_t stream_id, const void *record, std::size_t size, uint32_t uptime_ms);
+
+    k_mutex lock; //< guards everything, including num_streams and record_sizes
+    /// Tag and record staged together under the lock, so writers' stacks don't need room for the largest record
+    std::array<uint8_t, sizeof(multi_stream_record_header) + MULTI_STREAM_MAX_RECORD_SIZE> tagged;
+};
+
+/**
+ * Reads back the records of one stream from a multi-stream log, skipping over the others
+ */
+class multi_stream_reader {
+  public:
+    multi_stream_reader(const char *filename, const char *name, std::size_t record_size);
+    ~multi_stream_reader();
+    int next(void *record, uint32_t &uptime_ms);
+    int rewind();
+
+    fs_file_t file;
+    const char *name;
+    std::size_t record_size;
+    std::array<uint16_t, MULTI_STREAM_MAX_STREAMS> record_sizes{};
+    int stream_id = -1; //< id of the stream being read, once its definition has been seen
+    uint32_t schema_hash = 0;
+    int init_status;
 };
 } // namespace detail
 
 /**
  * @brief A type-safe class that supports writing fixed-sized packets to the filesystem
  * The Datalogger can be configured to use different modes:
- * - Growing - the file will grow ever larger as you write more packets (assuming space is still available on the device) 
+ * - Growing - the file will grow ever larger as you write more packets (assuming space is still available on the device).
+ *   Opening one replaces whatever the file held before
  * - Circular - the file will hold only a certain number of packets. Old data will be overwritten with new data
  * - FixedSize - the file will hold only a certain number of packets. Old data will be retained if you try to write more packets than it can fit
  * This class is implemented as a type safe wrapper to detail::datalogger.
+ *
+ * Growing logs can keep a sparse index of (uptime, offset) entries in <filename>.idx, one per
+ * detail::LOG_INDEX_INTERVAL bytes. It costs one small write per interval and lets CDataLogReader::SeekToTime, the
+ * TFTP server and the host tools jump to a time without scanning the log.
+ *
+ * Circular and FixedSize logs start with a small header (see detail::datalog_header) holding the write cursor.
+ * Reopening one of these logs picks up at the cursor instead of overwriting the start of the file, and costs the same
+ * no matter how big the log is. Use CDataLogReader to read them back in order.
+ *
+ * If BlockSize is non-zero, packets are staged in a RAM buffer of that many bytes and only handed to the filesystem
+ * once a whole block (aligned to BlockSize within the file) has been collected. Pick the flash erase block size
+ * so every fs_write lines up with a block. Staged data is lost on power loss unless Flush() is called, so a
+ * flush interval bounds how stale the data on disk can get.
+ * @tparam T the packet type to log
+ * @tparam BlockSize size of the write-back staging buffer in bytes. 0 writes every packet straight through
  */
-template <typename T>
+template <typename T, std::size_t BlockSize = 0>
 class CDataLogger {
   public:
     using PacketType = T;
@@ -44,15 +427,23 @@ class CDataLogger {
      * Construct a Datalogger for the specified filename
      * The logger will use the "Growing" mode and will expand as you write more data until your filesystem runs out of space.
      * @param filename the name of the file to write to
+     * @param flushIntervalMs the longest time staged data may go without being flushed (only used if BlockSize > 0)
+     * @param indexed keep a sparse time index next to the log for CDataLogReader::SeekToTime
      */
-    CDataLogger(const char *filename) : internal(filename, LogMode::Growing, 0) {}
+    CDataLogger(const char *filename, uint32_t flushIntervalMs = 0, bool indexed = false)
+        : CDataLogger(filename, LogMode::Growing, 0, flushIntervalMs, indexed) {}
     /**
      * Construct a Datalogger for the specified filename, grow mode, and size
      * @param filename the name of the file to write to
      * @param mode the logging mode to use
      * @param the number of packets to log (only used if mode is Circular or FixedSize)
+     * @param flushIntervalMs the longest time staged data may go without being flushed. 0 only flushes full blocks (only used if BlockSize > 0)
+     * @param indexed keep a sparse time index next to the log for CDataLogReader::SeekToTime (Growing only)
      */
-    CDataLogger(const char *filename, LogMode mode, std::size_t num_packets) : internal(filename, mode, num_packets) {}
+    CDataLogger(const char *filename, LogMode mode, std::size_t num_packets, uint32_t flushIntervalMs = 0,
+                bool indexed = false)
+        : internal(filename, mode, num_packets, sizeof(PacketType), BlockSize > 0 ? block.data() : nullptr, BlockSize,
+                   flushIntervalMs, indexed) {}
     /**
      * Write a packet to the file
      * @param packet the data to write to the file
@@ -60,6 +451,43 @@ class CDataLogger {
     int write(const PacketType &packet) {
         return internal.write(reinterpret_cast<const void *>(&packet), sizeof(PacketType));
     }
+    /**
+     * Write a packet to the file that was sampled at a known time. The time only goes in the index (if any)
+     * @param packet the data to write to the file
+     * @param uptimeMs uptime the packet was sampled at
+     */
+    int write(const PacketType &packet, uint32_t uptimeMs) {
+        return internal.write(reinterpret_cast<const void *>(&packet), sizeof(PacketType), uptimeMs);
+    }
+    /**
+     * Write several contiguous packets to the file, with as few filesystem writes as the log mode allows
+     * @param packets the packets to write
+     * @param count the number of packets to write
+     * @return number of bytes written, or a negative errno code on error
+     */
+    int WriteMany(const PacketType *packets, std::size_t count) {
+        return internal.write_many(reinterpret_cast<const void *>(packets), sizeof(PacketType), count);
+    }
+    /**
+     * Write several contiguous packets to the file, each indexed by the uptime it was sampled at
+     * @param packets the packets to write
+     * @param uptimesMs uptime each packet was sampled at
+     * @param count the number of packets to write
+     * @return number of bytes written, or a negative errno code on error
+     */
+    int WriteMany(const PacketType *packets, const uint32_t *uptimesMs, std::size_t count) {
+        return internal.write_many(reinterpret_cast<const void *>(packets), sizeof(PacketType), count, uptimesMs);
+    }
+    /**
+     * Write any staged data (and the log header for Circular and FixedSize logs) to the file and sync it to disk
+     * @return 0 on success, negative errno code on error
+     */
+    int Flush() { return internal.flush(); }
+    /**
+     * Get the time remaining before staged data is due to be flushed
+     * @return milliseconds until the next flush is due. 0 if overdue, -1 if nothing is waiting to be flushed
+     */
+    int64_t MsUntilFlush() const { return internal.ms_until_flush(); }
     /**
      * Close the file and flush to disk.
      * Make sure to do this or some of your data may not be sent to the disk before power is cut/the chip is turned off
@@ -70,7 +498,62 @@ class CDataLogger {
     int close() { return internal.close(); }
 
   private:
+    // Declared before internal so it outlives every use by it
+    std::array<uint8_t, BlockSize> block;
     detail::datalogger internal;
 };
 
-#endif
\ No newline at end of file
+
+/**
+ * @brief Reads back a file written by CDataLogger<T>, oldest packet first
+ * For Circular logs the oldest packet is the one just after the write cursor once the log has wrapped.
+ */
+template <typename T>
+class CDataLogReader {
+  public:
+    using PacketType = T;
+
+    /**
+     * Open a log for reading
+     * @param filename the file the log was written to
+     * @param mode the mode the log was written with
+     */
+    CDataLogReader(const char *filename, LogMode mode) : internal(filename, mode, sizeof(PacketType)) {}
+
+    /**
+     * Get the number of packets in the log
+     * @return number of packets that can be read
+     */
+    std::size_t Count() const { return internal.count; }
+
+    /**
+     * Read a packet from the log
+     * @param index index of the packet to read. 0 is the oldest packet, Count() - 1 is the newest
+     * @param[out] packet the packet that was read
+     * @return 0 on success, -EINVAL if index is out of range, negative errno code on filesystem error
+     */
+    int Read(std::size_t index, PacketType &packet) { return internal.read(index, &packet); }
+
+    /**
+     * Find where to start reading to get the packets sampled at or after a time, using the log's index.
+     * The index is sparse (one entry per LOG_INDEX_INTERVAL bytes), so packets up to one interval earlier may come first.
+     * Packets written with write(packet) or WriteMany(packets, count) are indexed by when they were written, which
+     * trails when they were sampled by however long they sat in a queue or buffer (seconds for a pre-trigger buffer).
+     * Write them with their sample times to index them by those instead
+     * @param uptimeMs uptime to look for
+     * @param[out] index index of the packet to start reading from
+     * @return 0 on success, -ENOTSUP if the log isn't Growing, negative errno code if the index can't be read
+     */
+    int SeekToTime(uint32_t uptimeMs, std::size_t &index) { return internal.seek_to_time(uptimeMs, index); }
+
+    /**
+     * Get the status of opening the log
+     * @return 0 if the log was opened, negative errno code otherwise
+     */
+    int GetInitStatus() const { return internal.init_status; }
+
+  private:
+    detail::datalog_reader internal;
+};
+
+#endif
@@ -0,0 +1,145 @@
+#ifndef C_FRAMED_DATALOGGER_H
+#define C_FRAMED_DATALOGGER_H
+
+#include <array>
+#include <f_core/os/c_datalogger.h>
+#include <type_traits>
+#include <zephyr/kernel.h>
+
+#if __has_include(<n_autocoder_types.h>)
+#include <n_autocoder_types.h>
+#define F_CORE_HAS_AUTOCODER_TYPES 1
+#endif
+
+namespace detail {
+/// Name and schema hash of a type, taken from NTypes::TypeInfo when the type is autocoded
+template <typename T, typename = void>
+struct framed_type_info {
+    static constexpr const char *name = "";
+    static constexpr uint32_t schemaHash = 0;
+};
+
+#ifdef F_CORE_HAS_AUTOCODER_TYPES
+template <typename T>
+struct framed_type_info<T, std::void_t<decltype(NTypes::TypeInfo<T>::schemaHash)>> {
+    static constexpr const char *name = NTypes::TypeInfo<T>::name;
+    static constexpr uint32_t schemaHash = NTypes::TypeInfo<T>::schemaHash;
+};
+#endif
+} // namespace detail
+
+/**
+ * @brief A type-safe Growing datalogger that frames every packet with its uptime and sequence number
+ * Packets are grouped into blocks of up to BlockSize bytes, each with a crc, so missing samples, the real sample rate
+ * and corrupt data can all be found after the fact. Framing costs 4 bytes per packet plus 20 per block. The file starts
+ * with a header naming the type, its size, and (for autocoded types) its schema hash. See detail::framed_datalogger
+ * for the layout.
+ *
+ * Decode on the host with tools/data_log_check/framed_log_decode.py.
+ * @tparam T the packet type to log
+ * @tparam BlockSize largest block to write, header included. Also the RAM staging buffer size
+ */
+template <typename T, std::size_t BlockSize = 1024>
+class CFramedDataLogger {
+  public:
+    using PacketType = T;
+    static_assert(std::is_trivially_copyable<PacketType>::value, "Only trivially copyable types can be logged");
+    static_assert(BlockSize >= sizeof(detail::frame_block_header) + sizeof(detail::frame_record_header) + sizeof(T),
+                  "BlockSize must fit at least one framed packet");
+    static_assert(BlockSize - sizeof(detail::frame_block_header) <= UINT16_MAX, "Block length must fit in 16 bits");
+
+    /**
+     * Construct a framed Datalogger for the specified filename
+     * @param filename the name of the file to write to
+     * @param flushIntervalMs the longest time staged data may go without being flushed. 0 only writes full blocks
+     * @param indexed keep a sparse time index of block offsets next to the log (see CDataLogger)
+     */
+    CFramedDataLogger(const char *filename, uint32_t flushIntervalMs = 0, bool indexed = false)
+        : internal(filename, sizeof(PacketType), detail::framed_type_info<T>::name,
+                   detail::framed_type_info<T>::schemaHash, block.data(), BlockSize, flushIntervalMs, indexed) {}
+
+    /**
+     * Write a packet to the file, stamped with the current uptime and the next sequence number
+     * @param packet the data to write to the file
+     * @return sizeof(PacketType) on success, negative errno code on error
+     */
+    int write(const PacketType &packet) { return write(packet, k_uptime_get_32()); }
+
+    /**
+     * Write a packet to the file that was sampled at a known time
+     * @param packet the data to write to the file
+     * @param uptimeMs uptime the packet was sampled at
+     * @return sizeof(PacketType) on success, negative errno code on error
+     */
+    int write(const PacketType &packet, uint32_t uptimeMs) {
+        return internal.write(&packet, uptimeMs, internal.next_sequence);
+    }
+
+    /**
+     * Write several contiguous packets to the file, all stamped with the current uptime. Packets that waited in a queue
+     * should be written with the uptimes they were sampled at instead
+     * @param packets the packets to write
+     * @param count the number of packets to write
+     * @return number of bytes of packets written, or a negative errno code on error
+     */
+    int WriteMany(const PacketType *packets, std::size_t count) {
+        const uint32_t uptimeMs = k_uptime_get_32();
+        for (std::size_t i = 0; i < count; i++) {
+            int ret = write(packets[i], uptimeMs);
+            if (ret < 0) {
+                return ret;
+            }
+        }
+        return count * sizeof(PacketType);
+    }
+
+    /**
+     * Write several contiguous packets to the file, each stamped with the uptime it was sampled at
+     * @param packets the packets to write
+     * @param uptimesMs uptime each packet was sampled at
+     * @param count the number of packets to write
+     * @return number of bytes of packets written, or a negative errno code on error
+     */
+    int WriteMany(const PacketType *packets, const uint32_t *uptimesMs, std::size_t count) {
+        for (std::size_t i = 0; i < count; i++) {
+            int ret = write(packets[i], uptimesMs[i]);
+            if (ret < 0) {
+                return ret;
+            }
+        }
+        return count * sizeof(PacketType);
+    }
+
+    /**
+     * Record that packets were lost before reaching the logger, so the gap shows up in the sequence numbers.
+     * CDataLoggerTenant passes on what its message port drops
+     * @param count number of packets lost
+     */
+    void NoteDropped(uint32_t count) { internal.next_sequence += count; }
+
+    /**
+     * Write the open block to the file and sync it to disk
+     * @return 0 on success, negative errno code on error
+     */
+    int Flush() { return internal.flush(); }
+
+    /**
+     * Get the time remaining before the open block is due to be flushed
+     * @return milliseconds until the next flush is due. 0 if overdue, -1 if nothing is waiting to be flushed
+     */
+    int64_t MsUntilFlush() const { return internal.ms_until_flush(); }
+
+    /**
+     * Close the file and flush to disk.
+     * Make sure to do this or some of your data may not be sent to the disk before power is cut/the chip is turned off
+     * @return 0 on success, negative errno code on error
+     */
+    int close() { return internal.close(); }
+
+  private:
+    // Declared before internal so it outlives every use by it
+    std::array<uint8_t, BlockSize> block;
+    detail::framed_datalogger internal;
+};
+
+#endif //C_FRAMED_DATALOGGER_H
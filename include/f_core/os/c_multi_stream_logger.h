@@ -0,0 +1,228 @@
+#ifndef C_MULTI_STREAM_LOGGER_H
+#define C_MULTI_STREAM_LOGGER_H
+
+#include <array>
+#include <f_core/os/c_datalogger.h>
+#include <f_core/os/c_framed_datalogger.h>
+#include <type_traits>
+#include <zephyr/kernel.h>
+
+/**
+ * @brief A handle for writing one type of packet into a CMultiStreamLogger
+ * Cheap to copy. Has the same write(), Flush(), MsUntilFlush() and close() as CDataLogger, so it can be used as the
+ * Logger of a CDataLoggerTenant
+ * @tparam T the packet type of the stream
+ */
+template <typename T>
+class CLogStream {
+  public:
+    using PacketType = T;
+
+    /**
+     * Construct a handle to a stream
+     * @param logger the multi-stream log the stream lives in
+     * @param streamId the id the stream was added with, or a negative errno code if adding it failed
+     */
+    CLogStream(detail::multi_stream_logger &logger, int streamId) : logger(logger), streamId(streamId) {}
+
+    /**
+     * Write a packet to the stream, stamped with the current uptime
+     * @param packet the data to write
+     * @return sizeof(PacketType) on success, negative errno code on error
+     */
+    int write(const PacketType &packet) { return write(packet, k_uptime_get_32()); }
+
+    /**
+     * Write a packet to the stream that was sampled at a known time
+     * @param packet the data to write
+     * @param uptimeMs uptime the packet was sampled at
+     * @return sizeof(PacketType) on success, negative errno code on error
+     */
+    int write(const PacketType &packet, uint32_t uptimeMs) {
+        if (streamId < 0) {
+            return streamId;
+        }
+        return logger.write(streamId, &packet, uptimeMs);
+    }
+
+    /**
+     * Write several contiguous packets to the stream, all stamped with the current uptime
+     * @param packets the packets to write
+     * @param count the number of packets to write
+     * @return number of bytes of packets written, or a negative errno code on error
+     */
+    int WriteMany(const PacketType *packets, std::size_t count) {
+        const uint32_t uptimeMs = k_uptime_get_32();
+        for (std::size_t i = 0; i < count; i++) {
+            int ret = write(packets[i], uptimeMs);
+            if (ret < 0) {
+                return ret;
+            }
+        }
+        return count * sizeof(PacketType);
+    }
+
+    /**
+     * Write several contiguous packets to the stream, each stamped with the uptime it was sampled at
+     * @param packets the packets to write
+     * @param uptimesMs uptime each packet was sampled at
+     * @param count the number of packets to write
+     * @return number of bytes of packets written, or a negative errno code on error
+     */
+    int WriteMany(const PacketType *packets, const uint32_t *uptimesMs, std::size_t count) {
+        for (std::size_t i = 0; i < count; i++) {
+            int ret = write(packets[i], uptimesMs[i]);
+            if (ret < 0) {
+                return ret;
+            }
+        }
+        return count * sizeof(PacketType);
+    }
+
+    /**
+     * Write staged data of every stream in the log to the file and sync it to disk
+     * @return 0 on success, negative errno code on error
+     */
+    int Flush() { return logger.flush(); }
+
+    /**
+     * Get the time remaining before staged data of the log is due to be flushed
+     * @return milliseconds until the next flush is due. 0 if overdue, -1 if nothing is waiting to be flushed
+     */
+    int64_t MsUntilFlush() const { return logger.ms_until_flush(); }
+
+    /**
+     * Flush the log. The file is shared with the other streams, so it stays open until the CMultiStreamLogger is
+     * closed
+     * @return 0 on success, negative errno code on error
+     */
+    int close() { return Flush(); }
+
+    /**
+     * Check the stream was added to the log
+     * @return true if packets can be written to the stream
+     */
+    bool IsValid() const { return streamId >= 0; }
+
+  private:
+    detail::multi_stream_logger &logger;
+    int streamId;
+};
+
+/**
+ * @brief A Growing datalogger that interleaves several streams of packets in one file
+ * Every packet is tagged with its stream id and uptime (5 bytes). Streams are added at any time with AddStream() and
+ * described in the file as they are added, so a file can be split back up without knowing how it was written. Sharing
+ * one file between streams saves the LittleFS file cache and metadata commits of every extra open file, and turns
+ * scattered small writes into sequential block-sized ones.
+ *
+ * Streams can be written from different threads. Read a stream back on the device with CMultiStreamReader, or split
+ * the file on the host with tools/data_log_check/multi_stream_decode.py. See detail::multi_stream_logger for the
+ * layout.
+ * @tparam BlockSize size of the RAM staging buffer shared by every stream. 0 writes every packet straight through
+ */
+template <std::size_t BlockSize = 1024>
+class CMultiStreamLogger {
+  public:
+    /**
+     * Construct a multi-stream Datalogger for the specified filename
+     * @param filename the name of the file to write to
+     * @param flushIntervalMs the longest time staged data may go without being flushed. 0 only writes full blocks
+     * @param indexed keep a sparse time index next to the log (see CDataLogger)
+     */
+    CMultiStreamLogger(const char *filename, uint32_t flushIntervalMs = 0, bool indexed = false)
+        : internal(filename, BlockSize > 0 ? block.data() : nullptr, BlockSize, flushIntervalMs, indexed) {}
+
+    /**
+     * Add a stream to the log
+     * @tparam T the packet type of the stream
+     * @param name name of the stream in the file. Defaults to the autocoded type name, but has to be given when two
+     * streams share a type or the type isn't autocoded
+     * @return a handle to write the stream with. Check IsValid() if the log may be out of streams
+     */
+    template <typename T>
+    CLogStream<T> AddStream(const char *name = detail::framed_type_info<T>::name) {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be logged");
+        static_assert(sizeof(T) <= detail::MULTI_STREAM_MAX_RECORD_SIZE, "Packet type is too large for a stream");
+        return CLogStream<T>(internal, internal.add_stream(name, sizeof(T), detail::framed_type_info<T>::schemaHash));
+    }
+
+    /**
+     * Write staged data to the file and sync it to disk
+     * @return 0 on success, negative errno code on error
+     */
+    int Flush() { return internal.flush(); }
+
+    /**
+     * Get the time remaining before staged data is due to be flushed
+     * @return milliseconds until the next flush is due. 0 if overdue, -1 if nothing is waiting to be flushed
+     */
+    int64_t MsUntilFlush() { return internal.ms_until_flush(); }
+
+    /**
+     * Close the file and flush to disk.
+     * Make sure to do this or some of your data may not be sent to the disk before power is cut/the chip is turned off
+     * @return 0 on success, negative errno code on error
+     */
+    int close() { return internal.close(); }
+
+  private:
+    // Declared before internal so it outlives every use by it
+    std::array<uint8_t, BlockSize> block;
+    detail::multi_stream_logger internal;
+};
+
+/**
+ * @brief Reads back the packets of one stream of a CMultiStreamLogger file, oldest first
+ * @tparam T the packet type of the stream
+ */
+template <typename T>
+class CMultiStreamReader {
+  public:
+    using PacketType = T;
+
+    /**
+     * Open a stream of a multi-stream log
+     * @param filename the multi-stream log to read
+     * @param name name the stream was added with
+     */
+    CMultiStreamReader(const char *filename, const char *name = detail::framed_type_info<T>::name)
+        : internal(filename, name, sizeof(T)) {}
+
+    /**
+     * Read the next packet of the stream
+     * @param packet the packet to read into
+     * @param uptimeMs set to the uptime the packet was written at
+     * @return 0 on success, -ENODATA at the end of the log, -EILSEQ if the stream was written with a different layout
+     * of T, other negative errno codes on error
+     */
+    int Next(PacketType &packet, uint32_t &uptimeMs) {
+        int ret = internal.next(&packet, uptimeMs);
+        if (ret == 0 && internal.schema_hash != 0 && detail::framed_type_info<T>::schemaHash != 0 &&
+            internal.schema_hash != detail::framed_type_info<T>::schemaHash) {
+            return -EILSEQ;
+        }
+        return ret;
+    }
+
+    /**
+     * Read the next packet of the stream
+     * @param packet the packet to read into
+     * @return see Next(packet, uptimeMs)
+     */
+    int Next(PacketType &packet) {
+        uint32_t uptimeMs = 0;
+        return Next(packet, uptimeMs);
+    }
+
+    /**
+     * Go back to the start of the log
+     * @return 0 on success, negative errno code on error
+     */
+    int Rewind() { return internal.rewind(); }
+
+  private:
+    detail::multi_stream_reader internal;
+};
+
+#endif //C_MULTI_STREAM_LOGGER_H
@@ -0,0 +1,196 @@
+#ifndef C_RAW_FLASH_LOGGER_H
+#define C_RAW_FLASH_LOGGER_H
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include <zephyr/kernel.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/sys/atomic.h>
+
+namespace detail {
+/**
+ * Header at the start of every sector of a raw flash log. It is the log's only recovery state: the valid header with
+ * the highest sequence number marks the sector being written, and the first erased slot in it is where writing
+ * resumes. Nothing is ever rewritten in place, so there is no header to tear on power loss.
+ */
+struct __attribute__((packed)) raw_flash_sector_header {
+    static constexpr uint32_t MAGIC = 0x534C4652; // "RFLS"
+    static constexpr uint16_t VERSION = 1;
+
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint32_t sequence; //< sectors written before this one since the partition was first used
+    uint32_t crc;      //< crc32 of everything above
+};
+
+/**
+ * Circular log of fixed-size records written straight to a flash partition, bypassing the filesystem.
+ *
+ * The partition is split into sectors (erase units), each holding a raw_flash_sector_header followed by slots of the
+ * record and its crc16-ccitt, padded to the flash write alignment. Slots are staged in a RAM page and programmed a
+ * page at a time. Sectors ahead of the one being written are erased by a work item on a work queue of their own
+ * (CONFIG_F_CORE_RAW_FLASH_ERASE_PRIORITY), so neither the writer nor the system work queue waits on an erase unless
+ * the writer catches up with the eraser. Once the partition is full the oldest sectors are
+ * erased to make room.
+ *
+ * Erased slots read back as the flash's erase value, so a slot is either erased, valid, or torn (bad crc) by a power
+ * loss mid-program. Torn slots are skipped when reading back.
+ */
+class raw_flash_logger {
+  public:
+    raw_flash_logger(uint8_t partition_id, std::size_t record_size, uint8_t *page, std::size_t page_size,
+                     std::size_t sector_size, uint32_t flush_interval_ms = 0, std::size_t pre_erase_sectors = 2);
+    int write(const void *record);
+    int flush();
+    int64_t ms_until_flush() const;
+    int close();
+    int export_to(const char *filename);
+
+    const flash_area *area = nullptr;
+    int init_status;
+    std::size_t record_size;
+    std::size_t slot_size = 0;   //< record and crc, padded to the write alignment
+    std::size_t header_size = 0; //< sector header, padded to the write alignment
+    std::size_t sector_size;
+    std::size_t num_sectors = 0;
+    std::size_t slots_per_sector = 0;
+    uint8_t erased_value = 0xFF;
+
+    uint32_t sequence = 0; //< sequence number of the sector being written
+    std::size_t slot = 0;  //< next slot in that sector
+
+    // Staged slots, programmed to page_offset in the partition
+    uint8_t *page;
+    std::size_t page_size;
+    std::size_t page_fill = 0;
+    off_t page_offset = 0;
+    uint32_t flush_interval_ms;
+    int64_t staged_since_ms = 0; //< uptime the oldest staged record was written at
+
+    uint32_t erase_stalls = 0; //< times the writer had to erase a sector itself
+
+  private:
+    int open(uint8_t partition_id);
+    void resume();
+    int start_sector(uint32_t new_sequence);
+    int ensure_erased(uint32_t target);
+    int erase_sector(uint32_t target);
+    int program_page();
+    bool read_sector_header(std::size_t index, raw_flash_sector_header &header) const;
+    int read_slot(off_t offset, uint8_t *slot_data) const;
+    off_t sector_offset(uint32_t target) const { return (target % num_sectors) * sector_size; }
+    static void erase_handler(k_work *work);
+
+    /// Work item that can find its way back to the logger (which isn't standard layout, so CONTAINER_OF can't)
+    struct erase_work_item {
+        k_work work;
+        raw_flash_logger *logger;
+    };
+
+    std::size_t pre_erase_sectors;
+    erase_work_item erase_work;
+    k_mutex erase_lock;
+    atomic_t erased_until = ATOMIC_INIT(0); //< every sector sequence below this has been erased
+    atomic_t writing = ATOMIC_INIT(0);      //< sequence the eraser must stay ahead of
+};
+} // namespace detail
+
+/**
+ * @brief A type-safe circular datalogger that writes fixed-size packets straight to a flash partition
+ * For the phases of flight that need the highest sustained write rate and steady latency: there are no filesystem
+ * metadata commits or block relocations, just page programs, with sector erases done ahead of time in the background.
+ * See detail::raw_flash_logger for the layout and how it recovers after a reset.
+ *
+ * Has the same constructor and write(), Flush(), MsUntilFlush() and close() as CDataLogger, so it can be the Logger of a
+ * CDataLoggerTenant. The filename is where Export() copies the log to once the flight is over, as a plain Growing
+ * CDataLogger file that can be pulled over TFTP and read by the usual tools.
+ * @tparam T the packet type to log
+ * @tparam PartitionId the partition to log to (e.g. FIXED_PARTITION_ID(flight_data_partition)). Its contents are lost
+ * @tparam PageSize size of the RAM staging buffer. Best set to the flash's program page size
+ * @tparam SectorSize erase unit of the flash. The partition must be a multiple of it
+ */
+template <typename T, uint8_t PartitionId, std::size_t PageSize = 256, std::size_t SectorSize = 4096>
+class CRawFlashLogger {
+  public:
+    using PacketType = T;
+    static_assert(std::is_trivially_copyable<PacketType>::value, "Only trivially copyable types can be logged");
+    static_assert(PageSize >= sizeof(T) + sizeof(uint16_t) + sizeof(detail::raw_flash_sector_header),
+                  "PageSize must fit a sector header and a packet");
+    static_assert(SectorSize >= 2 * PageSize, "SectorSize must be larger than PageSize");
+
+    /**
+     * Construct a raw flash Datalogger, resuming after whatever was written to the partition last
+     * @param exportFilename the file Export() copies the log to
+     * @param flushIntervalMs the longest time staged packets may go without being programmed. 0 only writes full pages
+     * @param indexed unused. Exported logs are not indexed
+     */
+    CRawFlashLogger(const char *exportFilename, uint32_t flushIntervalMs = 0, bool indexed = false)
+        : internal(PartitionId, sizeof(PacketType), page.data(), PageSize, SectorSize, flushIntervalMs),
+          exportFilename(exportFilename) {
+        ARG_UNUSED(indexed);
+    }
+
+    /**
+     * Write a packet to the partition
+     * @param packet the data to write
+     * @return sizeof(PacketType) on success, negative errno code on error
+     */
+    int write(const PacketType &packet) { return internal.write(&packet); }
+
+    /**
+     * Write several contiguous packets to the partition
+     * @param packets the packets to write
+     * @param count the number of packets to write
+     * @return number of bytes of packets written, or a negative errno code on error
+     */
+    int WriteMany(const PacketType *packets, std::size_t count) {
+        for (std::size_t i = 0; i < count; i++) {
+            int ret = internal.write(&packets[i]);
+            if (ret < 0) {
+                return ret;
+            }
+        }
+        return count * sizeof(PacketType);
+    }
+
+    /**
+     * Program staged packets to the flash
+     * @return 0 on success, negative errno code on error
+     */
+    int Flush() { return internal.flush(); }
+
+    /**
+     * Get the time remaining before staged packets are due to be programmed
+     * @return milliseconds until the next flush is due. 0 if overdue, -1 if nothing is waiting to be flushed
+     */
+    int64_t MsUntilFlush() const { return internal.ms_until_flush(); }
+
+    /**
+     * Program staged packets and stop erasing ahead
+     * @return 0 on success, negative errno code on error
+     */
+    int close() { return internal.close(); }
+
+    /**
+     * Copy every intact packet in the partition, oldest first, to the export file given at construction
+     * Call after close(), e.g. once landed
+     * @return number of packets exported, or a negative errno code on error
+     */
+    int Export() { return internal.export_to(exportFilename); }
+
+    /**
+     * Get the number of times a write had to wait for a sector erase the background eraser hadn't finished
+     * @return erase stalls since construction
+     */
+    uint32_t GetEraseStalls() const { return internal.erase_stalls; }
+
+  private:
+    // Declared before internal so it outlives every use by it
+    std::array<uint8_t, PageSize> page;
+    detail::raw_flash_logger internal;
+    const char *exportFilename;
+};
+
+#endif //C_RAW_FLASH_LOGGER_H
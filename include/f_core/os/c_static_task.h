@@ -0,0 +1,51 @@
+/*
+* Copyright (c) 2025 RIT Launch Initiative
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef C_STATIC_TASK_H
+#define C_STATIC_TASK_H
+
+#include <f_core/os/c_task.h>
+
+#include <array>
+#include <zephyr/kernel.h>
+
+/**
+ * A task with its stack and tenant table inside the object, so it needs no heap and nothing is allocated when it
+ * starts. Declare it with static storage (e.g. as a member of a module object) and the stack lands in RAM at link time,
+ * where running out shows up as a link error instead of a panic at boot
+ * @tparam StackSize size of the stack in bytes
+ * @tparam MaxTenants most tenants that can be added to the task
+ */
+template <std::size_t StackSize, std::size_t MaxTenants>
+class CStaticTask : public CTask {
+public:
+    static_assert(StackSize >= CONFIG_F_CORE_TASK_MIN_STACK_SIZE,
+                  "Stack is smaller than CONFIG_F_CORE_TASK_MIN_STACK_SIZE");
+    static_assert(MaxTenants > 0, "Task must have room for at least one tenant");
+
+    /**
+     * Constructor
+     * @param name Name of the task
+     * @param priority Zephyr priority level
+     * @param sleepTimeMs Time to sleep between a single cycle of the task
+     */
+    explicit CStaticTask(const char* name, int priority = CONFIG_NUM_PREEMPT_PRIORITIES, int sleepTimeMs = 0)
+        : CTask(name, priority, stack, K_KERNEL_STACK_SIZEOF(stack), tenantSlots, sleepTimeMs) {}
+
+    /**
+     * Constructor for a periodic task. See CTask
+     * @param name Name of the task
+     * @param priority Zephyr priority level
+     * @param period Time between the starts of consecutive cycles of the task
+     */
+    CStaticTask(const char* name, int priority, Period period)
+        : CTask(name, priority, stack, K_KERNEL_STACK_SIZEOF(stack), tenantSlots, period) {}
+
+private:
+    K_KERNEL_STACK_MEMBER(stack, StackSize);
+    std::array<CTenant*, MaxTenants> tenantSlots{};
+};
+
+#endif //C_STATIC_TASK_H
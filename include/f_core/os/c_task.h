@@ -7,16 +7,62 @@
 #define C_TASK_H
 
 #include <cstdint>
+#include <span>
 #include <vector>
 
 #include <f_core/os/c_tenant.h>
+#include <f_core/os/c_wait_set.h>
 #include <zephyr/kernel.h>
 
 /**
- * Thread to be ran in the RTOS
+ * Thread to be ran in the RTOS. Its stack is allocated when the task is initialized and its tenants are kept on the
+ * heap. See CStaticTask for a task with its stack and tenant table sized at compile time
  */
 class CTask {
 public:
+    /**
+     * Period of a periodic task
+     */
+    struct Period {
+        uint32_t us;
+    };
+
+    /**
+     * Timing of a periodic task. Periods are measured between consecutive wakeups
+     */
+    struct TimingStats {
+        uint32_t periodUs;       //< Configured period
+        uint32_t releases;       //< Number of deadlines the task woke up at
+        uint32_t deadlineMisses; //< Times the tenants were still running at the next release
+        uint32_t minPeriodUs;    //< Shortest measured period
+        uint32_t maxPeriodUs;    //< Longest measured period, not counting periods skipped after a deadline miss
+        uint32_t maxJitterUs;    //< Largest difference between a measured and the configured period
+        uint32_t meanJitterUs;   //< Mean difference between a measured and the configured period
+    };
+
+    /**
+     * Stack usage of a task
+     */
+    struct StackUsage {
+        size_t size;        //< Size the task was given
+        size_t peakUsed;    //< Most of the stack used since the task started
+        size_t recommended; //< Peak plus CONFIG_F_CORE_TASK_STACK_MARGIN_PERCENT, rounded up
+    };
+
+    /**
+     * What the health monitor sees of a task. Times are in ms
+     */
+    struct Health {
+        uint32_t checkIns;         //< Cycles the task has started
+        uint32_t sinceCheckInMs;   //< Time since the task last started a cycle
+        uint32_t overruns;         //< Tenant runs that took longer than the task's deadline
+        const char* overrunTenant; //< Tenant that overran most recently
+        uint32_t overrunMs;        //< How long that run took
+        const char* missTenant;    //< Slowest tenant of the most recent cycle that missed its release
+        const char* runningTenant; //< Tenant running now, nullptr between tenants
+        uint32_t runningForMs;     //< How long the running tenant has been running
+    };
+
     /**
      * Constructor
      * @param name Name of the task
@@ -26,10 +72,20 @@ public:
      */
     CTask(const char* name, int priority = CONFIG_NUM_PREEMPT_PRIORITIES, int stackSize = 512, int sleepTimeMs = 0);
 
+    /**
+     * Constructor for a periodic task. Tenants are run at fixed absolute deadlines, so the period doesn't drift with
+     * how long they take. If they run past the next deadline, the deadlines that were missed are skipped
+     * @param name Name of the task
+     * @param priority Zephyr priority level
+     * @param stackSize Size of the stack to allocate
+     * @param period Time between the starts of consecutive cycles of the task
+     */
+    CTask(const char* name, int priority, int stackSize, Period period);
+
     /**
      * Destructor
      */
-    ~CTask();
+    virtual ~CTask();
 
     /**
      * Initialize the necessary components for the task and starts it
@@ -39,8 +95,9 @@ public:
     /**
      * Bind a tenant to the task
      * @param tenant Tenant to bind to a task
+     * @return 0 on success, -ENOMEM if the task's tenant table is full
      */
-    void AddTenant(CTenant& tenant);
+    int AddTenant(CTenant& tenant);
 
     /**
      * @brief Run through the tenants and execute their Run method
@@ -60,22 +117,170 @@ public:
      * Get the name of the task
      * @return Name of the task
      */
-    const char *GetName()
+    const char *GetName() const
     {
         return this->name;
     };
 
+    /**
+     * Get the tenants bound to the task
+     * @return Tenants in the order they run
+     */
+    std::span<CTenant* const> GetTenants() const
+    {
+        return this->tenants.first(this->numTenants);
+    };
+
+    /**
+     * Check if the task runs at a fixed period
+     * @return True if the task was given a period, false if it sleeps between cycles
+     */
+    bool IsPeriodic() const
+    {
+        return this->periodTicks != 0;
+    };
+
+    /**
+     * Check if the task sleeps until its tenants have something to do
+     * @return True if every tenant added wait sources (see CTenant::AddWaitSources()), false if the task cycles
+     */
+    bool IsEventDriven() const
+    {
+        return this->eventDriven;
+    };
+
+    /**
+     * Get the timing of a periodic task. Read from another thread, so a snapshot may be a cycle out of date
+     * @return Timing statistics, all zero for a task that isn't periodic
+     */
+    TimingStats GetTimingStats() const;
+
+#ifdef CONFIG_F_CORE_HEALTH_MONITOR
+    /**
+     * Set the longest a single tenant run should take. Longer runs are counted as overruns
+     * @param deadlineMs Deadline in ms, 0 to not count overruns
+     */
+    void SetDeadline(uint32_t deadlineMs)
+    {
+        this->deadlineMs = deadlineMs;
+    };
+
+    /**
+     * Get the health of the task. Read from another thread, so a snapshot may be a cycle out of date
+     * @return Health of the task
+     */
+    Health GetHealth() const;
+#endif
+
+#ifdef CONFIG_F_CORE_TASK_STACK_REPORT
+    /**
+     * Measure how much of the stack the task has used. Scans the unused part of the stack, so call it every so often
+     * rather than every cycle
+     * @return Stack usage, with a peak of zero if the task hasn't started
+     */
+    StackUsage GetStackUsage();
+#endif
+
+protected:
+    /**
+     * Constructor for a task with storage provided by a derived class
+     * @param name Name of the task
+     * @param priority Zephyr priority level
+     * @param stack Stack to run the task on
+     * @param stackSize Usable size of the stack
+     * @param tenantSlots Table to keep the task's tenants in
+     * @param sleepTimeMs Time to sleep between a single cycle of the task
+     */
+    CTask(const char* name, int priority, k_thread_stack_t* stack, size_t stackSize, std::span<CTenant*> tenantSlots,
+          int sleepTimeMs);
+
+    /**
+     * Constructor for a periodic task with storage provided by a derived class
+     * @param name Name of the task
+     * @param priority Zephyr priority level
+     * @param stack Stack to run the task on
+     * @param stackSize Usable size of the stack
+     * @param tenantSlots Table to keep the task's tenants in
+     * @param period Time between the starts of consecutive cycles of the task
+     */
+    CTask(const char* name, int priority, k_thread_stack_t* stack, size_t stackSize, std::span<CTenant*> tenantSlots,
+          Period period);
 
 private:
     const char* name;
     const int priority;
     const size_t stackSize;
     const int sleepTimeMs;
-    k_tid_t taskId;
+    const uint32_t periodUs = 0;
+    int64_t periodTicks = 0;
+    k_tid_t taskId = nullptr;
     k_thread thread;
     k_thread_stack_t* stack;
+    // Only tasks without storage from a derived class allocate their stack and grow their tenant table
+    const bool dynamic;
+
+    std::span<CTenant*> tenants;
+    size_t numTenants = 0;
+    std::vector<CTenant*> dynamicTenants;
+
+    // Event driven waiting
+    CWaitSet waitSet;
+    bool eventDriven = false;
 
-    std::vector<CTenant*> tenants;
+    // Periodic timing
+    int64_t nextReleaseTicks = 0;
+    uint32_t lastReleaseCycles = 0;
+    bool skippedRelease = false;
+    uint32_t releases = 0;
+    uint32_t deadlineMisses = 0;
+    uint32_t minPeriodUs = UINT32_MAX;
+    uint32_t maxPeriodUs = 0;
+    uint32_t maxJitterUs = 0;
+    uint64_t totalJitterUs = 0;
+    uint32_t measuredPeriods = 0;
+
+#ifdef CONFIG_F_CORE_TASK_STACK_REPORT
+    size_t peakStackUsed = 0;
+#endif
+
+#ifdef CONFIG_F_CORE_HEALTH_MONITOR
+    // Written by the task, read by the health monitor
+    mutable k_spinlock healthLock;
+    uint32_t deadlineMs = 0;
+    uint32_t checkIns = 0;
+    uint32_t lastCheckInMs = 0;
+    uint32_t overruns = 0;
+    const CTenant* overrunTenant = nullptr;
+    uint32_t overrunMs = 0;
+    const CTenant* missTenant = nullptr;
+    const CTenant* runningTenant = nullptr;
+    uint32_t tenantStartMs = 0;
+    // Slowest tenant of the current cycle, blamed if the cycle misses its release
+    const CTenant* cycleSlowestTenant = nullptr;
+    uint32_t cycleSlowestMs = 0;
+
+    /**
+     * Record the start of a cycle
+     */
+    void checkIn();
+#endif
+
+    /**
+     * Run a tenant, timing it if the tenant profiler or health monitor is enabled
+     * @param tenant Tenant to run
+     */
+    void runTenant(CTenant& tenant);
+
+    /**
+     * Collect the wait sources of every tenant
+     * @return True if the task can wait on them instead of cycling
+     */
+    bool buildWaitSet();
+
+    /**
+     * Sleep until the next release of a periodic task and record its timing
+     */
+    void waitForNextRelease();
 };
 
 #endif //C_TASK_H
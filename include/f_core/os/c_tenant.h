@@ -6,6 +6,12 @@
 #ifndef C_TENANT_H
 #define C_TENANT_H
 
+#ifdef CONFIG_F_CORE_TENANT_PROFILER
+#include <f_core/os/c_tenant_profile.h>
+#endif
+
+class CWaitSet;
+
 class CTenant {
 public:
     /**
@@ -34,6 +40,13 @@ public:
      */
     virtual void Run() = 0;
 
+    /**
+     * Add what the tenant waits on to its task's wait set. If every tenant in a task adds something, the task sleeps
+     * until one of them is ready and only runs the tenants that are. Tenants that add nothing are run every cycle
+     * @param waitSet Wait set to add to
+     */
+    virtual void AddWaitSources(CWaitSet &waitSet) {};
+
     /**
      * Cleanup the tenant
      */
@@ -42,8 +55,27 @@ public:
     const char *GetName() const {
         return name;
     }
+
+#ifdef CONFIG_F_CORE_TENANT_PROFILER
+    /**
+     * Get how long the tenant's runs take. Recorded by the task running it. See CTenantProfile for what is timed
+     * @return Profile of the tenant
+     */
+    CTenantProfile &GetProfile() {
+        return profile;
+    }
+
+    const CTenantProfile &GetProfile() const {
+        return profile;
+    }
+#endif
 protected:
     const char *name;
+
+#ifdef CONFIG_F_CORE_TENANT_PROFILER
+private:
+    CTenantProfile profile;
+#endif
 };
 
 #endif //C_TENANT_H
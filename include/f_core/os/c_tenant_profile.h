@@ -0,0 +1,89 @@
+/*
+* Copyright (c) 2025 RIT Launch Initiative
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef C_TENANT_PROFILE_H
+#define C_TENANT_PROFILE_H
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+
+/**
+ * Execution time of one tenant, as sent over UDP. Multi-byte fields are little endian
+ */
+struct __attribute__((packed)) TenantProfileSnapshot {
+    static constexpr std::size_t nameSize = 24;
+    // Bucket i counts runs taking [2^i, 2^(i+1)) us, except bucket 0 also counts 0 us and the last bucket counts
+    // everything longer
+    static constexpr std::size_t durationBuckets = 20;
+
+    char task[nameSize];
+    char tenant[nameSize];
+    uint32_t calls;
+    uint32_t minUs;
+    uint32_t meanUs;
+    uint32_t maxUs;
+    uint32_t durationUs[durationBuckets];
+};
+
+/**
+ * How long each Run() of a tenant takes: call count, min/mean/max and a log2 histogram. CTask times every Run() when
+ * CONFIG_F_CORE_TENANT_PROFILER is on. With CONFIG_SCHED_THREAD_USAGE (implied by the profiler) the times are what the
+ * task's thread actually ran, leaving out time the tenant spent blocked in Run() or preempted. Without it they are wall
+ * time, so a tenant waiting on a semaphore or socket in Run() is charged for the whole wait.
+ *
+ * Only the task running the tenant records, and readers take a snapshot under the same lock.
+ */
+class CTenantProfile {
+public:
+    /**
+     * Record one run of the tenant
+     * @param cycles Cycles the run took
+     */
+    void Record(uint32_t cycles) {
+        const uint32_t us = k_cyc_to_us_floor32(cycles);
+        const std::size_t bucket = us < 2 ? 0 : 31 - __builtin_clz(us);
+
+        k_spinlock_key_t key = k_spin_lock(&lock);
+        calls++;
+        totalCycles += cycles;
+        minCycles = MIN(minCycles, cycles);
+        maxCycles = MAX(maxCycles, cycles);
+        histogram[MIN(bucket, histogram.size() - 1)]++;
+        k_spin_unlock(&lock, key);
+    }
+
+    /**
+     * Copy out the current counters. Names are left for the caller to fill in
+     * @param snapshot Snapshot to fill in
+     */
+    void GetSnapshot(TenantProfileSnapshot &snapshot) const {
+        memset(&snapshot, 0, sizeof(snapshot));
+
+        k_spinlock_key_t key = k_spin_lock(&lock);
+        snapshot.calls = calls;
+        if (calls > 0) {
+            snapshot.minUs = k_cyc_to_us_floor32(minCycles);
+            snapshot.meanUs = k_cyc_to_us_floor32(totalCycles / calls);
+            snapshot.maxUs = k_cyc_to_us_floor32(maxCycles);
+        }
+        for (std::size_t i = 0; i < histogram.size(); i++) {
+            snapshot.durationUs[i] = histogram[i];
+        }
+        k_spin_unlock(&lock, key);
+    }
+
+private:
+    mutable k_spinlock lock;
+    uint32_t calls = 0;
+    uint64_t totalCycles = 0;
+    uint32_t minCycles = UINT32_MAX;
+    uint32_t maxCycles = 0;
+    std::array<uint32_t, TenantProfileSnapshot::durationBuckets> histogram{};
+};
+
+#endif //C_TENANT_PROFILE_H
@@ -0,0 +1,146 @@
+/*
+* Copyright (c) 2025 RIT Launch Initiative
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef C_WAIT_SET_H
+#define C_WAIT_SET_H
+
+#include <f_core/messaging/c_message_port.h>
+#include <f_core/utils/c_soft_timer.h>
+
+#include <array>
+#include <cstdint>
+#include <zephyr/kernel.h>
+#ifdef CONFIG_NET_SOCKETS
+#include <zephyr/net/socket.h>
+#endif
+
+/**
+ * Everything the tenants of a task wait on: message ports, semaphores, message queues and poll signals (waited on with
+ * k_poll), sockets (zsock_poll) and timers (the wait's timeout). Tenants add to it in CTenant::AddWaitSources(), then
+ * the task blocks in Wait() and runs only the tenants it returns.
+ *
+ * k_poll can't wait on sockets, so a task with both sockets and kernel objects waits on the kernel objects and checks
+ * its sockets at least every CONFIG_F_CORE_TASK_SOCKET_POLL_MS. Keeping socket tenants in their own task avoids that.
+ */
+class CWaitSet {
+public:
+    static constexpr std::size_t maxTenants = 32;
+    static constexpr std::size_t maxSources = CONFIG_F_CORE_TASK_WAIT_SOURCES;
+
+    /**
+     * Wait for a semaphore to be available
+     * @param sem Semaphore to wait on. The tenant takes it when run, or the task won't sleep
+     * @return true on success, false if the wait set is full
+     */
+    bool AddSemaphore(k_sem &sem);
+
+    /**
+     * Wait for a message queue to have data
+     * @param queue Message queue to wait on
+     * @return true on success, false if the wait set is full
+     */
+    bool AddMessageQueue(k_msgq &queue);
+
+    /**
+     * Wait for a poll signal to be raised
+     * @param signal Signal to wait on. The tenant resets it when run, or the task won't sleep
+     * @return true on success, false if the wait set is full
+     */
+    bool AddSignal(k_poll_signal &signal);
+
+    /**
+     * Wait for a message port to have a message
+     * @param port Port to wait on
+     * @return true on success, false if the wait set is full or the port can't be waited on
+     */
+    template <typename T>
+    bool AddMessagePort(CMessagePort<T> &port) {
+#ifdef CONFIG_POLL
+        k_poll_event *event = nextEvent();
+        if (event != nullptr && port.InitPollEvent(*event)) {
+            addedEvent();
+            return true;
+        }
+#endif
+        return failed();
+    }
+
+    /**
+     * Wait for a socket to have data to read
+     * @param socket Socket to wait on
+     * @return true on success, false if the wait set is full or sockets aren't enabled
+     */
+    bool AddSocket(int socket);
+
+    /**
+     * Wait for a timer to expire. Only waits while the timer is running
+     * @param timer Timer to wait on. The tenant reads its status when run
+     * @return true on success, false if the wait set is full
+     */
+    bool AddTimer(CSoftTimer &timer);
+
+    /**
+     * Block until something is ready
+     * @return bit i set if tenant i has something ready
+     */
+    uint32_t Wait();
+
+private:
+    friend class CTask;
+
+    std::array<k_poll_event, maxSources> events;
+    std::array<uint8_t, maxSources> eventOwners;
+    std::size_t numEvents = 0;
+
+#ifdef CONFIG_NET_SOCKETS
+    std::array<zsock_pollfd, maxSources> sockets;
+    std::array<uint8_t, maxSources> socketOwners;
+    std::size_t numSockets = 0;
+#endif
+
+    std::array<CSoftTimer *, maxSources> timers;
+    std::array<int64_t, maxSources> timerDeadlines;
+    std::array<uint8_t, maxSources> timerOwners;
+    std::size_t numTimers = 0;
+
+    // Tenant whose sources are being added, and whether it has added any / failed to add one
+    uint8_t owner = 0;
+    bool ownerAdded = false;
+    bool ownerFailed = false;
+
+    /**
+     * Start adding the sources of a tenant
+     * @param index Index of the tenant in its task
+     */
+    void beginTenant(std::size_t index);
+
+    /**
+     * Finish adding the sources of a tenant
+     * @return true if the tenant added at least one source and every one was added
+     */
+    bool endTenant() const { return ownerAdded && !ownerFailed; }
+
+    /**
+     * Get the next free poll event
+     * @return the event, or nullptr if they are all used
+     */
+    k_poll_event *nextEvent() { return numEvents < maxSources ? &events[numEvents] : nullptr; }
+
+    /**
+     * Claim the event from nextEvent() for the current tenant
+     */
+    void addedEvent();
+
+    /**
+     * Record that a source couldn't be added
+     * @return false
+     */
+    bool failed() {
+        ownerFailed = true;
+        return false;
+    }
+};
+
+#endif //C_WAIT_SET_H
@@ -1,18 +1,66 @@
 #ifndef F_CORE_FLIGHT_FLIGHT_LOG_H
 #define F_CORE_FLIGHT_FLIGHT_LOG_H
+#include <cstdio>
 #include <stdint.h>
 #include <string.h>
 #include <string>
+#include <type_traits>
 #include <zephyr/fs/fs.h>
 #include <zephyr/kernel.h>
 
+namespace NFlightLog {
+/**
+ * Id of a format string in a binary flight log (32 bit FNV-1a of the string, never 0).
+ * tools/autocoders/ac_flight_log_dict.py computes the same ids when it collects the format strings at build time
+ */
+constexpr uint32_t FormatId(const char *format) {
+    uint32_t hash = 2166136261u;
+    for (; *format != '\0'; format++) {
+        hash = (hash ^ static_cast<uint8_t>(*format)) * 16777619u;
+    }
+    // 0 marks records holding plain text
+    return hash == 0 ? 1 : hash;
+}
+} // namespace NFlightLog
+
+/**
+ * A printf style format string and its id. Make these with FLIGHT_LOG_FORMAT so the id is computed at compile time and
+ * the string is picked up by the dictionary
+ */
+struct CFlightLogFormat {
+    const char *format;
+    uint32_t id;
+};
+
+#define FLIGHT_LOG_FORMAT(fmt)                                                                                         \
+    (CFlightLogFormat{fmt, std::integral_constant<uint32_t, NFlightLog::FormatId(fmt)>::value})
+
 /**
  * Write timestamped log data to a file.
  * This is *not* for high speed telemetry data (for that, see Datalogger)
  * Instead, this is a human readable file detailing major events in the flight
+ *
+ * Logs can also be written in a binary encoding (pick it per log, or for every log with
+ * CONFIG_F_CORE_FLIGHT_LOG_BINARY). Each entry is then one fs_write of a record holding the uptime, the id of its
+ * format string and its raw arguments. Nothing is formatted on the device. Plain text messages are stored as they are.
+ * Render binary logs on the host with tools/data_log_check/flight_log_decode.py and the dictionary of format strings
+ * collected at build time (see FlightLogDictionary() in cmake/Autocoders.cmake).
+ *
+ * Binary layout: the file starts with "FLGB" and a u16 version. Each record is the uptime in ms (u32), the format id
+ * (u32, 0 for plain text) and the payload length (u8), followed by the payload. Plain text payloads are the message.
+ * Formatted payloads are the arguments, each a type tag followed by its value:
+ * 'i'/'u' 32 bit integer, 'I'/'U' 64 bit integer, 'f' float, 'd' double, 's' u8 length then the characters.
  */
 class CFlightLog {
   public:
+    enum class Encoding { Text, Binary };
+
+#ifdef CONFIG_F_CORE_FLIGHT_LOG_BINARY
+    static constexpr Encoding defaultEncoding = Encoding::Binary;
+#else
+    static constexpr Encoding defaultEncoding = Encoding::Text;
+#endif
+
     /**
      * Noop constructor - allows generating filename then initializing. MAKE SURE TO CALL A REAL CONSTRUCTOR BEFORE FURTHER USE
      */
@@ -33,6 +81,12 @@ class CFlightLog {
 
     CFlightLog(const char* fname, int64_t timestamp);
 
+    /**
+   * Open a flight log with a specific encoding
+   * k_uptime_get() at time of opening is recorded as the first line of the flight log
+   */
+    CFlightLog(const char* fname, Encoding encoding);
+
     // Can't copy (would have two files with same name)
     CFlightLog(const CFlightLog&) = delete;
     CFlightLog(CFlightLog&&) = delete;
@@ -70,6 +124,43 @@ class CFlightLog {
      */
     int Write(const char* msg, size_t str_len);
 
+    /**
+     * Writes a formatted message using the k_uptime_get (millis since boot) timestamp at time of calling
+     * Text logs format it with snprintf. Binary logs store the format id and the arguments
+     * @param format the format string, made with FLIGHT_LOG_FORMAT
+     * @param args the arguments: integers, enums, floats, doubles and strings
+     */
+    template <typename... Args>
+    int Write(const CFlightLogFormat& format, Args... args) {
+        return Write(k_uptime_get(), format, args...);
+    }
+
+    /**
+     * writes a formatted message with a user provided timestamp to the flight log
+     * @param timestamp any user provided timestamp
+     * @param format the format string, made with FLIGHT_LOG_FORMAT
+     * @param args the arguments: integers, enums, floats, doubles and strings
+     */
+    template <typename... Args>
+    int Write(int64_t timestamp, const CFlightLogFormat& format, Args... args) {
+        if constexpr (sizeof...(Args) == 0) {
+            // Nothing to format, and snprintf would want a literal
+            if (encoding == Encoding::Text) {
+                return Write(timestamp, format.format, strlen(format.format));
+            }
+            return writeRecord(timestamp, format.id, "", 0);
+        } else if (encoding == Encoding::Text) {
+            char buf[textBufferSize] = {0};
+            int len = snprintf(buf, textBufferSize, format.format, textArg(args)...);
+            return Write(timestamp, buf, MIN(static_cast<size_t>(MAX(len, 0)), textBufferSize - 1));
+        }
+
+        uint8_t payload[maxPayloadSize];
+        size_t len = 0;
+        (packArg(payload, len, args), ...);
+        return writeRecord(timestamp, format.id, payload, len);
+    }
+
     /**
      * Close the underlying file (called in destructor)
      * @return the error code from the file system
@@ -83,9 +174,69 @@ class CFlightLog {
     int Sync();
 
   private:
+    static constexpr size_t textBufferSize = 128;
+    static constexpr size_t maxPayloadSize = UINT8_MAX;
+    static constexpr size_t maxStringArgSize = 64;
+
     int writeTimestamp(int64_t timestamp);
+    int writeRecord(int64_t timestamp, uint32_t id, const void* payload, size_t len);
+
+    template <typename T>
+    static auto textArg(T value) {
+        if constexpr (std::is_enum_v<T>) {
+            return static_cast<std::underlying_type_t<T>>(value);
+        } else {
+            return value;
+        }
+    }
+
+    /**
+     * Append a tagged argument to a binary payload. Arguments that don't fit are left out
+     */
+    template <typename T>
+    static void packArg(uint8_t* payload, size_t& len, T value) {
+        if constexpr (std::is_enum_v<T>) {
+            packArg(payload, len, static_cast<std::underlying_type_t<T>>(value));
+        } else if constexpr (std::is_same_v<T, const char*> || std::is_same_v<T, char*>) {
+            const size_t str_len = value == nullptr ? 0 : strnlen(value, maxStringArgSize);
+            if (len + 2 + str_len <= maxPayloadSize) {
+                payload[len++] = 's';
+                payload[len++] = str_len;
+                memcpy(&payload[len], value, str_len);
+                len += str_len;
+            }
+        } else if constexpr (std::is_same_v<T, float>) {
+            packValue(payload, len, 'f', value);
+        } else if constexpr (std::is_same_v<T, double>) {
+            packValue(payload, len, 'd', value);
+        } else if constexpr (std::is_integral_v<T> && sizeof(T) <= sizeof(int32_t)) {
+            if constexpr (std::is_signed_v<T>) {
+                packValue(payload, len, 'i', static_cast<int32_t>(value));
+            } else {
+                packValue(payload, len, 'u', static_cast<uint32_t>(value));
+            }
+        } else if constexpr (std::is_integral_v<T>) {
+            if constexpr (std::is_signed_v<T>) {
+                packValue(payload, len, 'I', static_cast<int64_t>(value));
+            } else {
+                packValue(payload, len, 'U', static_cast<uint64_t>(value));
+            }
+        } else {
+            static_assert(std::is_integral_v<T>, "Flight log arguments must be integers, enums, floats or strings");
+        }
+    }
+
+    template <typename T>
+    static void packValue(uint8_t* payload, size_t& len, char tag, T value) {
+        if (len + 1 + sizeof(T) <= maxPayloadSize) {
+            payload[len++] = tag;
+            memcpy(&payload[len], &value, sizeof(T));
+            len += sizeof(T);
+        }
+    }
 
     fs_file_t file;
+    Encoding encoding = defaultEncoding;
 };
 
 #endif
\ No newline at end of file
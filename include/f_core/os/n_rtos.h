@@ -7,13 +7,17 @@
 #define N_RTOS_H
 
 #include "f_core/os/c_task.h"
+#include "f_core/os/flight_log.hpp"
+
+#include <span>
 
 namespace NRtos {
     /**
      * Add a task to be scheduled on the RTOS
      * @param task Task to be scheduled on the RTOS
+     * @return 0 on success, -ENOMEM if CONFIG_F_CORE_RTOS_MAX_TASKS tasks were already added
      */
-    void AddTask(CTask &task);
+    int AddTask(CTask &task);
 
     /**
      * Initialize and start all tasks added to the RTOS
@@ -21,9 +25,35 @@ namespace NRtos {
     void StartRtos();
 
     /**
-     * Cleanup tasks and abort all added tasks
+     * Cleanup tasks and abort all added tasks. Logs the stack usage of every task first if
+     * CONFIG_F_CORE_TASK_STACK_REPORT is on
      */
     void StopRtos();
+
+    /**
+     * Write the timing of every periodic task to a flight log
+     * @param flightLog Flight log to write to
+     */
+    void WriteTaskTimings(CFlightLog &flightLog);
+
+    /**
+     * Get every task added to the RTOS
+     * @return Tasks in the order they were added
+     */
+    std::span<CTask* const> GetTasks();
+
+    /**
+     * Write how long every tenant's runs take to a flight log. Does nothing unless CONFIG_F_CORE_TENANT_PROFILER is on
+     * @param flightLog Flight log to write to
+     */
+    void WriteTenantProfiles(CFlightLog &flightLog);
+
+    /**
+     * Write the most stack every task has used and the size to give it to a flight log. Does nothing unless
+     * CONFIG_F_CORE_TASK_STACK_REPORT is on
+     * @param flightLog Flight log to write to
+     */
+    void WriteStackUsage(CFlightLog &flightLog);
 };
 
 
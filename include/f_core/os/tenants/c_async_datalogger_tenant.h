@@ -0,0 +1,391 @@
+#ifndef C_ASYNC_DATALOGGER_TENANT_H
+#define C_ASYNC_DATALOGGER_TENANT_H
+
+#include <array>
+#include <f_core/messaging/c_message_port.h>
+#include <f_core/os/c_datalogger.h>
+#include <f_core/os/c_tenant.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+/**
+ * Datalogger with a multi-buffered RAM front end and a dedicated writer.
+ *
+ * Producers reserve a slot directly inside one of NumBlocks preallocated blocks, fill it in place, and commit it.
+ * Once a block is full it is sealed and handed to the writer (whatever task this tenant runs in), which commits it to
+ * the filesystem while producers carry on filling the next block. Blocks are written in the order they were filled,
+ * each only once every slot reserved in it has been committed. Producers only ever wait when every block is waiting on
+ * the filesystem, and that wait is bounded by the timeout they pass in.
+ *
+ * For drop-in use with existing producers this is also a CMessagePort<T>: Send() copies the message straight into a
+ * reserved slot. Receive() is not supported since the writer is the only consumer.
+ *
+ * @tparam T the packet type to log
+ * @tparam BlockSize size of each RAM block in bytes. The flash erase block size is a good choice
+ * @tparam NumBlocks number of RAM blocks. 2 is classic double buffering; more absorbs longer filesystem stalls
+ * @tparam Logger logger the writer commits blocks to. Anything with WriteMany(), Flush() and close(), such as
+ * CDataLogger<T> or CCompressedDataLogger<T>
+ */
+template <typename T, std::size_t BlockSize, std::size_t NumBlocks = 2, typename Logger = CDataLogger<T>>
+class CAsyncDataLoggerTenant : public CTenant, public CMessagePort<T> {
+public:
+    static constexpr std::size_t RecordsPerBlock = BlockSize / sizeof(T);
+    static_assert(RecordsPerBlock > 0, "BlockSize must fit at least one record");
+    static_assert(NumBlocks >= 2, "Need at least two blocks so producers can fill one while the other is written");
+
+    /**
+     * Counters for tuning the number and size of blocks
+     */
+    struct Stats {
+        uint32_t recordsWritten; //< records committed to the filesystem
+        uint32_t blocksWritten;  //< blocks (full or partial) committed to the filesystem
+        uint32_t drops;          //< reservations that failed because no block was free in time
+        uint32_t maxSwapWaitUs;  //< worst time a producer spent waiting for a free block
+    };
+
+    /**
+     * Constructor
+     * @param name Name of the tenant
+     * @param filename File to log to
+     * @param mode Logging mode to use
+     * @param num_packets Number of packets to log (only used if mode is Circular or FixedSize)
+     * @param flushIntervalMs Longest time a partially filled block may wait before being written. 0 waits for full blocks
+     */
+    CAsyncDataLoggerTenant(const char *name, const char *filename, LogMode mode, std::size_t num_packets,
+                           uint32_t flushIntervalMs = 0)
+        : CTenant(name), dataLogger(filename, mode, num_packets), flushIntervalMs(flushIntervalMs) {
+        // Block 0 starts out as the active block
+        k_sem_init(&freeBlocks, NumBlocks - 1, NumBlocks);
+        k_sem_init(&fullBlocks, 0, NumBlocks);
+        k_mutex_init(&writeLock);
+    }
+
+    /**
+     * Constructor for loggers that only take a filename (e.g. a Growing CDataLogger or a CCompressedDataLogger)
+     * @param name Name of the tenant
+     * @param filename File to log to
+     * @param flushIntervalMs Longest time a partially filled block may wait before being written. 0 waits for full blocks
+     * @param indexed Keep a sparse time index next to the log
+     */
+    CAsyncDataLoggerTenant(const char *name, const char *filename, uint32_t flushIntervalMs = 0, bool indexed = false)
+        : CTenant(name), dataLogger(filename, 0, indexed), flushIntervalMs(flushIntervalMs) {
+        k_sem_init(&freeBlocks, NumBlocks - 1, NumBlocks);
+        k_sem_init(&fullBlocks, 0, NumBlocks);
+        k_mutex_init(&writeLock);
+    }
+
+    ~CAsyncDataLoggerTenant() override {
+        Cleanup();
+    }
+
+    /**
+     * Reserve a slot for a record in the active block. The slot must be handed back with Commit()
+     * @param timeout Time to wait for a free block if the active one is full
+     * @return Slot to construct the record in, or nullptr if no block became free in time (counted as a drop)
+     */
+    T *TryReserve(const k_timeout_t timeout = K_NO_WAIT) {
+        T *slot = reserve(timeout, k_uptime_get_32());
+        if (slot == nullptr) {
+            k_spinlock_key_t key = k_spin_lock(&lock);
+            stats.drops++;
+            k_spin_unlock(&lock, key);
+        }
+        return slot;
+    }
+
+
+    /**
+     * Hand a reserved slot back once the record has been filled in
+     * @param slot Slot returned by TryReserve()
+     */
+    void Commit(T *slot) {
+        Block &block = blocks[blockIndexOf(slot)];
+
+        k_spinlock_key_t key = k_spin_lock(&lock);
+        block.committed++;
+        bool ready = isReady(block);
+        k_spin_unlock(&lock, key);
+
+        if (ready) {
+            k_sem_give(&fullBlocks);
+        }
+    }
+
+    /**
+     * Copy a message into the log
+     * @param message Message to log
+     * @param timeout Time to wait for a free block if the active one is full
+     * @return 0 on success, -ENOMSG if the message was dropped
+     */
+    int Send(const T &message, const k_timeout_t timeout = K_NO_WAIT) override {
+        T *slot = TryReserve(timeout);
+        if (slot == nullptr) {
+            return -ENOMSG;
+        }
+
+        *slot = message;
+        Commit(slot);
+        return 0;
+    }
+
+    /**
+     * Copy a message into the log if a slot is free right now. The sender keeps the message to offer again, so a
+     * refusal isn't counted as a drop
+     * @param message Message to log
+     * @param sentMs Uptime the message was first sent at, passed on to loggers that take one
+     * @return 0 on success, -ENOMSG if there was no free slot
+     */
+    int TrySend(const T &message, uint32_t sentMs) override {
+        T *slot = reserve(K_NO_WAIT, sentMs);
+        if (slot == nullptr) {
+            return -ENOMSG;
+        }
+
+        *slot = message;
+        Commit(slot);
+        return 0;
+    }
+
+    /**
+     * Not supported. The writer is the only consumer of logged messages
+     * @return -ENOTSUP
+     */
+    int Receive(T &message, const k_timeout_t timeout = K_NO_WAIT) override {
+        return -ENOTSUP;
+    }
+
+    /**
+     * Not supported. Staged records are already owned by the writer
+     */
+    void Clear() override {}
+
+    /**
+     * Get a snapshot of the logger's counters
+     * @return Counters since construction
+     */
+    Stats GetStats() {
+        k_spinlock_key_t key = k_spin_lock(&lock);
+        Stats snapshot = stats;
+        k_spin_unlock(&lock, key);
+        return snapshot;
+    }
+
+    /**
+     * Write out the blocks that are ready, or seal a partially filled block if none fills up within the flush interval
+     */
+    void Run() override {
+        const k_timeout_t timeout = flushIntervalMs > 0 ? K_MSEC(flushIntervalMs) : K_FOREVER;
+
+        if (k_sem_take(&fullBlocks, timeout) != 0) {
+            // Nothing filled up in time. Seal what has been staged so it goes out on the next pass
+            sealPartialBlock();
+            return;
+        }
+
+        k_mutex_lock(&writeLock, K_FOREVER);
+        if (!closed) {
+            writeReadyBlocks();
+        }
+        k_mutex_unlock(&writeLock);
+    }
+
+    /**
+     * Write out everything staged so far and close the file. Safe to call more than once, and while the writer is
+     * still running: the writer finishes the block it is on and writes nothing after this
+     */
+    void Cleanup() override {
+        LOG_MODULE_DECLARE(datalogger);
+
+        k_mutex_lock(&writeLock, K_FOREVER);
+        if (closed) {
+            k_mutex_unlock(&writeLock);
+            return;
+        }
+        closed = true;
+
+        sealPartialBlock();
+        writeReadyBlocks();
+        dataLogger.close();
+        k_mutex_unlock(&writeLock);
+
+        const Stats finalStats = GetStats();
+        LOG_INF("%s: %u records in %u blocks, %u dropped, %u us worst swap wait", name, finalStats.recordsWritten,
+                finalStats.blocksWritten, finalStats.drops, finalStats.maxSwapWaitUs);
+    }
+
+private:
+    static constexpr int noActiveBlock = -1;
+
+    static constexpr bool stampsRecords = requires(Logger &logger, const T *packets, const uint32_t *uptimesMs) {
+        logger.WriteMany(packets, uptimesMs, std::size_t{});
+    };
+
+    struct Block {
+        std::array<T, RecordsPerBlock> records;
+        // Uptime each slot was reserved at, so the index isn't stamped with when the writer got around to the block
+        std::array<uint32_t, stampsRecords ? RecordsPerBlock : 0> sentMs;
+        std::size_t reserved = 0;  //< slots handed out to producers
+        std::size_t committed = 0; //< slots producers have finished filling
+        bool sealed = false;       //< no more slots will be handed out from this block
+    };
+
+    Logger dataLogger;
+    const uint32_t flushIntervalMs;
+
+    std::array<Block, NumBlocks> blocks;
+    k_spinlock lock{};
+    int activeBlock = 0;         //< block producers are filling, or noActiveBlock while waiting on the writer
+    std::size_t nextBlock = 1;   //< block to activate next. Blocks are filled and written in ring order
+    std::size_t writeBlock = 0;  //< next block the writer will commit
+    k_sem freeBlocks;
+    k_sem fullBlocks; //< given each time a block becomes ready. The writer checks which, so extra gives are harmless
+    k_mutex writeLock; //< held while writing blocks, so Cleanup() never writes alongside the writer
+    bool closed = false;
+    Stats stats{};
+
+    /**
+     * Reserve a slot like TryReserve(), without counting a failure as a drop
+     * @param sentMs Uptime to write the record with, for loggers that take one
+     * @return Slot to construct the record in, or nullptr if no block became free in time
+     */
+    T *reserve(const k_timeout_t timeout, uint32_t sentMs) {
+        k_spinlock_key_t key = k_spin_lock(&lock);
+        while (activeBlock == noActiveBlock) {
+            k_spin_unlock(&lock, key);
+            if (!swapInNextBlock(timeout)) {
+                return nullptr;
+            }
+            key = k_spin_lock(&lock);
+        }
+
+        Block &block = blocks[activeBlock];
+        if constexpr (stampsRecords) {
+            block.sentMs[block.reserved] = sentMs;
+        }
+        T *slot = &block.records[block.reserved++];
+        bool ready = false;
+        if (block.reserved == RecordsPerBlock) {
+            ready = sealActiveBlock();
+        }
+        k_spin_unlock(&lock, key);
+
+        if (ready) {
+            k_sem_give(&fullBlocks);
+        }
+        return slot;
+    }
+
+    /**
+     * Seal the active block. Must be called with the lock held
+     * @return true if the block is ready to be written (the caller should give fullBlocks after unlocking)
+     */
+    bool sealActiveBlock() {
+        Block &block = blocks[activeBlock];
+        block.sealed = true;
+        activeBlock = noActiveBlock;
+        return isReady(block);
+    }
+
+    /**
+     * Check if a block can be written. Must be called with the lock held
+     * @return true if the block is sealed and every slot handed out from it has been committed
+     */
+    static bool isReady(const Block &block) {
+        return block.sealed && block.committed == block.reserved;
+    }
+
+    /**
+     * Wait for the writer to free a block and make it the active one
+     * @return false if no block was freed in time
+     */
+    bool swapInNextBlock(const k_timeout_t timeout) {
+        const uint32_t start = k_cycle_get_32();
+        if (k_sem_take(&freeBlocks, timeout) != 0) {
+            return false;
+        }
+        const uint32_t waitedUs = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+
+        k_spinlock_key_t key = k_spin_lock(&lock);
+        bool alreadySwapped = activeBlock != noActiveBlock;
+        if (!alreadySwapped) {
+            activeBlock = nextBlock;
+            nextBlock = (nextBlock + 1) % NumBlocks;
+        }
+        if (waitedUs > stats.maxSwapWaitUs) {
+            stats.maxSwapWaitUs = waitedUs;
+        }
+        k_spin_unlock(&lock, key);
+
+        if (alreadySwapped) {
+            // Another producer beat us to it. Leave the block we took for the next swap
+            k_sem_give(&freeBlocks);
+        }
+        return true;
+    }
+
+    void sealPartialBlock() {
+        k_spinlock_key_t key = k_spin_lock(&lock);
+        bool ready = false;
+        if (activeBlock != noActiveBlock && blocks[activeBlock].reserved > 0) {
+            ready = sealActiveBlock();
+        }
+        k_spin_unlock(&lock, key);
+
+        if (ready) {
+            k_sem_give(&fullBlocks);
+        }
+    }
+
+    /**
+     * Write blocks in ring order until reaching one that isn't ready. With several producers a later block can become
+     * ready first, so it waits for the ones before it. Must be called with writeLock held
+     */
+    void writeReadyBlocks() {
+        while (true) {
+            k_spinlock_key_t key = k_spin_lock(&lock);
+            const bool ready = isReady(blocks[writeBlock]);
+            k_spin_unlock(&lock, key);
+
+            if (!ready) {
+                return;
+            }
+            writeNextBlock();
+        }
+    }
+
+    void writeNextBlock() {
+        Block &block = blocks[writeBlock];
+        if constexpr (stampsRecords) {
+            dataLogger.WriteMany(block.records.data(), block.sentMs.data(), block.committed);
+        } else {
+            dataLogger.WriteMany(block.records.data(), block.committed);
+        }
+        if (block.committed < RecordsPerBlock) {
+            // Partial blocks only get written because of the flush interval, so make sure they reach the disk
+            dataLogger.Flush();
+        }
+
+        k_spinlock_key_t key = k_spin_lock(&lock);
+        stats.recordsWritten += block.committed;
+        stats.blocksWritten++;
+        block.reserved = 0;
+        block.committed = 0;
+        block.sealed = false;
+        k_spin_unlock(&lock, key);
+
+        writeBlock = (writeBlock + 1) % NumBlocks;
+        k_sem_give(&freeBlocks);
+    }
+
+    std::size_t blockIndexOf(const T *slot) const {
+        for (std::size_t i = 0; i < NumBlocks; i++) {
+            if (slot >= blocks[i].records.data() && slot < blocks[i].records.data() + RecordsPerBlock) {
+                return i;
+            }
+        }
+        k_oops();
+        return 0;
+    }
+};
+
+#endif //C_ASYNC_DATALOGGER_TENANT_H
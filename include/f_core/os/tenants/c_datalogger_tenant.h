@@ -4,21 +4,85 @@
 #include <f_core/messaging/c_message_port.h>
 #include <f_core/os/c_tenant.h>
 #include <f_core/os/c_datalogger.h>
+#include <array>
 #include <zephyr/logging/log.h>
 
-template <typename T>
+/**
+ * Tenant that writes every packet it receives to a datalogger
+ * Each pass drains everything waiting on the message port (up to BatchSize packets) and logs it in one WriteMany().
+ * Loggers that take a time per packet get the time each packet was sent, so a backed up queue doesn't squash the
+ * timestamps (or the index of an indexed log) together. Loggers that number their records (CFramedDataLogger) are also
+ * told about packets the message port dropped
+ * @tparam T the packet type to log
+ * @tparam BlockSize size of the CDataLogger write-back staging buffer (only used with the default Logger)
+ * @tparam Logger logger packets are written to. Anything with WriteMany(), Flush(), MsUntilFlush() and close(), such as
+ * CDataLogger<T>, CFramedDataLogger<T> or CLogStream<T>
+ * @tparam BatchSize most packets taken off the message port at once
+ */
+template <typename T, std::size_t BlockSize = 0, typename Logger = CDataLogger<T, BlockSize>, std::size_t BatchSize = 8>
 class CDataLoggerTenant : public CTenant {
 public:
-    CDataLoggerTenant(const char *name, const char *filename, LogMode mode, std::size_t num_packets, CMessagePort<T> &messagePort)
-        : CTenant(name), messagePort(messagePort), dataLogger(filename, mode, num_packets), filename(filename) {}
+    /**
+     * Constructor
+     * @param name Name of the tenant
+     * @param filename File to log to
+     * @param mode Logging mode to use
+     * @param num_packets Number of packets to log (only used if mode is Circular or FixedSize)
+     * @param messagePort Message port to receive packets to log from
+     * @param flushIntervalMs Longest time staged packets may wait before being flushed (only used if BlockSize > 0)
+     */
+    CDataLoggerTenant(const char *name, const char *filename, LogMode mode, std::size_t num_packets, CMessagePort<T> &messagePort,
+                      uint32_t flushIntervalMs = 0)
+        : CTenant(name), messagePort(messagePort), dataLogger(filename, mode, num_packets, flushIntervalMs), filename(filename) {}
+
+    /**
+     * Constructor for loggers that only take a filename (e.g. a Growing CDataLogger or a CFramedDataLogger)
+     * @param name Name of the tenant
+     * @param filename File to log to
+     * @param messagePort Message port to receive packets to log from
+     * @param flushIntervalMs Longest time staged packets may wait before being flushed
+     * @param indexed Keep a sparse time index next to the log
+     */
+    CDataLoggerTenant(const char *name, const char *filename, CMessagePort<T> &messagePort, uint32_t flushIntervalMs = 0,
+                      bool indexed = false)
+        : CTenant(name), messagePort(messagePort), dataLogger(filename, flushIntervalMs, indexed), filename(filename) {}
+
+    /**
+     * Constructor for loggers made elsewhere, such as a CLogStream of a CMultiStreamLogger shared with other tenants
+     * @param name Name of the tenant
+     * @param logger Logger to write packets to
+     * @param messagePort Message port to receive packets to log from
+     */
+    CDataLoggerTenant(const char *name, const Logger &logger, CMessagePort<T> &messagePort)
+        : CTenant(name), messagePort(messagePort), dataLogger(logger), filename(nullptr) {}
 
     ~CDataLoggerTenant() override {
         Cleanup();
     }
 
     void Run() override {
-        if (T message{}; messagePort.Receive(message, K_FOREVER) == 0) {
-            dataLogger.write(message);
+        // Wake up in time to flush staged packets even if no new ones arrive
+        const int64_t msUntilFlush = dataLogger.MsUntilFlush();
+        const k_timeout_t timeout = msUntilFlush < 0 ? K_FOREVER : K_MSEC(msUntilFlush);
+
+        int received = 0;
+        if constexpr (stampsRecords) {
+            received = messagePort.ReceiveManyStamped(batch, sentMs, timeout);
+        } else {
+            received = messagePort.ReceiveMany(batch, timeout);
+        }
+        if constexpr (numbersRecords) {
+            noteDropped();
+        }
+
+        if (received > 0) {
+            if constexpr (stampsRecords) {
+                dataLogger.WriteMany(batch.data(), sentMs.data(), received);
+            } else {
+                dataLogger.WriteMany(batch.data(), received);
+            }
+        } else if (msUntilFlush >= 0) {
+            dataLogger.Flush();
         }
     }
 
@@ -27,9 +91,28 @@ public:
     }
 
 private:
+    static constexpr bool stampsRecords = requires(Logger &logger, const T *packets, const uint32_t *uptimesMs) {
+        logger.WriteMany(packets, uptimesMs, std::size_t{});
+    };
+    static constexpr bool numbersRecords = requires(Logger &logger) { logger.NoteDropped(uint32_t{}); };
+
     CMessagePort<T> &messagePort;
-    CDataLogger<T> dataLogger;
+    Logger dataLogger;
     const char *filename;
+    std::array<T, BatchSize> batch;
+    std::array<uint32_t, stampsRecords ? BatchSize : 0> sentMs;
+    uint32_t lastDropped = 0;
+
+    /**
+     * Pass on packets the message port dropped since the last check, so they show up as a gap in the sequence numbers
+     */
+    void noteDropped() {
+        const uint32_t dropped = messagePort.GetDropped();
+        if (dropped != lastDropped) {
+            dataLogger.NoteDropped(dropped - lastDropped);
+            lastDropped = dropped;
+        }
+    }
 };
 
 #endif //C_DATALOGGER_TENANT_H
@@ -0,0 +1,166 @@
+/*
+* Copyright (c) 2025 RIT Launch Initiative
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef C_HEALTH_MONITOR_TENANT_H
+#define C_HEALTH_MONITOR_TENANT_H
+
+#include <f_core/os/c_task.h>
+#include <f_core/os/c_tenant.h>
+#include <f_core/os/flight_log.hpp>
+#include <f_core/utils/c_soft_timer.h>
+
+#include <array>
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+
+/**
+ * Tenant that watches other tasks for tenants that hang, overrun their deadline or make a periodic task miss its
+ * release, and writes what it finds to the flight log with the name of the tenant at fault. With CONFIG_WATCHDOG and
+ * a watchdog device, it only feeds the watchdog while every critical task is healthy, so a hung critical task resets
+ * the board.
+ *
+ * A watched task is unhealthy while one of its tenants has been running longer than the task's deadline, or while a
+ * task that doesn't wait on events has gone two deadlines without starting a cycle. Overruns and deadline misses are
+ * logged and counted, but don't make a task unhealthy on their own.
+ *
+ * Run times are wall time from when a tenant's Run() starts, so time a tenant spends blocked waiting inside Run()
+ * counts against the deadline. Give tasks whose tenants wait in Run() a deadline above their longest wait.
+ *
+ * Flight log entries are written from the system work queue, like the phase controller's, so the two never write the
+ * log at once. Put the monitor in a task of its own, since it can only check as often as its task runs.
+ */
+class CHealthMonitorTenant : public CTenant {
+public:
+    /**
+     * Counters kept for each watched task
+     */
+    struct Counters {
+        uint32_t stalls;         //< Times a tenant ran longer than the deadline without finishing
+        uint32_t missedCheckIns; //< Times the task went two deadlines without starting a cycle
+        uint32_t overruns;       //< Tenant runs that finished, but took longer than the deadline
+        uint32_t deadlineMisses; //< Releases a periodic task missed
+        bool healthy;            //< Whether the task is healthy now
+    };
+
+    /**
+     * Constructor
+     * @param name Name of the tenant
+     * @param flightLog Flight log to write to, or nullptr to only log through Zephyr logging
+     * @param checkIntervalMs Time between checks
+     * @param watchdog Watchdog to feed while every critical task is healthy, or nullptr for none
+     * @param watchdogTimeoutMs Time without a feed before the watchdog resets the board
+     */
+    explicit CHealthMonitorTenant(const char* name, CFlightLog* flightLog, uint32_t checkIntervalMs = 100,
+                                  const device* watchdog = nullptr, uint32_t watchdogTimeoutMs = 1000);
+
+    /**
+     * Watch a task. Must be called before the RTOS starts
+     * @param task Task to watch
+     * @param deadlineMs Longest one of the task's tenant runs should take, including any time it waits inside Run(). 0
+     * uses the period of a periodic task
+     * @param critical Whether the watchdog should stop being fed while the task is unhealthy
+     * @return 0 on success, -ENOMEM if every slot is taken, -EINVAL if there is no deadline to use
+     */
+    int Watch(CTask& task, uint32_t deadlineMs = 0, bool critical = true);
+
+    /**
+     * Get the counters of a watched task. Read from another thread, so a snapshot may be a check out of date
+     * @param task Task to get the counters of
+     * @return Counters of the task, all zero if it isn't watched
+     */
+    Counters GetCounters(const CTask& task) const;
+
+    /**
+     * Check if every critical task is healthy
+     * @return True if every critical task was healthy at the last check
+     */
+    bool IsHealthy() const
+    {
+        return healthy;
+    }
+
+    /**
+     * See parent docs
+     */
+    void Startup() override;
+
+    /**
+     * See parent docs
+     */
+    void AddWaitSources(CWaitSet& waitSet) override;
+
+    /**
+     * See parent docs
+     */
+    void Run() override;
+
+private:
+    struct WatchedTask {
+        CTask* task;
+        uint32_t deadlineMs;
+        bool critical;
+        bool stalled;
+        bool missedCheckIn;
+        uint32_t lastOverruns;
+        uint32_t lastDeadlineMisses;
+        Counters counters;
+    };
+
+    enum class Problem : uint8_t {
+        Stall,
+        MissedCheckIn,
+        Recovered,
+        Overrun,
+        DeadlineMiss,
+    };
+
+    struct Report {
+        int64_t timestamp;
+        Problem problem;
+        const char* task;
+        const char* tenant;
+        uint32_t ms;
+        uint32_t count;
+    };
+
+    static constexpr std::size_t reportQueueLength = 8;
+
+    CFlightLog* flightLog;
+    const uint32_t checkIntervalMs;
+    CSoftTimer timer;
+    std::array<WatchedTask, CONFIG_F_CORE_RTOS_MAX_TASKS> watched{};
+    std::size_t numWatched = 0;
+    bool healthy = true;
+
+    const device* watchdog;
+    const uint32_t watchdogTimeoutMs;
+    int watchdogChannel = -1;
+
+    // Reports waiting for the system work queue to write them
+    k_msgq reports;
+    char reportBuffer[reportQueueLength * sizeof(Report)] __aligned(alignof(Report));
+    k_work reportWork;
+
+    /**
+     * Check one watched task, reporting any change
+     * @param watchedTask Task to check
+     * @return True if the task is healthy
+     */
+    bool check(WatchedTask& watchedTask);
+
+    /**
+     * Queue a report for the system work queue to write
+     * @param report Report to queue
+     */
+    void report(const Report& report);
+
+    /**
+     * Write queued reports. Runs on the system work queue
+     * @param work Work item of the monitor
+     */
+    static void writeReports(k_work* work);
+};
+
+#endif //C_HEALTH_MONITOR_TENANT_H
@@ -0,0 +1,273 @@
+#ifndef C_FLAT_MAP_H
+#define C_FLAT_MAP_H
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <zephyr/kernel.h>
+
+/**
+ * Default hash for CFlatMap. Mixes integer and enum keys with the MurmurHash3 finalizer, so consecutive keys such as
+ * ports spread across the table, and can be evaluated at compile time
+ * @tparam KeyType Type for the key
+ */
+template <typename KeyType>
+struct CFlatMapHash {
+    static_assert(std::is_integral_v<KeyType> || std::is_enum_v<KeyType>,
+                  "CFlatMapHash only hashes integer and enum keys. Pass a hash for other key types");
+
+    constexpr uint32_t operator()(const KeyType& key) const {
+        const uint64_t wide = static_cast<uint64_t>(key);
+        uint32_t hash = static_cast<uint32_t>(wide ^ (wide >> 32));
+        hash ^= hash >> 16;
+        hash *= 0x85EBCA6B;
+        hash ^= hash >> 13;
+        hash *= 0xC2B2AE35;
+        hash ^= hash >> 16;
+        return hash;
+    }
+};
+
+/**
+ * Fixed capacity map using open addressing with linear probing, for use in place of CHashMap. Entries are kept packed
+ * together in one array inside the object, with a small table of indices into it to probe. Nothing is allocated on
+ * insert, iterating only touches the entries in use, and a map of known keys can be built at compile time.
+ *
+ * Inserting into a full map fails instead of allocating, so unlike CHashMap it doesn't need to know which thread is
+ * inserting. Removing a key moves the last entry into its place, so iteration order isn't stable across removals.
+ *
+ * @tparam KeyType Type for the key
+ * @tparam ValueType Type for the value
+ * @tparam Capacity Most entries the map can hold
+ * @tparam Hash Hash for the key, with its low bits well mixed. Must be default constructible
+ */
+template <typename KeyType, typename ValueType, std::size_t Capacity, typename Hash = CFlatMapHash<KeyType>>
+class CFlatMap {
+    // A third of the slots stay empty at capacity, so probes for missing keys end quickly
+    static constexpr std::size_t slotCount = std::bit_ceil(Capacity + (Capacity + 1) / 2);
+    static constexpr std::size_t slotMask = slotCount - 1;
+
+    using Index = std::conditional_t<(Capacity < UINT8_MAX), uint8_t, uint16_t>;
+    static_assert(Capacity < UINT16_MAX, "CFlatMap is meant for small maps");
+    static constexpr Index emptySlot = std::numeric_limits<Index>::max();
+
+    struct Entry {
+        KeyType key{};
+        ValueType value{};
+    };
+
+    template <typename EntryType>
+    class Iterator {
+    public:
+        using value_type = std::pair<const KeyType&, std::conditional_t<std::is_const_v<EntryType>, const ValueType&,
+                                                                        ValueType&>>;
+
+        constexpr explicit Iterator(EntryType* entry) : entry(entry) {}
+
+        constexpr value_type operator*() const {
+            return {entry->key, entry->value};
+        }
+
+        constexpr Iterator& operator++() {
+            entry++;
+            return *this;
+        }
+
+        constexpr bool operator==(const Iterator& other) const { return entry == other.entry; }
+
+    private:
+        EntryType* entry;
+    };
+
+public:
+    using iterator = Iterator<Entry>;
+    using const_iterator = Iterator<const Entry>;
+
+    constexpr CFlatMap() {
+        slots.fill(emptySlot);
+    }
+
+    /**
+     * Constructor for a map of known keys, all starting with the same value. In a constant expression, keys that
+     * repeat fail to compile
+     * @param keys Keys to insert
+     * @param value Value to give every key
+     */
+    template <std::size_t NumKeys>
+    constexpr CFlatMap(const std::array<KeyType, NumKeys>& keys, const ValueType& value) : CFlatMap() {
+        static_assert(NumKeys <= Capacity, "More keys than the map can hold");
+        for (const KeyType& key : keys) {
+            if (!Insert(key, value)) {
+                repeatedKey();
+            }
+        }
+    }
+
+    /**
+     * Insert a new key
+     * @param key Key to insert
+     * @param value Value of the key
+     * @return True on success, false if the key already exists or the map is full
+     */
+    constexpr bool Insert(const KeyType& key, const ValueType& value) {
+        const std::size_t slot = find(key);
+        if (slots[slot] != emptySlot || size == Capacity) {
+            return false;
+        }
+
+        entries[size] = {key, value};
+        slots[slot] = static_cast<Index>(size);
+        size++;
+        return true;
+    }
+
+    /**
+     * Change the value of an existing key
+     * @param key Key to change
+     * @param value New value of the key
+     * @return True on success, false if the key doesn't exist
+     */
+    constexpr bool Set(const KeyType& key, const ValueType& value) {
+        const Index index = slots[find(key)];
+        if (index == emptySlot) {
+            return false;
+        }
+
+        entries[index].value = value;
+        return true;
+    }
+
+    /**
+     * Remove a key. Slots after it in its probe sequence are shifted back, so no tombstones are left to slow down
+     * later lookups
+     * @param key Key to remove
+     * @return True if the key was removed, false if it doesn't exist
+     */
+    constexpr bool Remove(const KeyType& key) {
+        std::size_t hole = find(key);
+        const Index removed = slots[hole];
+        if (removed == emptySlot) {
+            return false;
+        }
+
+        for (std::size_t next = (hole + 1) & slotMask; slots[next] != emptySlot; next = (next + 1) & slotMask) {
+            // A slot can only fill the hole if the hole lies between its key's home slot and where it is now
+            const std::size_t home = homeSlot(entries[slots[next]].key);
+            if (((next - home) & slotMask) >= ((next - hole) & slotMask)) {
+                slots[hole] = slots[next];
+                hole = next;
+            }
+        }
+        slots[hole] = emptySlot;
+
+        // Keep the entries packed by moving the last one into the gap
+        const std::size_t last = size - 1;
+        if (removed != last) {
+            slots[find(entries[last].key)] = removed;
+            entries[removed] = entries[last];
+        }
+        entries[last] = Entry{};
+        size--;
+        return true;
+    }
+
+    /**
+     * Get the value of a key
+     * @param key Key to look up
+     * @return Value of the key, or nullopt if it doesn't exist
+     */
+    constexpr std::optional<ValueType> Get(const KeyType& key) const {
+        const Index index = slots[find(key)];
+        if (index == emptySlot) {
+            return std::nullopt;
+        }
+
+        return entries[index].value;
+    }
+
+    /**
+     * Check if a key exists
+     * @param key Key to look up
+     * @return True if the key exists
+     */
+    constexpr bool Contains(const KeyType& key) const {
+        return slots[find(key)] != emptySlot;
+    }
+
+    [[nodiscard]] constexpr std::size_t Size() const {
+        return size;
+    }
+
+    [[nodiscard]] static constexpr std::size_t MaxSize() {
+        return Capacity;
+    }
+
+    constexpr iterator begin() {
+        return iterator(entries.data());
+    }
+
+    constexpr iterator end() {
+        return iterator(entries.data() + size);
+    }
+
+    constexpr const_iterator begin() const {
+        return const_iterator(entries.data());
+    }
+
+    constexpr const_iterator end() const {
+        return const_iterator(entries.data() + size);
+    }
+
+    /**
+     * Get the value of an existing key. The key must exist
+     * @param key Key to look up
+     * @return Value of the key
+     */
+    constexpr ValueType& operator[](const KeyType& key) {
+        const Index index = slots[find(key)];
+        if (index == emptySlot) {
+            printk("Attempted to access a key that does not exist in the flat map"); // LOG doesn't work well in templates
+            k_oops();
+        }
+
+        return entries[index].value;
+    }
+
+private:
+    std::array<Entry, Capacity> entries{};
+    std::array<Index, slotCount> slots{};
+    std::size_t size = 0;
+
+    static constexpr std::size_t homeSlot(const KeyType& key) {
+        return Hash{}(key) & slotMask;
+    }
+
+    /**
+     * Find the slot indexing a key, or the empty slot it would go in. There is always an empty slot, since the table
+     * is bigger than the capacity
+     * @param key Key to look for
+     * @return Index of the slot
+     */
+    constexpr std::size_t find(const KeyType& key) const {
+        std::size_t slot = homeSlot(key);
+        while (slots[slot] != emptySlot && !(entries[slots[slot]].key == key)) {
+            slot = (slot + 1) & slotMask;
+        }
+
+        return slot;
+    }
+
+    /**
+     * Not constexpr, so calling it while building a map at compile time is a compile error
+     */
+    static void repeatedKey() {
+        printk("Repeated key in flat map key set"); // LOG doesn't work well in templates
+        k_oops();
+    }
+};
+
+#endif //C_FLAT_MAP_H
@@ -54,6 +54,14 @@ public:
         return k_timer_remaining_ticks(&timer);
     }
 
+    /**
+    * Get the uptime in ticks the timer next expires at
+    * @return Uptime in ticks of the next expiry
+    */
+    int64_t GetExpiryTicks() const {
+        return k_timer_expires_ticks(&timer);
+    }
+
     /**
     * Get the remaining milliseconds until the timer expires
     * @return Remaining milliseconds
@@ -0,0 +1,23 @@
+#include "f_core/net/application/c_message_port_stats_tenant.h"
+#include "f_core/messaging/c_message_port_stats.h"
+#include "f_core/os/c_wait_set.h"
+
+void CMessagePortStatsTenant::Startup() {
+    timer.StartTimer(periodMs);
+}
+
+void CMessagePortStatsTenant::AddWaitSources(CWaitSet& waitSet) {
+    waitSet.AddTimer(timer);
+}
+
+void CMessagePortStatsTenant::Run() {
+    if (!timer.IsExpired()) {
+        return;
+    }
+
+    CMessagePortStats::ForEach([this](const CMessagePortStats& stats) {
+        MessagePortStatsSnapshot snapshot{};
+        stats.GetSnapshot(snapshot);
+        udp.TransmitAsynchronous(&snapshot, sizeof(snapshot));
+    });
+}
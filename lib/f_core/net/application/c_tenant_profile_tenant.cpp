@@ -0,0 +1,29 @@
+#include "f_core/net/application/c_tenant_profile_tenant.h"
+#include "f_core/os/c_wait_set.h"
+#include "f_core/os/n_rtos.h"
+
+void CTenantProfileTenant::Startup() {
+    timer.StartTimer(periodMs);
+}
+
+void CTenantProfileTenant::AddWaitSources(CWaitSet& waitSet) {
+    waitSet.AddTimer(timer);
+}
+
+void CTenantProfileTenant::Run() {
+    if (!timer.IsExpired()) {
+        return;
+    }
+
+#ifdef CONFIG_F_CORE_TENANT_PROFILER
+    for (const CTask* task : NRtos::GetTasks()) {
+        for (const CTenant* tenant : task->GetTenants()) {
+            TenantProfileSnapshot snapshot{};
+            tenant->GetProfile().GetSnapshot(snapshot);
+            strncpy(snapshot.task, task->GetName(), sizeof(snapshot.task));
+            strncpy(snapshot.tenant, tenant->GetName(), sizeof(snapshot.tenant));
+            udp.TransmitAsynchronous(&snapshot, sizeof(snapshot));
+        }
+    }
+#endif
+}
@@ -1,7 +1,13 @@
 #include "f_core/net/application/c_tftp_server_tenant.h"
 #include "f_core/os/c_file.h"
+#include "f_core/os/c_wait_set.h"
+#ifdef CONFIG_F_CORE_OS
+#include "f_core/os/c_datalogger.h"
+#endif
 
+#include <cctype>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <zephyr/fs/fs.h>
 #include <zephyr/kernel.h>
@@ -25,6 +31,10 @@ void CTftpServerTenant::Startup() {
 void CTftpServerTenant::Cleanup() {
 }
 
+void CTftpServerTenant::AddWaitSources(CWaitSet &waitSet) {
+    waitSet.AddSocket(sock.GetSocket());
+}
+
 void CTftpServerTenant::Run() {
     sockaddr srcAddr = {0};
     socklen_t srcAddrLen = sizeof(srcAddr);
@@ -114,15 +124,30 @@ void CTftpServerTenant::handleReadRequest(const sockaddr &clientAddr, const uint
     LOG_INF("Received read request for %s from %s", filename,
             inet_ntoa(reinterpret_cast<const sockaddr_in *>(&clientAddr)->sin_addr));
 
-    CFile file(filename, FS_O_READ);
+    // Copy the path out so a time range suffix can be split off
+    char path[rwRequestPacketSize] = {0};
+    strncpy(path, filename, sizeof(path) - 1);
+    char *range = strchr(path, '@');
+    if (range != nullptr) {
+        *range++ = '\0';
+    }
+
+    CFile file(path, FS_O_READ);
     if (file.GetInitStatus() < 0) {
-        LOG_ERR("Error opening file %s", filename);
+        LOG_ERR("Error opening file %s", path);
         return;
     }
 
     const off_t fileSize = static_cast<off_t>(file.GetFileSize());
     if (fileSize < 0) {
-        LOG_ERR("Error getting file size for %s", filename);
+        LOG_ERR("Error getting file size for %s", path);
+        return;
+    }
+
+    off_t offset = 0;
+    off_t endOffset = fileSize;
+    if (range != nullptr && getTimeRange(path, range, offset, endOffset) < 0) {
+        LOG_ERR("Can't serve time range %s of %s", range, path);
         return;
     }
 
@@ -134,11 +159,11 @@ void CTftpServerTenant::handleReadRequest(const sockaddr &clientAddr, const uint
     uint16_t blockNumber = 1;
     constexpr uint16_t opcode = DATA;
     constexpr int maxDataSize = 512;
-    off_t offset = 0;
+    const off_t transferSize = endOffset - offset;
 
-    while (offset < fileSize) {
+    while (offset < endOffset) {
         uint8_t response[516] = {0}; // 2 bytes opcode, 2 bytes block number, up to 512 bytes data
-        size_t readLen = file.Read(&response[4], maxDataSize, offset);
+        size_t readLen = file.Read(&response[4], MIN(maxDataSize, endOffset - offset), offset);
         if (readLen <= 0) {
             LOG_ERR("Error reading file %s", filename);
             return;
@@ -165,8 +190,8 @@ void CTftpServerTenant::handleReadRequest(const sockaddr &clientAddr, const uint
         offset += readLen;
     }
 
-    // If the file size is an exact multiple of 512, send a final empty data packet.
-    if ((fileSize % maxDataSize) == 0) {
+    // If the transfer size is an exact multiple of 512, send a final empty data packet.
+    if ((transferSize % maxDataSize) == 0) {
         uint8_t finalResponse[4] = {0};
         finalResponse[0] = opcode >> 8;
         finalResponse[1] = opcode & 0xFF;
@@ -177,6 +202,64 @@ void CTftpServerTenant::handleReadRequest(const sockaddr &clientAddr, const uint
     }
 }
 
+int CTftpServerTenant::getTimeRange(const char *path, const char *range, off_t &startOffset, off_t &endOffset) {
+#ifdef CONFIG_F_CORE_OS
+    // <start ms>-<end ms>, either of which can be left out. strtoul would take signs and spaces, so only allow digits
+    char *end = const_cast<char *>(range);
+    uint32_t startMs = 0;
+    if (*range != '-') {
+        if (!isdigit(static_cast<unsigned char>(*range))) {
+            return -EINVAL;
+        }
+        startMs = strtoul(range, &end, 10);
+    }
+    if (*end != '-') {
+        return -EINVAL;
+    }
+
+    const char *endMsStr = end + 1;
+    uint32_t endMs = UINT32_MAX;
+    if (*endMsStr != '\0') {
+        if (!isdigit(static_cast<unsigned char>(*endMsStr))) {
+            return -EINVAL;
+        }
+        endMs = strtoul(endMsStr, &end, 10);
+        if (*end != '\0') {
+            return -EINVAL;
+        }
+    }
+    if (endMs < startMs) {
+        return -EINVAL;
+    }
+
+    off_t before = 0;
+    off_t after = 0;
+    int ret = detail::log_index_find(path, startMs, before, after);
+    if (ret < 0) {
+        return ret;
+    }
+    startOffset = MIN(before, endOffset);
+
+    ret = detail::log_index_find(path, endMs, before, after);
+    if (ret < 0) {
+        return ret;
+    }
+    if (after >= 0) {
+        endOffset = MIN(after, endOffset);
+    }
+    if (startOffset > endOffset) {
+        // Only if the index is out of order, but a negative transfer size must never reach the loop that sends it
+        return -EINVAL;
+    }
+
+    LOG_INF("Serving bytes %d - %d of %s for %u - %u ms", static_cast<int>(startOffset), static_cast<int>(endOffset),
+            path, startMs, endMs);
+    return 0;
+#else
+    return -ENOTSUP;
+#endif
+}
+
 int CTftpServerTenant::generateTree() {
     CFile file("/lfs/tree", FS_O_WRITE | FS_O_CREATE);
     file.Write("reee", 4);
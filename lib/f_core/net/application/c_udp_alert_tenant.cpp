@@ -1,5 +1,6 @@
 #include "f_core/net/application/c_udp_alert_tenant.h"
 #include <f_core/n_alerts.h>
+#include <f_core/os/c_wait_set.h>
 
 #include <array>
 
@@ -9,6 +10,10 @@ void CUdpAlertTenant::Subscribe(CObserver* observer) {
     observers.push_back(observer);
 }
 
+void CUdpAlertTenant::AddWaitSources(CWaitSet& waitSet) {
+    waitSet.AddSocket(sock.GetSocket());
+}
+
 void CUdpAlertTenant::Run() {
     std::array<uint8_t, NAlerts::ALERT_PACKET_SIZE>  buff{};
     if (sock.ReceiveAsynchronous(buff.data(), NAlerts::ALERT_PACKET_SIZE) > 0) {
@@ -0,0 +1,236 @@
+#include <f_core/os/c_datalogger.h>
+#include <cstring>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/crc.h>
+LOG_MODULE_REGISTER(compressed_datalogger);
+
+namespace {
+/**
+ * Packs codes MSB first into a fixed buffer. Running out of room is sticky, so callers only check once at the end
+ */
+class bit_writer {
+  public:
+    bit_writer(uint8_t *buf, std::size_t capacity) : buf(buf), capacity(capacity) {}
+
+    void put(uint64_t value, uint8_t num_bits) {
+        while (num_bits > 0) {
+            std::size_t byte = bit_pos / 8;
+            if (byte >= capacity) {
+                overflowed = true;
+                return;
+            }
+
+            uint8_t free_bits = 8 - bit_pos % 8;
+            uint8_t take = MIN(free_bits, num_bits);
+            uint8_t bits = (value >> (num_bits - take)) & ((1u << take) - 1);
+            if (free_bits == 8) {
+                buf[byte] = 0;
+            }
+            buf[byte] |= bits << (free_bits - take);
+
+            bit_pos += take;
+            num_bits -= take;
+        }
+    }
+
+    std::size_t size() const { return overflowed ? 0 : (bit_pos + 7) / 8; }
+
+  private:
+    uint8_t *buf;
+    std::size_t capacity;
+    std::size_t bit_pos = 0;
+    bool overflowed = false;
+};
+
+uint64_t load_field(const uint8_t *record, const detail::field_desc &field) {
+    // Records are little endian on every target we fly, so the low bytes of value line up with the field
+    uint64_t value = 0;
+    memcpy(&value, &record[field.offset], field.size);
+
+    if (field.kind == detail::field_desc::kind_t::Signed && field.size < sizeof(value)) {
+        uint8_t shift = 64 - 8 * field.size;
+        value = static_cast<uint64_t>(static_cast<int64_t>(value << shift) >> shift);
+    }
+    return value;
+}
+
+void encode_float(bit_writer &writer, uint64_t current, uint64_t previous, uint8_t width,
+                  detail::compressed_datalogger::field_state &state) {
+    uint64_t xored = current ^ previous;
+    if (xored == 0) {
+        writer.put(0b0, 1);
+        return;
+    }
+
+    // Count zeros within the field's width, not the whole 64 bits
+    uint8_t leading = __builtin_clzll(xored) - (64 - width);
+    uint8_t trailing = __builtin_ctzll(xored);
+    uint8_t window_bits = width == 32 ? 5 : 6;
+
+    if (state.leading != detail::compressed_datalogger::field_state::NO_WINDOW && leading >= state.leading &&
+        trailing >= state.trailing) {
+        writer.put(0b10, 2);
+        writer.put(xored >> state.trailing, width - state.leading - state.trailing);
+        return;
+    }
+
+    uint8_t meaningful = width - leading - trailing;
+    writer.put(0b11, 2);
+    writer.put(leading, window_bits);
+    writer.put(meaningful - 1, window_bits);
+    writer.put(xored >> trailing, meaningful);
+    state.leading = leading;
+    state.trailing = trailing;
+}
+
+void encode_integer(bit_writer &writer, uint64_t current, uint64_t previous) {
+    int64_t delta = static_cast<int64_t>(current - previous);
+    uint64_t zigzag = (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63);
+
+    if (zigzag == 0) {
+        writer.put(0b0, 1);
+    } else if (zigzag < (1ull << 7)) {
+        writer.put(0b10, 2);
+        writer.put(zigzag, 7);
+    } else if (zigzag < (1ull << 16)) {
+        writer.put(0b110, 3);
+        writer.put(zigzag, 16);
+    } else if (zigzag < (1ull << 32)) {
+        writer.put(0b1110, 4);
+        writer.put(zigzag, 32);
+    } else {
+        writer.put(0b1111, 4);
+        writer.put(zigzag, 64);
+    }
+}
+} // namespace
+
+namespace detail {
+compressed_datalogger::compressed_datalogger(const char *filename, const field_desc *fields, std::size_t num_fields,
+                                             std::size_t record_size, uint32_t schema_hash,
+                                             uint16_t keyframe_interval, uint8_t *previous, field_state *states,
+                                             uint8_t *scratch, uint8_t *block, std::size_t block_size, uint32_t flush_interval_ms,
+                                             bool indexed)
+    : file(filename, LogMode::Growing, 0, record_size, block, block_size, flush_interval_ms, indexed), fields(fields),
+      num_fields(num_fields), record_size(record_size), keyframe_interval(keyframe_interval), previous(previous),
+      states(states), scratch(scratch) {
+    const compressed_log_header header{
+        .magic = compressed_log_header::MAGIC,
+        .version = compressed_log_header::VERSION,
+        .record_size = static_cast<uint16_t>(record_size),
+        .num_fields = static_cast<uint16_t>(num_fields),
+        .keyframe_interval = keyframe_interval,
+        .schema_hash = schema_hash,
+    };
+    write_encoded(&header, sizeof(header), k_uptime_get_32());
+}
+
+int compressed_datalogger::write(const void *record) { return write(record, k_uptime_get_32()); }
+
+int compressed_datalogger::write(const void *record, uint32_t uptime_ms) {
+    const uint8_t *bytes = static_cast<const uint8_t *>(record);
+
+    std::size_t size = 0;
+    if (!keyframe_due && records_written % keyframe_interval != 0) {
+        size = encode_delta(bytes);
+    }
+
+    int ret = 0;
+    if (size == 0) {
+        // Due for a keyframe, or the delta would not fit its length byte
+        ret = write_keyframe(bytes, uptime_ms);
+    } else {
+        ret = write_encoded(scratch, size, uptime_ms);
+    }
+    if (ret < 0) {
+        // Encoding already moved the float windows on, and some of the record may have reached the file anyway, so
+        // the decoder's state is unknown. Start over from a keyframe
+        keyframe_due = true;
+        return ret;
+    }
+    keyframe_due = false;
+
+    memcpy(previous, bytes, record_size);
+    records_written++;
+    return record_size;
+}
+
+int compressed_datalogger::write_many(const void *records, std::size_t count, const uint32_t *uptimes_ms) {
+    const uint8_t *bytes = static_cast<const uint8_t *>(records);
+    const uint32_t now = k_uptime_get_32();
+    for (std::size_t i = 0; i < count; i++) {
+        int ret = write(&bytes[i * record_size], uptimes_ms != nullptr ? uptimes_ms[i] : now);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+    return count * record_size;
+}
+
+int compressed_datalogger::write_keyframe(const uint8_t *record, uint32_t uptime_ms) {
+    const uint32_t index = records_written;
+    uint16_t crc = crc16_ccitt(0xFFFF, reinterpret_cast<const uint8_t *>(&index), sizeof(index));
+    crc = crc16_ccitt(crc, record, record_size);
+
+    // One write per keyframe, so an index entry can only ever point at its start
+    uint8_t *out = scratch;
+    memcpy(out, KEYFRAME_MARKER, sizeof(KEYFRAME_MARKER));
+    out += sizeof(KEYFRAME_MARKER);
+    memcpy(out, &index, sizeof(index));
+    out += sizeof(index);
+    memcpy(out, record, record_size);
+    out += record_size;
+    memcpy(out, &crc, sizeof(crc));
+
+    int ret = write_encoded(scratch, KEYFRAME_OVERHEAD + record_size, uptime_ms);
+    if (ret < 0) {
+        return ret;
+    }
+
+    // Deltas after a keyframe must not depend on anything before it
+    for (std::size_t i = 0; i < num_fields; i++) {
+        states[i] = field_state{};
+    }
+    return 0;
+}
+
+std::size_t compressed_datalogger::encode_delta(const uint8_t *record) {
+    // If this overflows, a keyframe is written instead and resets any windows updated along the way
+    bit_writer writer(&scratch[1], MAX_DELTA_SIZE);
+
+    for (std::size_t i = 0; i < num_fields; i++) {
+        const field_desc &field = fields[i];
+        uint64_t current = load_field(record, field);
+        uint64_t prior = load_field(previous, field);
+
+        if (field.kind == field_desc::kind_t::Float) {
+            encode_float(writer, current, prior, field.size * 8, states[i]);
+        } else {
+            encode_integer(writer, current, prior);
+        }
+    }
+
+    std::size_t size = writer.size();
+    scratch[0] = static_cast<uint8_t>(size);
+    return size == 0 ? 0 : size + 1;
+}
+
+int compressed_datalogger::write_encoded(const void *data, std::size_t size, uint32_t uptime_ms) {
+    int ret = file.write(data, size, uptime_ms);
+    if (ret < 0) {
+        return ret;
+    }
+    bytes_written += size;
+    return 0;
+}
+
+int compressed_datalogger::flush() { return file.flush(); }
+
+int64_t compressed_datalogger::ms_until_flush() const { return file.ms_until_flush(); }
+
+int compressed_datalogger::close() {
+    LOG_INF("%s: %u records in %u bytes", file.filename, records_written, static_cast<uint32_t>(bytes_written));
+    return file.close();
+}
+} // namespace detail
@@ -1,53 +1,557 @@
 #include <f_core/os/c_datalogger.h>
+#include <cstddef>
+#include <cstdio>
+#include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/sys/crc.h>
 LOG_MODULE_REGISTER(datalogger);
 
+namespace {
+uint32_t header_crc(const detail::datalog_header &header) {
+    return crc32_ieee(reinterpret_cast<const uint8_t *>(&header), offsetof(detail::datalog_header, crc));
+}
+
+bool header_valid(const detail::datalog_header &header, std::size_t packet_size) {
+    return header.magic == detail::datalog_header::MAGIC && header.version == detail::datalog_header::VERSION &&
+           header.packet_size == packet_size && header.num_packets > 0 && header.cursor <= header.num_packets &&
+           header.crc == header_crc(header);
+}
+} // namespace
+
 namespace detail {
-datalogger::datalogger(const char *filename, LogMode mode, std::size_t num_packets)
-    : filename(filename), mode(mode), num_packets(num_packets) {
+datalogger::datalogger(const char *filename, LogMode mode, std::size_t num_packets, std::size_t packet_size,
+                       uint8_t *block, std::size_t block_size, uint32_t flush_interval_ms, bool indexed)
+    : filename(filename), mode(mode), num_packets(num_packets), block(block), block_size(block_size),
+      flush_interval_ms(flush_interval_ms), indexed(indexed) {
     fs_file_t_init(&file);
-    int ret = fs_open(&file, filename, FS_O_WRITE | FS_O_CREATE);
+    // Circular and FixedSize logs need to read their header back
+    int flags = mode == LogMode::Growing ? FS_O_WRITE | FS_O_CREATE : FS_O_RDWR | FS_O_CREATE;
+    int ret = fs_open(&file, filename, flags);
 
     if (ret < 0) {
         LOG_ERR("Error opening %s. %d", filename, ret);
         return;
     }
     LOG_DBG("Successfully opened %s", filename);
+
+    if (mode != LogMode::Growing) {
+        resume(packet_size);
+    } else {
+        // Growing logs start over from the beginning of the file. Drop whatever an older log left past the new one's
+        // end, or readers of the framed, compressed and multi-stream formats would find stale records that still pass
+        // their checks after the new ones
+        ret = fs_truncate(&file, 0);
+        if (ret < 0) {
+            LOG_ERR("Error truncating %s. Old records may follow the new ones. %d", filename, ret);
+        }
+    }
+
+    if (indexed && mode != LogMode::Growing) {
+        // Circular logs overwrite themselves, so an index of them wouldn't stay sorted
+        LOG_WRN("Only Growing logs can be indexed. Not indexing %s", filename);
+        this->indexed = false;
+    } else if (indexed) {
+        open_index();
+    }
 }
-int datalogger::write(const void *data, std::size_t size) {
-    if (mode == LogMode::Growing) {
-        int err = fs_write(&file, data, size);
-        if (err < 0) {
-            LOG_ERR("Error writing to file: %d", err);
+
+void datalogger::open_index() {
+    char path[LOG_INDEX_PATH_SIZE];
+    fs_file_t_init(&index_file);
+
+    int ret = log_index_path(filename, path, sizeof(path));
+    if (ret == 0) {
+        ret = fs_open(&index_file, path, FS_O_WRITE | FS_O_CREATE);
+    }
+    if (ret == 0) {
+        // The log starts over from the beginning of the file, so the index does too
+        ret = fs_truncate(&index_file, 0);
+    }
+    if (ret < 0) {
+        LOG_ERR("Error opening index for %s. Not indexing. %d", filename, ret);
+        indexed = false;
+    }
+}
+
+void datalogger::index_packet(std::size_t size, uint32_t uptime_ms) {
+    if (indexed && write_offset >= next_index_offset) {
+        // Packets can come from several producers, each stamped when it was sent, so keep the entries sorted
+        last_index_uptime_ms = MAX(uptime_ms, last_index_uptime_ms);
+        const log_index_entry entry{
+            .uptime_ms = last_index_uptime_ms,
+            .offset = static_cast<uint32_t>(write_offset),
+        };
+        int ret = fs_write(&index_file, &entry, sizeof(entry));
+        if (ret < 0) {
+            LOG_ERR("Error writing index for %s: %d", filename, ret);
         }
+        next_index_offset = (write_offset / LOG_INDEX_INTERVAL + 1) * LOG_INDEX_INTERVAL;
+    }
+    write_offset += size;
+}
+
+int datalogger::resume(std::size_t packet_size) {
+    data_start = sizeof(datalog_header);
+
+    datalog_header stored{};
+    ssize_t ret = fs_read(&file, &stored, sizeof(stored));
+    if (ret == sizeof(stored) && header_valid(stored, packet_size) && stored.num_packets == num_packets) {
+        header = stored;
+        header.generation++;
+        LOG_INF("Resuming %s at slot %u of %u (generation %u)", filename, header.cursor, header.num_packets,
+                header.generation);
+    } else {
+        header = datalog_header{
+            .magic = datalog_header::MAGIC,
+            .version = datalog_header::VERSION,
+            .packet_size = static_cast<uint16_t>(packet_size),
+            .num_packets = static_cast<uint32_t>(num_packets),
+            .cursor = 0,
+            .wraps = 0,
+            .generation = 0,
+            .crc = 0,
+        };
+        LOG_INF("Starting new log in %s", filename);
+    }
+
+    block_offset = data_start + header.cursor * header.packet_size;
+    return write_header();
+}
+
+int datalogger::write_header() {
+    header.crc = header_crc(header);
+
+    int ret = fs_seek(&file, 0, FS_SEEK_SET);
+    if (ret == 0) {
+        ret = fs_write(&file, &header, sizeof(header));
+    }
+    if (ret < 0) {
+        LOG_ERR("Error writing header to %s: %d", filename, ret);
+        return ret;
+    }
+
+    // Go back to where the next packet will be written
+    ret = fs_seek(&file, data_start + header.cursor * header.packet_size, FS_SEEK_SET);
+    if (ret < 0) {
+        LOG_ERR("Error Seeking file: %d", ret);
+    }
+    return ret;
+}
+
+int datalogger::wrap() {
+    int ret = commit_block();
+    if (ret < 0) {
+        return ret;
+    }
+    ret = fs_seek(&file, data_start, FS_SEEK_SET);
+    if (ret < 0) {
+        LOG_ERR("Error Seeking file: %d", ret);
+        return ret;
+    }
+    block_offset = data_start;
+    header.cursor = 0;
+    header.wraps++;
+    return 0;
+}
 
+void datalogger::mark_dirty() {
+    if (!dirty) {
+        dirty = true;
+        dirty_since_ms = k_uptime_get();
+    }
+}
+
+int datalogger::write(const void *data, std::size_t size) { return write(data, size, k_uptime_get_32()); }
+
+int datalogger::write(const void *data, std::size_t size, uint32_t uptime_ms) {
+    if (block != nullptr) {
+        return write_buffered(data, size, uptime_ms);
+    }
+
+    if (mode == LogMode::FixedSize && header.cursor >= num_packets) {
+        return ENOSPC;
+    } else if (mode == LogMode::Circular && header.cursor >= num_packets) {
+        int ret = wrap();
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    int err = fs_write(&file, data, size);
+    if (err < 0) {
+        LOG_ERR("Error writing to file: %d", err);
         return err;
     }
+    if (mode != LogMode::Growing) {
+        header.cursor++;
+    } else {
+        index_packet(size, uptime_ms);
+    }
+    mark_dirty();
 
-    off_t offset = fs_tell(&file);
-    if (offset < 0) {
-        LOG_ERR("Error Seeking file: %ld", offset);
-        return offset;
+    if (ms_until_flush() == 0) {
+        int ret = flush();
+        if (ret < 0) {
+            return ret;
+        }
     }
-    size_t index = offset / size;
+    return err;
+}
 
-    if (mode == LogMode::FixedSize) {
-        if (index < num_packets) {
-            return fs_write(&file, data, size);
-        } else {
+int datalogger::write_many(const void *data, std::size_t size, std::size_t count, const uint32_t *uptimes_ms) {
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    const uint32_t now = k_uptime_get_32();
+
+    if (block != nullptr) {
+        // Staging is a memcpy per packet anyway, so let write_buffered handle all of the mode bookkeeping
+        for (std::size_t i = 0; i < count; i++) {
+            int ret = write_buffered(&bytes[i * size], size, uptimes_ms != nullptr ? uptimes_ms[i] : now);
+            if (ret < 0) {
+                return ret;
+            } else if (ret != static_cast<int>(size)) {
+                return i * size;
+            }
+        }
+        return count * size;
+    }
+
+    std::size_t written = 0;
+    if (mode == LogMode::Growing) {
+        int err = fs_write(&file, data, size * count);
+        if (err < 0) {
+            LOG_ERR("Error writing to file: %d", err);
+            return err;
+        }
+        for (std::size_t i = 0; i < count; i++) {
+            index_packet(size, uptimes_ms != nullptr ? uptimes_ms[i] : now);
+        }
+        written = count;
+    } else if (mode == LogMode::FixedSize) {
+        if (header.cursor >= num_packets) {
             return ENOSPC;
         }
+        std::size_t chunk = MIN(count, num_packets - header.cursor);
+        int err = fs_write(&file, data, size * chunk);
+        if (err < 0) {
+            LOG_ERR("Error writing to file: %d", err);
+            return err;
+        }
+        header.cursor += chunk;
+        written = chunk;
     } else if (mode == LogMode::Circular) {
-        if (index >= num_packets) {
-            fs_seek(&file, 0, FS_SEEK_SET);
+        while (written < count) {
+            if (header.cursor >= num_packets) {
+                int ret = wrap();
+                if (ret < 0) {
+                    return ret;
+                }
+            }
+            std::size_t chunk = MIN(count - written, num_packets - header.cursor);
+            int err = fs_write(&file, &bytes[written * size], chunk * size);
+            if (err < 0) {
+                LOG_ERR("Error writing to file: %d", err);
+                return err;
+            }
+            header.cursor += chunk;
+            written += chunk;
+        }
+    } else {
+        LOG_ERR("Invalid LogMode: %d", (int) mode);
+        return -EINVAL;
+    }
+    mark_dirty();
+
+    if (ms_until_flush() == 0) {
+        int ret = flush();
+        if (ret < 0) {
+            return ret;
         }
-        return fs_write(&file, data, size);
     }
-    LOG_ERR("Invalid LogMode: %d", (int) mode);
-    return -EINVAL;
+    return written * size;
 }
+
+int datalogger::write_buffered(const void *data, std::size_t size, uint32_t uptime_ms) {
+    if (mode == LogMode::FixedSize && header.cursor >= num_packets) {
+        return ENOSPC;
+    } else if (mode == LogMode::Circular && header.cursor >= num_packets) {
+        int ret = wrap();
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    // Packets may straddle block boundaries. Fill up to the next boundary in the file, write it out, and carry on
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    std::size_t remaining = size;
+    // Bytes of this packet still sitting in the block, so a failed commit can take them back out
+    std::size_t staged = 0;
+    int err = 0;
+    while (remaining > 0) {
+        // After a short write the block no longer starts on a boundary, so it can fill up before reaching one
+        std::size_t room = MIN(block_size - block_fill, block_size - (block_offset + block_fill) % block_size);
+        std::size_t chunk = MIN(room, remaining);
+        memcpy(&block[block_fill], bytes, chunk);
+        block_fill += chunk;
+        staged += chunk;
+        bytes += chunk;
+        remaining -= chunk;
+        mark_dirty();
+
+        if (chunk != room) {
+            continue;
+        }
+        err = commit_block();
+        if (err == 0) {
+            staged = 0;
+            continue;
+        }
+
+        // Short writes take bytes from the front of the block, so this packet's bytes are the last ones left in it
+        const std::size_t unwritten = MIN(staged, block_fill);
+        if (unwritten == size - remaining) {
+            // None of the packet reached the file, so leave the block as it was before it
+            block_fill -= unwritten;
+            return err;
+        }
+
+        // Some of the packet is already in the file. Dropping the rest would leave half a record there and misalign
+        // every record after it, so stage the rest past the boundary for the next commit and count the packet written
+        if (remaining > block_size - block_fill) {
+            LOG_ERR("Packet too large to keep staged in %s after a failed write. The log is torn here", filename);
+            remaining = block_size - block_fill;
+        }
+        memcpy(&block[block_fill], bytes, remaining);
+        block_fill += remaining;
+        remaining = 0;
+    }
+    if (mode != LogMode::Growing) {
+        header.cursor++;
+    } else {
+        index_packet(size, uptime_ms);
+    }
+    if (err < 0) {
+        return err;
+    }
+
+    if (ms_until_flush() == 0) {
+        int ret = flush();
+        if (ret < 0) {
+            return ret;
+        }
+    }
+    return size;
+}
+
+int datalogger::commit_block() {
+    if (block_fill == 0) {
+        return 0;
+    }
+
+    int ret = fs_write(&file, block, block_fill);
+    if (ret < 0) {
+        LOG_ERR("Error writing to file: %d", ret);
+        return ret;
+    } else if (static_cast<std::size_t>(ret) != block_fill) {
+        // Usually a full disk. Keep what didn't make it at the front of the block so the file stays in order
+        LOG_ERR("Short write to %s: %d of %zu bytes", filename, ret, block_fill);
+        memmove(block, &block[ret], block_fill - ret);
+        block_offset += ret;
+        block_fill -= ret;
+        return -ENOSPC;
+    }
+    block_offset += block_fill;
+    block_fill = 0;
+    return 0;
+}
+
+int datalogger::flush() {
+    int ret = commit_block();
+    if (ret < 0) {
+        return ret;
+    }
+
+    if (mode != LogMode::Growing) {
+        ret = write_header();
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    ret = fs_sync(&file);
+    if (ret < 0) {
+        LOG_ERR("Error syncing %s: %d", filename, ret);
+        return ret;
+    }
+    if (indexed) {
+        fs_sync(&index_file);
+    }
+    dirty = false;
+    return 0;
+}
+
+int64_t datalogger::ms_until_flush() const {
+    if (!dirty || flush_interval_ms == 0) {
+        return -1;
+    }
+
+    int64_t elapsed = k_uptime_get() - dirty_since_ms;
+    return MAX(static_cast<int64_t>(0), static_cast<int64_t>(flush_interval_ms) - elapsed);
+}
+
 int datalogger::close() {
     LOG_DBG("Closing %s", filename);
-    return fs_close(&file);
+    // Close everything regardless, but report the first thing that went wrong
+    int ret = commit_block();
+    if (mode != LogMode::Growing) {
+        int header_ret = write_header();
+        ret = ret < 0 ? ret : header_ret;
+    }
+    if (indexed) {
+        fs_close(&index_file);
+    }
+    int close_ret = fs_close(&file);
+    return ret < 0 ? ret : close_ret;
+}
+
+int log_index_path(const char *filename, char *path, std::size_t size) {
+    int len = snprintf(path, size, "%s.idx", filename);
+    return len < 0 || static_cast<std::size_t>(len) >= size ? -ENAMETOOLONG : 0;
+}
+
+int log_index_find(const char *filename, uint32_t uptime_ms, off_t &before, off_t &after) {
+    char path[LOG_INDEX_PATH_SIZE];
+    int ret = log_index_path(filename, path, sizeof(path));
+    if (ret < 0) {
+        return ret;
+    }
+
+    fs_file_t index{};
+    fs_file_t_init(&index);
+    ret = fs_open(&index, path, FS_O_READ);
+    if (ret < 0) {
+        return ret;
+    }
+
+    auto read_entry = [&index](std::size_t i, log_index_entry &entry) -> int {
+        int ret = fs_seek(&index, i * sizeof(entry), FS_SEEK_SET);
+        if (ret < 0) {
+            return ret;
+        }
+        return fs_read(&index, &entry, sizeof(entry)) == sizeof(entry) ? 0 : -EIO;
+    };
+
+    fs_seek(&index, 0, FS_SEEK_END);
+    const std::size_t num_entries = fs_tell(&index) / sizeof(log_index_entry);
+
+    // Find the first entry written after uptime_ms
+    std::size_t low = 0;
+    std::size_t high = num_entries;
+    log_index_entry entry{};
+    while (low < high && ret == 0) {
+        std::size_t mid = low + (high - low) / 2;
+        ret = read_entry(mid, entry);
+        if (entry.uptime_ms <= uptime_ms) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    before = 0;
+    after = -1;
+    if (ret == 0 && low > 0) {
+        ret = read_entry(low - 1, entry);
+        before = entry.offset;
+    }
+    if (ret == 0 && low < num_entries) {
+        ret = read_entry(low, entry);
+        after = entry.offset;
+    }
+
+    fs_close(&index);
+    return ret;
+}
+
+datalog_reader::datalog_reader(const char *filename, LogMode mode, std::size_t size)
+    : filename(filename), mode(mode), size(size) {
+    fs_file_t_init(&file);
+    init_status = fs_open(&file, filename, FS_O_READ);
+    if (init_status < 0) {
+        LOG_ERR("Error opening %s. %d", filename, init_status);
+        return;
+    }
+
+    if (mode == LogMode::Growing) {
+        fs_seek(&file, 0, FS_SEEK_END);
+        off_t end = fs_tell(&file);
+        count = end > 0 ? end / size : 0;
+        num_slots = count;
+        return;
+    }
+
+    datalog_header header{};
+    if (fs_read(&file, &header, sizeof(header)) != sizeof(header) || !header_valid(header, size)) {
+        LOG_ERR("%s does not have a valid log header", filename);
+        fs_close(&file);
+        init_status = -EINVAL;
+        return;
+    }
+
+    data_start = sizeof(datalog_header);
+    num_slots = header.num_packets;
+    if (header.wraps > 0) {
+        // Every slot is in use and the cursor points at the oldest packet
+        count = header.num_packets;
+        oldest = header.cursor % header.num_packets;
+    } else {
+        count = header.cursor;
+        oldest = 0;
+    }
+}
+
+datalog_reader::~datalog_reader() {
+    if (init_status == 0) {
+        fs_close(&file);
+    }
+}
+
+int datalog_reader::read(std::size_t index, void *data) {
+    if (init_status < 0) {
+        return init_status;
+    } else if (index >= count) {
+        return -EINVAL;
+    }
+
+    std::size_t slot = (oldest + index) % num_slots;
+    int ret = fs_seek(&file, data_start + slot * size, FS_SEEK_SET);
+    if (ret < 0) {
+        LOG_ERR("Error Seeking file: %d", ret);
+        return ret;
+    }
+
+    ssize_t num_read = fs_read(&file, data, size);
+    if (num_read < 0) {
+        return num_read;
+    }
+    return num_read == static_cast<ssize_t>(size) ? 0 : -EIO;
+}
+
+int datalog_reader::seek_to_time(uint32_t uptime_ms, std::size_t &index) {
+    if (init_status < 0) {
+        return init_status;
+    } else if (mode != LogMode::Growing) {
+        return -ENOTSUP;
+    }
+
+    off_t before = 0;
+    off_t after = 0;
+    int ret = log_index_find(filename, uptime_ms, before, after);
+    if (ret < 0) {
+        return ret;
+    }
+
+    // The index can run ahead of data that never made it to disk
+    index = MIN(static_cast<std::size_t>(before) / size, count);
+    return 0;
 }
-} // namespace detail
\ No newline at end of file
+} // namespace detail
@@ -0,0 +1,125 @@
+#include <f_core/os/c_datalogger.h>
+#include <cstring>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/crc.h>
+LOG_MODULE_REGISTER(framed_datalogger);
+
+namespace detail {
+framed_datalogger::framed_datalogger(const char *filename, std::size_t record_size, const char *type_name,
+                                     uint32_t schema_hash, uint8_t *block, std::size_t block_size,
+                                     uint32_t flush_interval_ms, bool indexed)
+    : file(filename, LogMode::Growing, 0, record_size, nullptr, 0, 0, indexed), record_size(record_size), block(block),
+      block_size(block_size), flush_interval_ms(flush_interval_ms) {
+    framed_log_header header{
+        .magic = framed_log_header::MAGIC,
+        .version = framed_log_header::VERSION,
+        .record_size = static_cast<uint16_t>(record_size),
+        .schema_hash = schema_hash,
+        .block_size = static_cast<uint32_t>(block_size),
+        .type_name = {0},
+        .crc = 0,
+    };
+    strncpy(header.type_name, type_name, sizeof(header.type_name) - 1);
+    header.crc = crc32_ieee(reinterpret_cast<const uint8_t *>(&header), offsetof(framed_log_header, crc));
+
+    int ret = file.write(&header, sizeof(header));
+    if (ret < 0) {
+        LOG_ERR("Error writing header to %s: %d", filename, ret);
+    }
+}
+
+int framed_datalogger::write(const void *record, uint32_t uptime_ms, uint32_t sequence) {
+    const std::size_t framed_size = sizeof(frame_record_header) + record_size;
+
+    if (block_fill > 0) {
+        bool full = block_fill + framed_size > block_size;
+        bool out_of_range = uptime_ms < last_uptime_ms || uptime_ms - last_uptime_ms > UINT16_MAX ||
+                            sequence < first_sequence || sequence - first_sequence > UINT16_MAX;
+        if (full || out_of_range) {
+            int ret = close_block();
+            if (ret < 0) {
+                return ret;
+            }
+        }
+    }
+
+    if (block_fill == 0) {
+        block_fill = sizeof(frame_block_header);
+        block_count = 0;
+        first_sequence = sequence;
+        base_uptime_ms = uptime_ms;
+        last_uptime_ms = uptime_ms;
+        opened_at_ms = k_uptime_get();
+    }
+
+    const frame_record_header framing{
+        .uptime_delta_ms = static_cast<uint16_t>(uptime_ms - last_uptime_ms),
+        .sequence_offset = static_cast<uint16_t>(sequence - first_sequence),
+    };
+    memcpy(&block[block_fill], &framing, sizeof(framing));
+    memcpy(&block[block_fill + sizeof(framing)], record, record_size);
+    block_fill += framed_size;
+    block_count++;
+    last_uptime_ms = uptime_ms;
+    next_sequence = sequence + 1;
+
+    if (ms_until_flush() == 0) {
+        int ret = flush();
+        if (ret < 0) {
+            return ret;
+        }
+    }
+    return record_size;
+}
+
+int framed_datalogger::close_block() {
+    if (block_fill == 0) {
+        return 0;
+    }
+
+    frame_block_header header{
+        .magic = frame_block_header::MAGIC,
+        .length = static_cast<uint16_t>(block_fill - sizeof(frame_block_header)),
+        .count = block_count,
+        .first_sequence = first_sequence,
+        .base_uptime_ms = base_uptime_ms,
+        .crc = 0,
+    };
+    uint32_t crc = crc32_ieee(reinterpret_cast<const uint8_t *>(&header), offsetof(frame_block_header, crc));
+    header.crc = crc32_ieee_update(crc, &block[sizeof(header)], header.length);
+    memcpy(block, &header, sizeof(header));
+
+    // The whole block goes out in one write so it never lands on disk half framed. Its index entry (if any) points at
+    // the block, so it gets the block's first record's time
+    int ret = file.write(block, block_fill, base_uptime_ms);
+    block_fill = 0;
+    if (ret < 0) {
+        LOG_ERR("Error writing block to %s: %d", file.filename, ret);
+        return ret;
+    }
+    return 0;
+}
+
+int framed_datalogger::flush() {
+    int ret = close_block();
+    if (ret < 0) {
+        return ret;
+    }
+    return file.flush();
+}
+
+int64_t framed_datalogger::ms_until_flush() const {
+    if (block_fill == 0 || flush_interval_ms == 0) {
+        return -1;
+    }
+
+    int64_t elapsed = k_uptime_get() - opened_at_ms;
+    return MAX(static_cast<int64_t>(0), static_cast<int64_t>(flush_interval_ms) - elapsed);
+}
+
+int framed_datalogger::close() {
+    close_block();
+    return file.close();
+}
+} // namespace detail
@@ -0,0 +1,196 @@
+#include <f_core/os/c_datalogger.h>
+#include <cstring>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(multi_stream_logger);
+
+namespace detail {
+multi_stream_logger::multi_stream_logger(const char *filename, uint8_t *block, std::size_t block_size,
+                                         uint32_t flush_interval_ms, bool indexed)
+    : file(filename, LogMode::Growing, 0, 0, block, block_size, flush_interval_ms, indexed) {
+    k_mutex_init(&lock);
+
+    const multi_stream_log_header header{
+        .magic = multi_stream_log_header::MAGIC,
+        .version = multi_stream_log_header::VERSION,
+        .max_streams = MULTI_STREAM_MAX_STREAMS,
+    };
+    int ret = file.write(&header, sizeof(header));
+    if (ret < 0) {
+        LOG_ERR("Error writing header to %s: %d", filename, ret);
+    }
+}
+
+int multi_stream_logger::add_stream(const char *name, std::size_t record_size, uint32_t schema_hash) {
+    if (record_size == 0 || record_size > MULTI_STREAM_MAX_RECORD_SIZE) {
+        LOG_ERR("Stream %s has unsupported record size %zu", name, record_size);
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&lock, K_FOREVER);
+    if (num_streams >= MULTI_STREAM_MAX_STREAMS) {
+        k_mutex_unlock(&lock);
+        LOG_ERR("No room for stream %s in %s", name, file.filename);
+        return -ENOSPC;
+    }
+
+    multi_stream_definition definition{
+        .stream_id = static_cast<uint8_t>(num_streams),
+        .record_size = static_cast<uint16_t>(record_size),
+        .schema_hash = schema_hash,
+        .name = {0},
+    };
+    strncpy(definition.name, name, sizeof(definition.name) - 1);
+
+    int ret = write_tagged(multi_stream_record_header::DEFINITION_STREAM, &definition, sizeof(definition),
+                           k_uptime_get_32());
+    if (ret >= 0) {
+        record_sizes[num_streams] = record_size;
+        ret = num_streams++;
+    }
+    k_mutex_unlock(&lock);
+    return ret;
+}
+
+int multi_stream_logger::write(uint8_t stream_id, const void *record, uint32_t uptime_ms) {
+    // Streams can be added while others are being written, so even the stream count is read under the lock
+    k_mutex_lock(&lock, K_FOREVER);
+    if (stream_id >= num_streams) {
+        k_mutex_unlock(&lock);
+        return -EINVAL;
+    }
+
+    const std::size_t size = record_sizes[stream_id];
+    int ret = write_tagged(stream_id, record, size, uptime_ms);
+    k_mutex_unlock(&lock);
+    return ret < 0 ? ret : static_cast<int>(size);
+}
+
+int multi_stream_logger::write_tagged(uint8_t stream_id, const void *record, std::size_t size, uint32_t uptime_ms) {
+    // The tag and record go to the datalogger together, so an index entry never lands between them. Called with the
+    // lock held, which also guards tagged
+    const multi_stream_record_header tag{
+        .stream_id = stream_id,
+        .uptime_ms = uptime_ms,
+    };
+    memcpy(tagged.data(), &tag, sizeof(tag));
+    memcpy(&tagged[sizeof(tag)], record, size);
+
+    int ret = file.write(tagged.data(), sizeof(tag) + size, uptime_ms);
+    if (ret < 0) {
+        LOG_ERR("Error writing stream %u to %s: %d", stream_id, file.filename, ret);
+    }
+    return ret;
+}
+
+int multi_stream_logger::flush() {
+    k_mutex_lock(&lock, K_FOREVER);
+    int ret = file.flush();
+    k_mutex_unlock(&lock);
+    return ret;
+}
+
+int64_t multi_stream_logger::ms_until_flush() {
+    k_mutex_lock(&lock, K_FOREVER);
+    int64_t ret = file.ms_until_flush();
+    k_mutex_unlock(&lock);
+    return ret;
+}
+
+int multi_stream_logger::close() {
+    k_mutex_lock(&lock, K_FOREVER);
+    int ret = file.close();
+    k_mutex_unlock(&lock);
+    return ret;
+}
+
+multi_stream_reader::multi_stream_reader(const char *filename, const char *name, std::size_t record_size)
+    : name(name), record_size(record_size) {
+    fs_file_t_init(&file);
+    init_status = fs_open(&file, filename, FS_O_READ);
+    if (init_status < 0) {
+        LOG_ERR("Error opening %s. %d", filename, init_status);
+        return;
+    }
+    init_status = rewind();
+}
+
+multi_stream_reader::~multi_stream_reader() {
+    if (init_status == 0) {
+        fs_close(&file);
+    }
+}
+
+int multi_stream_reader::rewind() {
+    int ret = fs_seek(&file, 0, FS_SEEK_SET);
+    if (ret < 0) {
+        return ret;
+    }
+
+    multi_stream_log_header header{};
+    if (fs_read(&file, &header, sizeof(header)) != sizeof(header) || header.magic != multi_stream_log_header::MAGIC ||
+        header.version != multi_stream_log_header::VERSION || header.max_streams > MULTI_STREAM_MAX_STREAMS) {
+        LOG_ERR("Not a multi-stream log");
+        return -EBADMSG;
+    }
+
+    record_sizes.fill(0);
+    stream_id = -1;
+    return 0;
+}
+
+int multi_stream_reader::next(void *record, uint32_t &uptime_ms) {
+    if (init_status < 0) {
+        return init_status;
+    }
+
+    while (true) {
+        multi_stream_record_header tag{};
+        // A record cut short by power loss is the end of the log, the same as running out of file
+        if (fs_read(&file, &tag, sizeof(tag)) != sizeof(tag)) {
+            return -ENODATA;
+        }
+
+        if (tag.stream_id == multi_stream_record_header::DEFINITION_STREAM) {
+            multi_stream_definition definition{};
+            if (fs_read(&file, &definition, sizeof(definition)) != sizeof(definition)) {
+                return -ENODATA;
+            }
+            if (definition.stream_id >= MULTI_STREAM_MAX_STREAMS) {
+                return -EBADMSG;
+            }
+            record_sizes[definition.stream_id] = definition.record_size;
+
+            if (stream_id < 0 && strncmp(definition.name, name, sizeof(definition.name)) == 0) {
+                if (definition.record_size == record_size) {
+                    stream_id = definition.stream_id;
+                    schema_hash = definition.schema_hash;
+                } else {
+                    LOG_WRN("Stream %s has %u byte records, not %zu. Skipping it", name, definition.record_size,
+                            record_size);
+                }
+            }
+            continue;
+        }
+
+        if (tag.stream_id >= MULTI_STREAM_MAX_STREAMS || record_sizes[tag.stream_id] == 0) {
+            // Without a size there is no way to find the next record
+            return -EBADMSG;
+        }
+
+        if (tag.stream_id != stream_id) {
+            int ret = fs_seek(&file, record_sizes[tag.stream_id], FS_SEEK_CUR);
+            if (ret < 0) {
+                return ret;
+            }
+            continue;
+        }
+
+        if (fs_read(&file, record, record_size) != static_cast<ssize_t>(record_size)) {
+            return -ENODATA;
+        }
+        uptime_ms = tag.uptime_ms;
+        return 0;
+    }
+}
+} // namespace detail
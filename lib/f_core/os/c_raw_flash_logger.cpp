@@ -0,0 +1,363 @@
+#ifdef CONFIG_FLASH_MAP
+#include <f_core/os/c_raw_flash_logger.h>
+#include <cstddef>
+#include <cstring>
+#include <zephyr/fs/fs.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/crc.h>
+LOG_MODULE_REGISTER(raw_flash_logger);
+
+namespace {
+constexpr std::size_t CRC_SIZE = sizeof(uint16_t);
+
+// Shared by every raw flash log, and started by the first one constructed
+K_THREAD_STACK_DEFINE(erase_queue_stack, CONFIG_F_CORE_RAW_FLASH_ERASE_STACK_SIZE);
+k_work_q erase_queue;
+atomic_t erase_queue_started = ATOMIC_INIT(0);
+
+void start_erase_queue() {
+    if (!atomic_cas(&erase_queue_started, 0, 1)) {
+        return;
+    }
+
+    const k_work_queue_config config = {.name = "raw_flash_erase", .no_yield = false, .essential = false};
+    k_work_queue_init(&erase_queue);
+    k_work_queue_start(&erase_queue, erase_queue_stack, K_THREAD_STACK_SIZEOF(erase_queue_stack),
+                       CONFIG_F_CORE_RAW_FLASH_ERASE_PRIORITY, &config);
+}
+
+std::size_t align_up(std::size_t size, std::size_t alignment) { return (size + alignment - 1) / alignment * alignment; }
+
+bool is_erased(const uint8_t *data, std::size_t size, uint8_t erased_value) {
+    for (std::size_t i = 0; i < size; i++) {
+        if (data[i] != erased_value) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t header_crc(const detail::raw_flash_sector_header &header) {
+    return crc32_ieee(reinterpret_cast<const uint8_t *>(&header), offsetof(detail::raw_flash_sector_header, crc));
+}
+} // namespace
+
+namespace detail {
+raw_flash_logger::raw_flash_logger(uint8_t partition_id, std::size_t record_size, uint8_t *page, std::size_t page_size,
+                                   std::size_t sector_size, uint32_t flush_interval_ms, std::size_t pre_erase_sectors)
+    : record_size(record_size), sector_size(sector_size), page(page), page_size(page_size),
+      flush_interval_ms(flush_interval_ms), pre_erase_sectors(pre_erase_sectors) {
+    k_mutex_init(&erase_lock);
+    erase_work.logger = this;
+    k_work_init(&erase_work.work, erase_handler);
+    start_erase_queue();
+
+    init_status = open(partition_id);
+    if (init_status < 0) {
+        LOG_ERR("Error opening raw flash log on partition %u: %d", partition_id, init_status);
+        return;
+    }
+    resume();
+}
+
+int raw_flash_logger::open(uint8_t partition_id) {
+    int ret = flash_area_open(partition_id, &area);
+    if (ret < 0) {
+        return ret;
+    }
+
+    const std::size_t alignment = MAX(flash_area_align(area), 1u);
+    erased_value = flash_area_erased_val(area);
+    slot_size = align_up(record_size + CRC_SIZE, alignment);
+    header_size = align_up(sizeof(raw_flash_sector_header), alignment);
+    num_sectors = area->fa_size / sector_size;
+
+    if (area->fa_size % sector_size != 0 || header_size + slot_size > page_size) {
+        return -EINVAL;
+    }
+    // The eraser stays pre_erase_sectors ahead, and must never reach the oldest sector still worth keeping
+    if (num_sectors < pre_erase_sectors + 2) {
+        return -ENOSPC;
+    }
+    slots_per_sector = (sector_size - header_size) / slot_size;
+    return 0;
+}
+
+bool raw_flash_logger::read_sector_header(std::size_t index, raw_flash_sector_header &header) const {
+    if (flash_area_read(area, index * sector_size, &header, sizeof(header)) < 0) {
+        return false;
+    }
+    return header.magic == raw_flash_sector_header::MAGIC && header.version == raw_flash_sector_header::VERSION &&
+           header.record_size == record_size && header.crc == header_crc(header);
+}
+
+int raw_flash_logger::read_slot(off_t offset, uint8_t *slot_data) const {
+    int ret = flash_area_read(area, offset, slot_data, slot_size);
+    if (ret < 0) {
+        return ret;
+    }
+    if (is_erased(slot_data, slot_size, erased_value)) {
+        return -ENODATA;
+    }
+
+    uint16_t crc = 0;
+    memcpy(&crc, &slot_data[record_size], CRC_SIZE);
+    return crc == crc16_ccitt(0, slot_data, record_size) ? 0 : -EBADMSG;
+}
+
+void raw_flash_logger::resume() {
+    // One header read per sector. Only done once at boot
+    bool found = false;
+    uint32_t newest = 0;
+    for (std::size_t i = 0; i < num_sectors; i++) {
+        raw_flash_sector_header header{};
+        if (read_sector_header(i, header) && (!found || header.sequence > newest)) {
+            newest = header.sequence;
+            found = true;
+        }
+    }
+
+    if (!found) {
+        LOG_INF("Starting new raw flash log (%zu sectors of %zu records)", num_sectors, slots_per_sector);
+        atomic_set(&erased_until, 0);
+        int ret = start_sector(0);
+        if (ret < 0) {
+            init_status = ret;
+        }
+        // Erasing the first sector isn't a stall
+        erase_stalls = 0;
+        return;
+    }
+
+    // Slots are programmed in order, so writing resumes after the last one that isn't erased (torn or not)
+    sequence = newest;
+    slot = slots_per_sector;
+    while (slot > 0) {
+        const off_t offset = sector_offset(sequence) + header_size + (slot - 1) * slot_size;
+        if (read_slot(offset, page) != -ENODATA) {
+            break;
+        }
+        slot--;
+    }
+    page_offset = sector_offset(sequence) + header_size + slot * slot_size;
+    page_fill = 0;
+
+    // Nothing is known about the sectors ahead, so they all get erased before use
+    atomic_set(&writing, sequence);
+    atomic_set(&erased_until, sequence + 1);
+    k_work_submit_to_queue(&erase_queue, &erase_work.work);
+    LOG_INF("Resuming raw flash log in sector %u (slot %zu of %zu)", sequence, slot, slots_per_sector);
+}
+
+int raw_flash_logger::erase_sector(uint32_t target) {
+    int ret = flash_area_erase(area, sector_offset(target), sector_size);
+    if (ret < 0) {
+        LOG_ERR("Error erasing sector %u: %d", target, ret);
+        return ret;
+    }
+    atomic_set(&erased_until, target + 1);
+    return 0;
+}
+
+int raw_flash_logger::ensure_erased(uint32_t target) {
+    int ret = 0;
+    k_mutex_lock(&erase_lock, K_FOREVER);
+    while (ret == 0 && static_cast<uint32_t>(atomic_get(&erased_until)) <= target) {
+        ret = erase_sector(atomic_get(&erased_until));
+        erase_stalls++;
+    }
+    k_mutex_unlock(&erase_lock);
+    return ret;
+}
+
+void raw_flash_logger::erase_handler(k_work *work) {
+    raw_flash_logger *logger = CONTAINER_OF(work, erase_work_item, work)->logger;
+
+    // Erase one sector per lock so a stalled writer can get in between
+    while (true) {
+        k_mutex_lock(&logger->erase_lock, K_FOREVER);
+        const uint32_t next = atomic_get(&logger->erased_until);
+        const uint32_t limit = atomic_get(&logger->writing) + 1 + logger->pre_erase_sectors;
+        int ret = next < limit ? logger->erase_sector(next) : -EALREADY;
+        k_mutex_unlock(&logger->erase_lock);
+
+        if (ret < 0) {
+            return;
+        }
+    }
+}
+
+int raw_flash_logger::start_sector(uint32_t new_sequence) {
+    int ret = ensure_erased(new_sequence);
+    if (ret < 0) {
+        return ret;
+    }
+
+    sequence = new_sequence;
+    slot = 0;
+    atomic_set(&writing, sequence);
+    k_work_submit_to_queue(&erase_queue, &erase_work.work);
+
+    raw_flash_sector_header header{
+        .magic = raw_flash_sector_header::MAGIC,
+        .version = raw_flash_sector_header::VERSION,
+        .record_size = static_cast<uint16_t>(record_size),
+        .sequence = sequence,
+        .crc = 0,
+    };
+    header.crc = header_crc(header);
+
+    // The header goes out with the sector's first page
+    page_offset = sector_offset(sequence);
+    memset(page, erased_value, header_size);
+    memcpy(page, &header, sizeof(header));
+    page_fill = header_size;
+    return 0;
+}
+
+int raw_flash_logger::program_page() {
+    if (page_fill == 0) {
+        return 0;
+    }
+
+    int ret = flash_area_write(area, page_offset, page, page_fill);
+    if (ret < 0) {
+        LOG_ERR("Error programming %zu bytes at %ld: %d", page_fill, static_cast<long>(page_offset), ret);
+        return ret;
+    }
+    page_offset += page_fill;
+    page_fill = 0;
+    return 0;
+}
+
+int raw_flash_logger::write(const void *record) {
+    if (init_status < 0) {
+        return init_status;
+    }
+
+    if (slot == slots_per_sector) {
+        int ret = program_page();
+        if (ret == 0) {
+            ret = start_sector(sequence + 1);
+        }
+        if (ret < 0) {
+            return ret;
+        }
+    } else if (page_fill + slot_size > page_size) {
+        int ret = program_page();
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    if (page_fill == 0 || (page_fill == header_size && slot == 0)) {
+        staged_since_ms = k_uptime_get();
+    }
+
+    uint8_t *slot_data = &page[page_fill];
+    const uint16_t crc = crc16_ccitt(0, static_cast<const uint8_t *>(record), record_size);
+    memcpy(slot_data, record, record_size);
+    memcpy(&slot_data[record_size], &crc, CRC_SIZE);
+    memset(&slot_data[record_size + CRC_SIZE], erased_value, slot_size - record_size - CRC_SIZE);
+    page_fill += slot_size;
+    slot++;
+
+    if (ms_until_flush() == 0) {
+        int ret = flush();
+        if (ret < 0) {
+            return ret;
+        }
+    }
+    return record_size;
+}
+
+int raw_flash_logger::flush() {
+    if (init_status < 0) {
+        return init_status;
+    }
+    // NOR flash is done with a page once it is programmed. There's nothing to sync
+    return program_page();
+}
+
+int64_t raw_flash_logger::ms_until_flush() const {
+    if (page_fill == 0 || flush_interval_ms == 0) {
+        return -1;
+    }
+
+    int64_t elapsed = k_uptime_get() - staged_since_ms;
+    return MAX(static_cast<int64_t>(0), static_cast<int64_t>(flush_interval_ms) - elapsed);
+}
+
+int raw_flash_logger::close() {
+    int ret = flush();
+
+    k_work_sync sync;
+    k_work_cancel_sync(&erase_work.work, &sync);
+    return ret;
+}
+
+int raw_flash_logger::export_to(const char *filename) {
+    if (init_status < 0) {
+        return init_status;
+    }
+
+    fs_file_t file;
+    fs_file_t_init(&file);
+    int ret = fs_open(&file, filename, FS_O_WRITE | FS_O_CREATE);
+    if (ret == 0) {
+        ret = fs_truncate(&file, 0);
+    }
+    if (ret < 0) {
+        LOG_ERR("Error opening %s for export: %d", filename, ret);
+        return ret;
+    }
+
+    // Nothing is staged after close(), so the page buffer batches records on their way to the file. Each slot is read
+    // straight into place, and only kept (without its crc) if it is intact
+    std::size_t batched = 0;
+    int exported = 0;
+    int torn = 0;
+
+    const uint32_t oldest = sequence >= num_sectors ? sequence - num_sectors + 1 : 0;
+    for (uint32_t target = oldest; target <= sequence && ret >= 0; target++) {
+        raw_flash_sector_header header{};
+        if (!read_sector_header(target % num_sectors, header) || header.sequence != target) {
+            // Erased ahead of the cursor, or never written
+            continue;
+        }
+
+        for (std::size_t i = 0; i < slots_per_sector && ret >= 0; i++) {
+            if (batched + slot_size > page_size) {
+                ret = fs_write(&file, page, batched);
+                batched = 0;
+                if (ret < 0) {
+                    break;
+                }
+            }
+
+            int status = read_slot(sector_offset(target) + header_size + i * slot_size, &page[batched]);
+            if (status == -ENODATA) {
+                break;
+            } else if (status < 0) {
+                torn++;
+                continue;
+            }
+            batched += record_size;
+            exported++;
+        }
+    }
+    if (ret >= 0 && batched > 0) {
+        ret = fs_write(&file, page, batched);
+    }
+
+    int close_ret = fs_close(&file);
+    if (ret < 0 || close_ret < 0) {
+        LOG_ERR("Error exporting to %s: %d", filename, ret < 0 ? ret : close_ret);
+        return ret < 0 ? ret : close_ret;
+    }
+    LOG_INF("Exported %d records to %s (%d torn)", exported, filename, torn);
+    return exported;
+}
+} // namespace detail
+#endif
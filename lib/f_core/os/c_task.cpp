@@ -22,41 +22,90 @@ static void taskEntryWrapper(void* taskObj, void*, void*) {
 #if defined(CONFIG_ARCH_POSIX)
         // Refer to Zephyr's POSIX arch limitations documentation
         // https://docs.zephyrproject.org/latest/boards/native/native_sim/doc/index.html
-        k_cpu_idle();
+        // Event driven tasks already block in Run()
+        if (!task->IsEventDriven()) {
+            k_cpu_idle();
+        }
 #endif
     }
 }
 
-CTask::CTask(const char* name, int priority, int stackSize, int sleepTimeMs) : name(name),
-                                                                               priority(priority), stackSize(stackSize),
-                                                                               sleepTimeMs(sleepTimeMs) {
+#ifdef CONFIG_F_CORE_TENANT_PROFILER
+/**
+ * Cycles the calling thread has run for. With CONFIG_SCHED_THREAD_USAGE that leaves out time it spent blocked or
+ * preempted. Without it, this is just the cycle counter, so differences are wall time
+ */
+static uint64_t runningCycles() {
+#ifdef CONFIG_SCHED_THREAD_USAGE
+    k_thread_runtime_stats_t stats{};
+    k_thread_runtime_stats_get(k_current_get(), &stats);
+    return stats.execution_cycles;
+#else
+    return k_cycle_get_32();
+#endif
+}
+#endif
+
+CTask::CTask(const char* name, int priority, int stackSize, int sleepTimeMs) : CTask(name, priority, nullptr,
+                                                                               stackSize, {}, sleepTimeMs) {
+}
+
+CTask::CTask(const char* name, int priority, int stackSize, Period period) : CTask(name, priority, nullptr, stackSize,
+                                                                                  {}, period) {
+}
+
+CTask::CTask(const char* name, int priority, k_thread_stack_t* stack, size_t stackSize,
+             std::span<CTenant*> tenantSlots, int sleepTimeMs) : name(name), priority(priority), stackSize(stackSize),
+                                                                  sleepTimeMs(sleepTimeMs), stack(stack),
+                                                                  dynamic(stack == nullptr), tenants(tenantSlots) {
+}
+
+CTask::CTask(const char* name, int priority, k_thread_stack_t* stack, size_t stackSize,
+             std::span<CTenant*> tenantSlots, Period period) : name(name), priority(priority), stackSize(stackSize),
+                                                               sleepTimeMs(0), periodUs(period.us),
+                                                               periodTicks(MAX(k_us_to_ticks_near64(period.us), 1)),
+                                                               stack(stack), dynamic(stack == nullptr),
+                                                               tenants(tenantSlots) {
 }
 
 CTask::~CTask() {
-    for (CTenant* tenant : tenants) {
+    for (CTenant* tenant : GetTenants()) {
         tenant->Cleanup();
     }
 
     k_thread_abort(&thread);
-    if (stack != nullptr) {
+    if (dynamic && stack != nullptr) {
         k_thread_stack_free(stack);
         stack = nullptr;
     }
 }
 
 void CTask::Initialize() {
-    for (CTenant* tenant : tenants) {
+    for (CTenant* tenant : GetTenants()) {
         tenant->Startup();
     }
 
-    for (CTenant* tenant : tenants) {
+    for (CTenant* tenant : GetTenants()) {
         tenant->PostStartup();
     }
 
-    stack = k_thread_stack_alloc(stackSize, 0);
-    if (stack == nullptr) {
-        LOG_ERR("Failed to allocate stack for %s", name);
-        k_panic();
+    if (dynamic) {
+        stack = k_thread_stack_alloc(stackSize, 0);
+        if (stack == nullptr) {
+            LOG_ERR("Failed to allocate stack for %s", name);
+            k_panic();
+        }
+    }
+
+    if (IsPeriodic()) {
+        if (k_ticks_to_us_near64(periodTicks) != periodUs) {
+            LOG_WRN("%s period of %u us is not a whole number of ticks. Using %u us", name, periodUs,
+                    static_cast<uint32_t>(k_ticks_to_us_near64(periodTicks)));
+        }
+        nextReleaseTicks = k_uptime_ticks();
+    } else {
+        eventDriven = buildWaitSet();
+        LOG_DBG("%s is %s", name, eventDriven ? "event driven" : "cycling");
     }
 
     taskId = k_thread_create(&thread, stack, stackSize, taskEntryWrapper, this, nullptr, nullptr, priority, 0,
@@ -65,13 +114,194 @@ void CTask::Initialize() {
     k_thread_name_set(taskId, name);
 }
 
-void CTask::AddTenant(CTenant& tenant) {
-    tenants.push_back(&tenant);
+int CTask::AddTenant(CTenant& tenant) {
+    if (dynamic) {
+        dynamicTenants.push_back(&tenant);
+        tenants = dynamicTenants;
+    } else if (numTenants == tenants.size()) {
+        LOG_ERR("No room for %s in %s", tenant.GetName(), name);
+        return -ENOMEM;
+    } else {
+        tenants[numTenants] = &tenant;
+    }
+
+    numTenants++;
+    return 0;
 }
 
 void CTask::Run() {
-    for (CTenant* tenant : tenants) {
-        tenant->Run();
+    if (eventDriven) {
+        const uint32_t ready = waitSet.Wait();
+#ifdef CONFIG_F_CORE_HEALTH_MONITOR
+        checkIn();
+#endif
+        for (size_t i = 0; i < numTenants; i++) {
+            if (ready & BIT(i)) {
+                runTenant(*tenants[i]);
+            }
+        }
+        return;
+    }
+
+#ifdef CONFIG_F_CORE_HEALTH_MONITOR
+    checkIn();
+#endif
+
+    for (CTenant* tenant : GetTenants()) {
+        runTenant(*tenant);
+    }
+
+    if (IsPeriodic()) {
+        waitForNextRelease();
+    } else {
+        k_msleep(sleepTimeMs);
+    }
+}
+
+CTask::TimingStats CTask::GetTimingStats() const {
+    if (!IsPeriodic()) {
+        return {};
+    }
+
+    return {
+        .periodUs = periodUs,
+        .releases = releases,
+        .deadlineMisses = deadlineMisses,
+        .minPeriodUs = measuredPeriods > 0 ? minPeriodUs : 0,
+        .maxPeriodUs = maxPeriodUs,
+        .maxJitterUs = maxJitterUs,
+        .meanJitterUs = measuredPeriods > 0 ? static_cast<uint32_t>(totalJitterUs / measuredPeriods) : 0,
+    };
+}
+
+#ifdef CONFIG_F_CORE_TASK_STACK_REPORT
+CTask::StackUsage CTask::GetStackUsage() {
+    size_t unused = 0;
+    if (taskId != nullptr && k_thread_stack_space_get(&thread, &unused) == 0) {
+        // Zephyr counts the untouched fill pattern, so this is already a high water mark
+        peakStackUsed = MAX(peakStackUsed, thread.stack_info.size - unused);
+    }
+
+    // Rounded to 64 bytes, which covers the stack alignment of every target we run on
+    const size_t withMargin = peakStackUsed + peakStackUsed * CONFIG_F_CORE_TASK_STACK_MARGIN_PERCENT / 100;
+    return {
+        .size = stackSize,
+        .peakUsed = peakStackUsed,
+        .recommended = MAX(ROUND_UP(withMargin, 64), CONFIG_F_CORE_TASK_MIN_STACK_SIZE),
+    };
+}
+#endif
+
+void CTask::runTenant(CTenant& tenant) {
+#ifdef CONFIG_F_CORE_HEALTH_MONITOR
+    k_spinlock_key_t key = k_spin_lock(&healthLock);
+    runningTenant = &tenant;
+    tenantStartMs = k_uptime_get_32();
+    k_spin_unlock(&healthLock, key);
+#endif
+
+#ifdef CONFIG_F_CORE_TENANT_PROFILER
+    const uint64_t start = runningCycles();
+    tenant.Run();
+    // Truncating keeps the difference right when the 32 bit cycle counter wraps
+    tenant.GetProfile().Record(static_cast<uint32_t>(runningCycles() - start));
+#else
+    tenant.Run();
+#endif
+
+#ifdef CONFIG_F_CORE_HEALTH_MONITOR
+    key = k_spin_lock(&healthLock);
+    const uint32_t tookMs = k_uptime_get_32() - tenantStartMs;
+    runningTenant = nullptr;
+    if (deadlineMs != 0 && tookMs > deadlineMs) {
+        overruns++;
+        overrunTenant = &tenant;
+        overrunMs = tookMs;
+    }
+    if (cycleSlowestTenant == nullptr || tookMs > cycleSlowestMs) {
+        cycleSlowestTenant = &tenant;
+        cycleSlowestMs = tookMs;
+    }
+    k_spin_unlock(&healthLock, key);
+#endif
+}
+
+#ifdef CONFIG_F_CORE_HEALTH_MONITOR
+CTask::Health CTask::GetHealth() const {
+    k_spinlock_key_t key = k_spin_lock(&healthLock);
+    const uint32_t now = k_uptime_get_32();
+    const Health health = {
+        .checkIns = checkIns,
+        .sinceCheckInMs = checkIns > 0 ? now - lastCheckInMs : 0,
+        .overruns = overruns,
+        .overrunTenant = overrunTenant != nullptr ? overrunTenant->GetName() : nullptr,
+        .overrunMs = overrunMs,
+        .missTenant = missTenant != nullptr ? missTenant->GetName() : nullptr,
+        .runningTenant = runningTenant != nullptr ? runningTenant->GetName() : nullptr,
+        .runningForMs = runningTenant != nullptr ? now - tenantStartMs : 0,
+    };
+    k_spin_unlock(&healthLock, key);
+
+    return health;
+}
+
+void CTask::checkIn() {
+    k_spinlock_key_t key = k_spin_lock(&healthLock);
+    checkIns++;
+    lastCheckInMs = k_uptime_get_32();
+    cycleSlowestTenant = nullptr;
+    cycleSlowestMs = 0;
+    k_spin_unlock(&healthLock, key);
+}
+#endif
+
+bool CTask::buildWaitSet() {
+    if (numTenants > CWaitSet::maxTenants) {
+        return false;
+    }
+
+    for (size_t i = 0; i < numTenants; i++) {
+        waitSet.beginTenant(i);
+        tenants[i]->AddWaitSources(waitSet);
+        if (!waitSet.endTenant()) {
+            if (waitSet.ownerFailed) {
+                LOG_WRN("Could not add every wait source of %s in %s", tenants[i]->GetName(), name);
+            }
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void CTask::waitForNextRelease() {
+    nextReleaseTicks += periodTicks;
+    const int64_t now = k_uptime_ticks();
+    if (now >= nextReleaseTicks) {
+        // Stay on the same grid rather than running back to back to catch up
+        deadlineMisses++;
+        nextReleaseTicks += ((now - nextReleaseTicks) / periodTicks + 1) * periodTicks;
+        skippedRelease = true;
+#ifdef CONFIG_F_CORE_HEALTH_MONITOR
+        k_spinlock_key_t key = k_spin_lock(&healthLock);
+        missTenant = cycleSlowestTenant;
+        k_spin_unlock(&healthLock, key);
+#endif
+    }
+
+    k_sleep(K_TIMEOUT_ABS_TICKS(nextReleaseTicks));
+
+    const uint32_t cycles = k_cycle_get_32();
+    if (releases > 0 && !skippedRelease) {
+        const uint32_t measuredUs = k_cyc_to_us_floor32(cycles - lastReleaseCycles);
+        const uint32_t jitterUs = measuredUs > periodUs ? measuredUs - periodUs : periodUs - measuredUs;
+        minPeriodUs = MIN(minPeriodUs, measuredUs);
+        maxPeriodUs = MAX(maxPeriodUs, measuredUs);
+        maxJitterUs = MAX(maxJitterUs, jitterUs);
+        totalJitterUs += jitterUs;
+        measuredPeriods++;
     }
-    k_msleep(sleepTimeMs);
+    lastReleaseCycles = cycles;
+    skippedRelease = false;
+    releases++;
 }
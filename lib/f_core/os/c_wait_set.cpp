@@ -0,0 +1,173 @@
+/*
+* Copyright (c) 2025 RIT Launch Initiative
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Self Include
+#include <f_core/os/c_wait_set.h>
+
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(CWaitSet);
+
+bool CWaitSet::AddSemaphore(k_sem& sem) {
+#ifdef CONFIG_POLL
+    k_poll_event* event = nextEvent();
+    if (event != nullptr) {
+        k_poll_event_init(event, K_POLL_TYPE_SEM_AVAILABLE, K_POLL_MODE_NOTIFY_ONLY, &sem);
+        addedEvent();
+        return true;
+    }
+#endif
+    return failed();
+}
+
+bool CWaitSet::AddMessageQueue(k_msgq& queue) {
+#ifdef CONFIG_POLL
+    k_poll_event* event = nextEvent();
+    if (event != nullptr) {
+        k_poll_event_init(event, K_POLL_TYPE_MSGQ_DATA_AVAILABLE, K_POLL_MODE_NOTIFY_ONLY, &queue);
+        addedEvent();
+        return true;
+    }
+#endif
+    return failed();
+}
+
+bool CWaitSet::AddSignal(k_poll_signal& signal) {
+#ifdef CONFIG_POLL
+    k_poll_event* event = nextEvent();
+    if (event != nullptr) {
+        k_poll_event_init(event, K_POLL_TYPE_SIGNAL, K_POLL_MODE_NOTIFY_ONLY, &signal);
+        addedEvent();
+        return true;
+    }
+#endif
+    return failed();
+}
+
+bool CWaitSet::AddSocket(int socket) {
+#ifdef CONFIG_NET_SOCKETS
+    if (socket >= 0 && numSockets < maxSources) {
+        sockets[numSockets] = {.fd = socket, .events = ZSOCK_POLLIN, .revents = 0};
+        socketOwners[numSockets] = owner;
+        numSockets++;
+        ownerAdded = true;
+        return true;
+    }
+#endif
+    return failed();
+}
+
+bool CWaitSet::AddTimer(CSoftTimer& timer) {
+    if (numTimers >= maxSources) {
+        return failed();
+    }
+
+    timers[numTimers] = &timer;
+    timerDeadlines[numTimers] = 0;
+    timerOwners[numTimers] = owner;
+    numTimers++;
+    ownerAdded = true;
+    return true;
+}
+
+uint32_t CWaitSet::Wait() {
+    // Wake for the earliest running timer
+    int64_t wakeTicks = -1;
+    for (std::size_t i = 0; i < numTimers; i++) {
+        if (!timers[i]->IsRunning()) {
+            timerDeadlines[i] = 0;
+            continue;
+        }
+        if (timerDeadlines[i] == 0) {
+            timerDeadlines[i] = timers[i]->GetExpiryTicks();
+        }
+        if (wakeTicks < 0 || timerDeadlines[i] < wakeTicks) {
+            wakeTicks = timerDeadlines[i];
+        }
+    }
+
+#ifdef CONFIG_NET_SOCKETS
+    const bool haveSockets = numSockets > 0;
+#else
+    const bool haveSockets = false;
+#endif
+
+    if (numEvents > 0 && haveSockets) {
+        const int64_t socketCheckTicks = k_uptime_ticks() + k_ms_to_ticks_ceil64(CONFIG_F_CORE_TASK_SOCKET_POLL_MS);
+        if (wakeTicks < 0 || socketCheckTicks < wakeTicks) {
+            wakeTicks = socketCheckTicks;
+        }
+    }
+
+#ifdef CONFIG_POLL
+    for (std::size_t i = 0; i < numEvents; i++) {
+        events[i].state = K_POLL_STATE_NOT_READY;
+    }
+#endif
+
+    if (numEvents > 0) {
+#ifdef CONFIG_POLL
+        // Timing out is the same as nothing being ready, which the loop below sees anyway
+        k_poll(events.data(), numEvents, wakeTicks < 0 ? K_FOREVER : K_TIMEOUT_ABS_TICKS(wakeTicks));
+#endif
+    } else if (!haveSockets) {
+        k_sleep(wakeTicks < 0 ? K_FOREVER : K_TIMEOUT_ABS_TICKS(wakeTicks));
+    }
+
+    uint32_t ready = 0;
+#ifdef CONFIG_NET_SOCKETS
+    if (haveSockets) {
+        int timeoutMs = 0;
+        if (numEvents == 0) {
+            timeoutMs = wakeTicks < 0 ? -1 : k_ticks_to_ms_ceil32(MAX(wakeTicks - k_uptime_ticks(), 0));
+        }
+
+        if (zsock_poll(sockets.data(), numSockets, timeoutMs) > 0) {
+            for (std::size_t i = 0; i < numSockets; i++) {
+                if (sockets[i].revents & ZSOCK_POLLNVAL) {
+                    // Negative descriptors are skipped, so a closed socket can't keep waking the task
+                    LOG_ERR("Socket %d is not open. No longer waiting on it", sockets[i].fd);
+                    sockets[i].fd = -1;
+                } else if (sockets[i].revents != 0) {
+                    ready |= BIT(socketOwners[i]);
+                }
+                sockets[i].revents = 0;
+            }
+        }
+    }
+#endif
+
+#ifdef CONFIG_POLL
+    for (std::size_t i = 0; i < numEvents; i++) {
+        if (events[i].state != K_POLL_STATE_NOT_READY) {
+            ready |= BIT(eventOwners[i]);
+        }
+    }
+#endif
+
+    const int64_t now = k_uptime_ticks();
+    for (std::size_t i = 0; i < numTimers; i++) {
+        if (timers[i]->IsRunning() && timerDeadlines[i] != 0 && now >= timerDeadlines[i]) {
+            ready |= BIT(timerOwners[i]);
+            // Taken now rather than next wait, so an expiry while other tenants run isn't slept through
+            timerDeadlines[i] = timers[i]->GetExpiryTicks();
+        }
+    }
+
+    return ready;
+}
+
+void CWaitSet::beginTenant(std::size_t index) {
+    owner = index;
+    ownerAdded = false;
+    ownerFailed = false;
+}
+
+void CWaitSet::addedEvent() {
+    eventOwners[numEvents] = owner;
+    numEvents++;
+    ownerAdded = true;
+}
@@ -5,15 +5,41 @@
 
 LOG_MODULE_REGISTER(flight_log);
 
+namespace {
+constexpr uint32_t BINARY_MAGIC = 0x42474C46; // "FLGB"
+constexpr uint16_t BINARY_VERSION = 1;
+
+struct __attribute__((packed)) binary_file_header {
+    uint32_t magic;
+    uint16_t version;
+};
+
+struct __attribute__((packed)) binary_record_header {
+    uint32_t uptime_ms;
+    uint32_t format_id; //< 0 if the payload is plain text
+    uint8_t payload_len;
+};
+} // namespace
+
 CFlightLog::CFlightLog(const std::string &filename) : CFlightLog(filename.c_str(), k_uptime_get()) {}
 CFlightLog::CFlightLog(const char *filename) : CFlightLog(filename, k_uptime_get()) {}
-CFlightLog::CFlightLog(const char *filename, int64_t timestamp) {
+CFlightLog::CFlightLog(const char *filename, int64_t timestamp) : CFlightLog(filename, defaultEncoding) {}
+CFlightLog::CFlightLog(const char *filename, Encoding encoding) : encoding(encoding) {
     fs_file_t_init(&file);
     int err = fs_open(&file, filename, FS_O_CREATE | FS_O_APPEND);
     if (err < 0) {
         LOG_ERR("Failed to open flight log: %d", err);
         return;
     }
+
+    // Binary logs start with a header so the tools can tell them apart. Reopened logs keep the one they have
+    if (encoding == Encoding::Binary && fs_seek(&file, 0, FS_SEEK_END) == 0 && fs_tell(&file) == 0) {
+        const binary_file_header header{.magic = BINARY_MAGIC, .version = BINARY_VERSION};
+        err = fs_write(&file, &header, sizeof(header));
+        if (err < 0) {
+            LOG_ERR("Failed to write flight log header: %d", err);
+        }
+    }
     // Write opening message
     err = Write("flight log opened");
     if (err < 0) {
@@ -38,7 +64,28 @@ int CFlightLog::Write(int64_t timestamp, const char *msg) {
 int CFlightLog::Write(const char *msg, size_t str_len) { return Write(k_uptime_get(), msg, str_len); }
 
 int CFlightLog::Write(int64_t timestamp, const char *msg, size_t str_len) {
-    LOG_INF("message: %9lld: %s", timestamp, msg);
+    LOG_INF("message: %9lld: %.*s", timestamp, static_cast<int>(str_len), msg);
+    if (encoding == Encoding::Binary) {
+        return writeRecord(timestamp, 0, msg, MIN(str_len, maxPayloadSize));
+    }
+
+    // Short lines go out in one write
+    constexpr size_t timestamp_size = 11;
+    char line[timestamp_size + textBufferSize + 1];
+    if (str_len <= textBufferSize) {
+        int len = snprintf(line, sizeof(line), "%9lld: ", timestamp);
+        if (len == timestamp_size) {
+            memcpy(&line[len], msg, str_len);
+            line[len + str_len] = '\n';
+            int ret = fs_write(&file, line, len + str_len + 1);
+            if (ret < 0) {
+                LOG_ERR("Error writing message: %d", ret);
+                return ret;
+            }
+            return 0;
+        }
+    }
+
     int ret = writeTimestamp(timestamp);
     if (ret < 0) {
         LOG_ERR("Error writing timestamp: %d", ret);
@@ -62,6 +109,24 @@ int CFlightLog::Write(int64_t timestamp, const char *msg, size_t str_len) {
 int CFlightLog::Sync() { return fs_sync(&file); }
 int CFlightLog::Close() { return fs_close(&file); }
 
+int CFlightLog::writeRecord(int64_t timestamp, uint32_t id, const void *payload, size_t len) {
+    uint8_t record[sizeof(binary_record_header) + maxPayloadSize];
+    const binary_record_header header{
+        .uptime_ms = static_cast<uint32_t>(timestamp),
+        .format_id = id,
+        .payload_len = static_cast<uint8_t>(len),
+    };
+    memcpy(record, &header, sizeof(header));
+    memcpy(&record[sizeof(header)], payload, len);
+
+    int ret = fs_write(&file, record, sizeof(header) + len);
+    if (ret < 0) {
+        LOG_ERR("Error writing record: %d", ret);
+        return ret;
+    }
+    return 0;
+}
+
 int CFlightLog::writeTimestamp(int64_t timestamp) {
     constexpr size_t buf_size = 12; // max int64 is 19 + negative sign just in case + ': '
     char buf[buf_size] = {0};
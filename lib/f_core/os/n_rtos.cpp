@@ -5,18 +5,28 @@
  */
 
 #include <f_core/os/n_rtos.h>
+
+#include <array>
+#include <cstdio>
 #include <zephyr/logging/log.h>
 
 LOG_MODULE_REGISTER(NRtos);
 
-std::vector<CTask*> tasks;
+static std::array<CTask*, CONFIG_F_CORE_RTOS_MAX_TASKS> taskSlots;
+static size_t numTasks = 0;
+
+int NRtos::AddTask(CTask& task) {
+    if (numTasks == taskSlots.size()) {
+        LOG_ERR("No room for task %s. Raise CONFIG_F_CORE_RTOS_MAX_TASKS", task.GetName());
+        return -ENOMEM;
+    }
 
-void NRtos::AddTask(CTask& task) {
-    tasks.push_back(&task);
+    taskSlots[numTasks++] = &task;
+    return 0;
 }
 
 void NRtos::StartRtos() {
-    for (CTask* task : tasks) {
+    for (CTask* task : GetTasks()) {
         LOG_INF("Starting task %s", task->GetName());
         task->Initialize();
     }
@@ -25,7 +35,15 @@ void NRtos::StartRtos() {
 }
 
 void NRtos::StopRtos() {
-    for (CTask* task : tasks) {
+#ifdef CONFIG_F_CORE_TASK_STACK_REPORT
+    for (CTask* task : GetTasks()) {
+        const CTask::StackUsage usage = task->GetStackUsage();
+        LOG_INF("Task %s stack: used %zu of %zu bytes, recommend %zu", task->GetName(), usage.peakUsed, usage.size,
+                usage.recommended);
+    }
+#endif
+
+    for (CTask* task : GetTasks()) {
         LOG_INF("Stopping task %s", task->GetName());
         task->~CTask();
     }
@@ -33,3 +51,58 @@ void NRtos::StopRtos() {
     LOG_RAW("RTOS Stopped!\n");
     LOG_RAW("\n");
 }
+
+void NRtos::WriteTaskTimings(CFlightLog& flightLog) {
+    for (CTask* task : GetTasks()) {
+        if (!task->IsPeriodic()) {
+            continue;
+        }
+
+        const CTask::TimingStats timing = task->GetTimingStats();
+        flightLog.Write(FLIGHT_LOG_FORMAT("Task %s: %u us period, %u releases, %u deadline misses"), task->GetName(),
+                        timing.periodUs, timing.releases, timing.deadlineMisses);
+        flightLog.Write(FLIGHT_LOG_FORMAT("Task %s: measured period %u-%u us, jitter %u us max, %u us mean"),
+                        task->GetName(), timing.minPeriodUs, timing.maxPeriodUs, timing.maxJitterUs,
+                        timing.meanJitterUs);
+    }
+}
+
+std::span<CTask* const> NRtos::GetTasks() {
+    return std::span<CTask* const>(taskSlots).first(numTasks);
+}
+
+void NRtos::WriteTenantProfiles(CFlightLog& flightLog) {
+#ifdef CONFIG_F_CORE_TENANT_PROFILER
+    for (CTask* task : GetTasks()) {
+        for (const CTenant* tenant : task->GetTenants()) {
+            TenantProfileSnapshot snapshot{};
+            tenant->GetProfile().GetSnapshot(snapshot);
+            flightLog.Write(FLIGHT_LOG_FORMAT("Tenant %s/%s: %u runs, %u us min, %u us mean, %u us max"),
+                            task->GetName(), tenant->GetName(), snapshot.calls, snapshot.minUs, snapshot.meanUs,
+                            snapshot.maxUs);
+
+            // Only the buckets with anything in them, as "<2us:count <16us:count ...". Sized to fit a text log line
+            char histogram[80] = {0};
+            size_t len = 0;
+            for (size_t i = 0; i < TenantProfileSnapshot::durationBuckets && len < sizeof(histogram); i++) {
+                if (snapshot.durationUs[i] != 0) {
+                    len += snprintf(histogram + len, sizeof(histogram) - len, "%s<%uus:%u", len == 0 ? "" : " ",
+                                    2u << i, snapshot.durationUs[i]);
+                }
+            }
+            flightLog.Write(FLIGHT_LOG_FORMAT("Tenant %s run time: %s"), tenant->GetName(), histogram);
+        }
+    }
+#endif
+}
+
+void NRtos::WriteStackUsage(CFlightLog& flightLog) {
+#ifdef CONFIG_F_CORE_TASK_STACK_REPORT
+    for (CTask* task : GetTasks()) {
+        const CTask::StackUsage usage = task->GetStackUsage();
+        flightLog.Write(FLIGHT_LOG_FORMAT("Task %s stack: used %u of %u bytes, recommend %u"), task->GetName(),
+                        static_cast<uint32_t>(usage.peakUsed), static_cast<uint32_t>(usage.size),
+                        static_cast<uint32_t>(usage.recommended));
+    }
+#endif
+}
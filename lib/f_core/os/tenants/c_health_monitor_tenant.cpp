@@ -0,0 +1,228 @@
+/*
+* Copyright (c) 2025 RIT Launch Initiative
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Self Include
+#include <f_core/os/tenants/c_health_monitor_tenant.h>
+
+#include <f_core/os/c_wait_set.h>
+#include <zephyr/logging/log.h>
+#ifdef CONFIG_WATCHDOG
+#include <zephyr/drivers/watchdog.h>
+#endif
+
+LOG_MODULE_REGISTER(CHealthMonitorTenant);
+
+CHealthMonitorTenant::CHealthMonitorTenant(const char* name, CFlightLog* flightLog, uint32_t checkIntervalMs,
+                                           const device* watchdog, uint32_t watchdogTimeoutMs)
+    : CTenant(name), flightLog(flightLog), checkIntervalMs(checkIntervalMs), watchdog(watchdog),
+      watchdogTimeoutMs(watchdogTimeoutMs) {
+    k_msgq_init(&reports, reportBuffer, sizeof(Report), reportQueueLength);
+    k_work_init(&reportWork, writeReports);
+}
+
+int CHealthMonitorTenant::Watch(CTask& task, uint32_t deadlineMs, bool critical) {
+    if (numWatched == watched.size()) {
+        LOG_ERR("No room to watch %s", task.GetName());
+        return -ENOMEM;
+    }
+
+    if (deadlineMs == 0) {
+        if (!task.IsPeriodic()) {
+            LOG_ERR("%s isn't periodic, so it needs a deadline", task.GetName());
+            return -EINVAL;
+        }
+        deadlineMs = DIV_ROUND_UP(task.GetTimingStats().periodUs, 1000);
+    }
+
+    task.SetDeadline(deadlineMs);
+    watched[numWatched++] = {
+        .task = &task,
+        .deadlineMs = deadlineMs,
+        .critical = critical,
+        .stalled = false,
+        .missedCheckIn = false,
+        .lastOverruns = 0,
+        .lastDeadlineMisses = 0,
+        .counters = {.stalls = 0, .missedCheckIns = 0, .overruns = 0, .deadlineMisses = 0, .healthy = true},
+    };
+    return 0;
+}
+
+CHealthMonitorTenant::Counters CHealthMonitorTenant::GetCounters(const CTask& task) const {
+    for (std::size_t i = 0; i < numWatched; i++) {
+        if (watched[i].task == &task) {
+            return watched[i].counters;
+        }
+    }
+
+    return {};
+}
+
+void CHealthMonitorTenant::Startup() {
+    timer.StartTimer(checkIntervalMs);
+
+#ifdef CONFIG_WATCHDOG
+    if (watchdog == nullptr) {
+        return;
+    }
+
+    if (!device_is_ready(watchdog)) {
+        LOG_ERR("Watchdog %s is not ready", watchdog->name);
+        watchdog = nullptr;
+        return;
+    }
+
+    const wdt_timeout_cfg config = {
+        .window = {.min = 0, .max = watchdogTimeoutMs},
+        .callback = nullptr,
+        .flags = WDT_FLAG_RESET_SOC,
+    };
+    watchdogChannel = wdt_install_timeout(watchdog, &config);
+    if (watchdogChannel < 0) {
+        LOG_ERR("Failed to install watchdog timeout (%d)", watchdogChannel);
+        watchdog = nullptr;
+        return;
+    }
+
+    const int ret = wdt_setup(watchdog, WDT_OPT_PAUSE_HALTED_BY_DBG);
+    if (ret < 0) {
+        LOG_ERR("Failed to start watchdog (%d)", ret);
+        watchdog = nullptr;
+    }
+#endif
+}
+
+void CHealthMonitorTenant::AddWaitSources(CWaitSet& waitSet) {
+    waitSet.AddTimer(timer);
+}
+
+void CHealthMonitorTenant::Run() {
+    if (!timer.IsExpired()) {
+        return;
+    }
+
+    bool allHealthy = true;
+    for (std::size_t i = 0; i < numWatched; i++) {
+        if (!check(watched[i]) && watched[i].critical) {
+            allHealthy = false;
+        }
+    }
+    healthy = allHealthy;
+
+#ifdef CONFIG_WATCHDOG
+    if (healthy && watchdog != nullptr) {
+        wdt_feed(watchdog, watchdogChannel);
+    }
+#endif
+}
+
+bool CHealthMonitorTenant::check(WatchedTask& watchedTask) {
+    CTask& task = *watchedTask.task;
+    const CTask::Health health = task.GetHealth();
+    const int64_t now = k_uptime_get();
+
+    // Overruns are only counted once the run finishes, so a tenant that never returns shows up as a stall instead
+    if (health.overruns != watchedTask.lastOverruns) {
+        const uint32_t count = health.overruns - watchedTask.lastOverruns;
+        watchedTask.lastOverruns = health.overruns;
+        watchedTask.counters.overruns += count;
+        report({now, Problem::Overrun, task.GetName(), health.overrunTenant, health.overrunMs, count});
+    }
+
+    if (task.IsPeriodic()) {
+        const uint32_t deadlineMisses = task.GetTimingStats().deadlineMisses;
+        if (deadlineMisses != watchedTask.lastDeadlineMisses) {
+            const uint32_t count = deadlineMisses - watchedTask.lastDeadlineMisses;
+            watchedTask.lastDeadlineMisses = deadlineMisses;
+            watchedTask.counters.deadlineMisses += count;
+            report({now, Problem::DeadlineMiss, task.GetName(), health.missTenant, 0, count});
+        }
+    }
+
+    const bool stalled = health.runningTenant != nullptr && health.runningForMs > watchedTask.deadlineMs;
+    if (stalled && !watchedTask.stalled) {
+        watchedTask.counters.stalls++;
+        report({now, Problem::Stall, task.GetName(), health.runningTenant, health.runningForMs, 0});
+    }
+
+    // Event driven tasks can wait as long as they have nothing to do. Tasks that haven't started yet aren't late
+    const bool missedCheckIn = !stalled && !task.IsEventDriven() && health.checkIns > 0 &&
+                               health.sinceCheckInMs > 2 * watchedTask.deadlineMs;
+    if (missedCheckIn && !watchedTask.missedCheckIn) {
+        watchedTask.counters.missedCheckIns++;
+        report({now, Problem::MissedCheckIn, task.GetName(), nullptr, health.sinceCheckInMs, 0});
+    }
+
+    const bool wasHealthy = !watchedTask.stalled && !watchedTask.missedCheckIn;
+    watchedTask.stalled = stalled;
+    watchedTask.missedCheckIn = missedCheckIn;
+    watchedTask.counters.healthy = !stalled && !missedCheckIn;
+    if (watchedTask.counters.healthy && !wasHealthy) {
+        report({now, Problem::Recovered, task.GetName(), nullptr, 0, 0});
+    }
+
+    return watchedTask.counters.healthy;
+}
+
+void CHealthMonitorTenant::report(const Report& report) {
+    switch (report.problem) {
+    case Problem::Stall:
+        LOG_ERR("%s stalled in %s for %u ms", report.task, report.tenant, report.ms);
+        break;
+    case Problem::MissedCheckIn:
+        LOG_ERR("%s hasn't started a cycle in %u ms", report.task, report.ms);
+        break;
+    case Problem::Recovered:
+        LOG_INF("%s recovered", report.task);
+        break;
+    case Problem::Overrun:
+    case Problem::DeadlineMiss:
+        // Already counted, and can happen every cycle, so only the flight log gets these
+        break;
+    }
+
+    if (flightLog == nullptr) {
+        return;
+    }
+
+    // A full queue means the work queue is behind. The counters still have everything
+    if (k_msgq_put(&reports, &report, K_NO_WAIT) != 0) {
+        LOG_WRN("Health report queue full. Dropped a report on %s", report.task);
+        return;
+    }
+    k_work_submit(&reportWork);
+}
+
+void CHealthMonitorTenant::writeReports(k_work* work) {
+    CHealthMonitorTenant* monitor = CONTAINER_OF(work, CHealthMonitorTenant, reportWork);
+    CFlightLog& flightLog = *monitor->flightLog;
+
+    Report report{};
+    while (k_msgq_get(&monitor->reports, &report, K_NO_WAIT) == 0) {
+        const char* tenant = report.tenant != nullptr ? report.tenant : "unknown tenant";
+        switch (report.problem) {
+        case Problem::Stall:
+            flightLog.Write(report.timestamp, FLIGHT_LOG_FORMAT("Health: %s stalled in %s for %u ms"), report.task,
+                            tenant, report.ms);
+            break;
+        case Problem::MissedCheckIn:
+            flightLog.Write(report.timestamp, FLIGHT_LOG_FORMAT("Health: %s hasn't started a cycle in %u ms"),
+                            report.task, report.ms);
+            break;
+        case Problem::Recovered:
+            flightLog.Write(report.timestamp, FLIGHT_LOG_FORMAT("Health: %s recovered"), report.task);
+            break;
+        case Problem::Overrun:
+            flightLog.Write(report.timestamp, FLIGHT_LOG_FORMAT("Health: %s overran %u times, last %s for %u ms"),
+                            report.task, report.count, tenant, report.ms);
+            break;
+        case Problem::DeadlineMiss:
+            flightLog.Write(report.timestamp, FLIGHT_LOG_FORMAT("Health: %s missed %u releases, slowest %s"),
+                            report.task, report.count, tenant);
+            break;
+        }
+    }
+}
@@ -0,0 +1,66 @@
+"""
+Collects the format strings of FLIGHT_LOG_FORMAT (f_core/os/flight_log.hpp) in a build's sources into a JSON dictionary
+of format id to format string, which data_log_check/flight_log_decode.py needs to render binary flight logs.
+"""
+import argparse
+import ast
+import json
+import os
+import re
+
+SOURCE_EXTENSIONS = (".c", ".cpp", ".h", ".hpp")
+
+# FLIGHT_LOG_FORMAT("...") with any number of adjacent string literals. The macro's own definition takes an identifier
+FORMAT_PATTERN = re.compile(r'FLIGHT_LOG_FORMAT\(\s*((?:"(?:[^"\\\n]|\\.)*"\s*)+)\)')
+LITERAL_PATTERN = re.compile(r'"(?:[^"\\\n]|\\.)*"')
+
+
+def format_id(format_string):
+    """Same as NFlightLog::FormatId (32 bit FNV-1a, with 0 reserved for plain text)"""
+    value = 2166136261
+    for byte in format_string.encode():
+        value = ((value ^ byte) * 16777619) & 0xFFFFFFFF
+    return value if value != 0 else 1
+
+
+def collect_formats(paths):
+    """
+    :param paths: source files and directories to search
+    :return: dict of format id to format string
+    """
+    files = []
+    for path in paths:
+        if os.path.isdir(path):
+            for root, _, names in os.walk(path):
+                files += [os.path.join(root, name) for name in names if name.endswith(SOURCE_EXTENSIONS)]
+        else:
+            files.append(path)
+
+    formats = {}
+    for file_path in sorted(files):
+        with open(file_path, "r", errors="replace") as file:
+            source = file.read()
+        for match in FORMAT_PATTERN.finditer(source):
+            format_string = "".join(ast.literal_eval(literal) for literal in LITERAL_PATTERN.findall(match.group(1)))
+            fid = format_id(format_string)
+            if fid in formats and formats[fid] != format_string:
+                raise ValueError(f"Format id {fid:#010x} of '{format_string}' in {file_path} is already used by "
+                                 f"'{formats[fid]}'")
+            formats[fid] = format_string
+    return formats
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Collect flight log format strings into a dictionary.')
+    parser.add_argument("-s", "--sources", nargs='+', help="Source files and directories to search")
+    parser.add_argument("-o", "--output", help="Output file to write to")
+
+    args = parser.parse_args()
+
+    formats = collect_formats(args.sources)
+    contents = json.dumps({f"{fid:#010x}": fmt for fid, fmt in sorted(formats.items())}, indent=2) + "\n"
+
+    # Only touch the output if it changed, so nothing downstream rebuilds for nothing
+    if not os.path.exists(args.output) or open(args.output).read() != contents:
+        with open(args.output, 'w') as f:
+            f.write(contents)
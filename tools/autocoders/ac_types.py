@@ -3,6 +3,23 @@ from datetime import datetime
 import yaml
 import jinja2
 import os
+import zlib
+
+# Primitive field types the autocoder can describe, mapped to (kind, size in bytes)
+PRIMITIVE_TYPES = {
+    'float': ('Float', 4),
+    'double': ('Float', 8),
+    'int8_t': ('Signed', 1),
+    'int16_t': ('Signed', 2),
+    'int32_t': ('Signed', 4),
+    'int64_t': ('Signed', 8),
+    'char': ('Signed', 1),
+    'uint8_t': ('Unsigned', 1),
+    'uint16_t': ('Unsigned', 2),
+    'uint32_t': ('Unsigned', 4),
+    'uint64_t': ('Unsigned', 8),
+    'bool': ('Unsigned', 1),
+}
 
 def parse_yaml_types(file_paths):
     types_list = []
@@ -21,6 +38,51 @@ def parse_yaml_types(file_paths):
 
     return types_list
 
+def flatten_type(type_name, types_by_name, prefix="", offset=0):
+    """
+    Flatten a type down to its primitive fields. Types are packed, so fields follow each other with no padding.
+    :return: list of (name, offset, size, kind) tuples, or None if the type contains something that can't be described
+    """
+    fields = []
+    for field in types_by_name[type_name]['fields']:
+        name = prefix + field['name']
+        if field['type'] in PRIMITIVE_TYPES:
+            kind, size = PRIMITIVE_TYPES[field['type']]
+            fields.append((name, offset, size, kind))
+            offset += size
+        elif field['type'] in types_by_name:
+            nested = flatten_type(field['type'], types_by_name, name + ".", offset)
+            if nested is None:
+                return None
+            fields += nested
+            offset += sum(f[2] for f in nested)
+        else:
+            return None
+
+    return fields
+
+def schema_hash(type_name, fields):
+    """
+    Hash of a type's flattened layout. Changes whenever a field is added, removed, renamed, resized or reordered
+    """
+    layout = type_name + ";" + ";".join(f"{name}:{kind}{size}@{offset}" for name, offset, size, kind in fields)
+    return zlib.crc32(layout.encode())
+
+def get_layouts(types):
+    """
+    Get the flattened layout of every type that can be described
+    :return: list of (type name, fields, total size, schema hash) tuples
+    """
+    types_by_name = dict(types)
+    layouts = []
+    for type_name, _ in types:
+        fields = flatten_type(type_name, types_by_name)
+        if fields is None:
+            continue
+        layouts.append((type_name, fields, sum(f[2] for f in fields), schema_hash(type_name, fields)))
+
+    return layouts
+
 if __name__ == '__main__':
     template_path = __file__.split(os.path.basename(__file__))[0] + "templates/ac_types.h"
     template = jinja2.Template(open(template_path).read())
@@ -36,4 +98,4 @@ if __name__ == '__main__':
     types = parse_yaml_types(file_paths)
 
     with open(args.output, 'w') as f:
-        f.write(template.render(files=file_paths, types=types, date_time=datetime.now()))
+        f.write(template.render(files=file_paths, types=types, layouts=get_layouts(types), date_time=datetime.now()))
@@ -17,6 +17,10 @@ namespace NNetworkDefs {
     static constexpr uint16_t GENERAL_COMMAND_PORT = {{ general.commandPort }};
 
     static constexpr uint16_t ALERT_PORT = {{ general.alertPort }};
+
+    static constexpr uint16_t STATS_PORT = {{ general.statsPort }};
+
+    static constexpr uint16_t PROFILE_PORT = {{ general.profilePort }};
     {% for module_name, module_info in modules.items() %}
     // {{ module_name.capitalize() }} Module
     static constexpr const char* {{ module_name.upper() }}_MODULE_IP_ADDR_BASE = "10.{{ module_info.id }}";
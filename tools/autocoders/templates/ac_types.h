@@ -14,6 +14,31 @@ namespace NTypes { {% for t in types %}
         {%- for field in t[1].fields %}
         {{ field.type }} {{ field.name }}; {% endfor %}
     } {{ t[0] }};
+{% endfor %}
+    // Kinds of primitive fields a type can be flattened into
+    enum class FieldKind : uint8_t { Float, Signed, Unsigned };
+
+    // A primitive field somewhere inside a type. Nested fields are named with their full path (e.g. Outer.Inner)
+    struct FieldInfo {
+        const char *name;
+        uint16_t offset;
+        uint8_t size;
+        FieldKind kind;
+    };
+
+    // Flattened layout of a type, for code that walks any type field by field
+    template <typename T>
+    struct TypeInfo;
+{% for layout in layouts %}
+    template <>
+    struct TypeInfo<{{ layout[0] }}> {
+        static constexpr const char *name = "{{ layout[0] }}";
+        static constexpr uint32_t schemaHash = {{ "0x%08X" | format(layout[3]) }};
+        static constexpr FieldInfo fields[] = { {%- for field in layout[1] %}
+            {"{{ field[0] }}", {{ field[1] }}, {{ field[2] }}, FieldKind::{{ field[3] }}},{% endfor %}
+        };
+    };
+    static_assert(sizeof({{ layout[0] }}) == {{ layout[2] }}, "Layout of {{ layout[0] }} does not match its definition");
 {% endfor -%}
 }
 
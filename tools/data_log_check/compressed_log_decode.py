@@ -0,0 +1,199 @@
+"""
+Decoder for logs written by CCompressedDataLogger (see detail::compressed_datalogger in f_core/os/c_datalogger.h).
+
+The record layout comes from the same YAML files the types autocoder reads, so any autocoded type can be decoded.
+Decoded records are written back out as plain packed structs, the same as an uncompressed CDataLogger file, so the
+other data_log_check scripts can read them.
+"""
+import argparse
+import os
+import struct
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "autocoders"))
+from ac_types import parse_yaml_types, get_layouts
+
+HEADER_FORMAT = "<IHHHHI"
+HEADER_SIZE = struct.calcsize(HEADER_FORMAT)
+HEADER_MAGIC = 0x474F4C43
+HEADER_VERSION = 1
+
+KEYFRAME_MARKER = b"\xFFKFR"
+MAX_DELTA_SIZE = 254
+NO_WINDOW = 0xFF
+
+
+def crc16_ccitt(data, seed=0xFFFF):
+    """Same as Zephyr's crc16_ccitt (reflected 0x8408 polynomial)"""
+    crc = seed
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0x8408 if crc & 1 else crc >> 1
+    return crc
+
+
+class BitReader:
+    def __init__(self, data):
+        self.value = int.from_bytes(data, "big")
+        self.remaining = len(data) * 8
+
+    def get(self, num_bits):
+        if num_bits > self.remaining:
+            raise ValueError("Ran off the end of a delta record")
+        self.remaining -= num_bits
+        return (self.value >> self.remaining) & ((1 << num_bits) - 1)
+
+
+def load_field(record, offset, size, kind):
+    value = int.from_bytes(record[offset:offset + size], "little", signed=(kind == "Signed"))
+    return value & 0xFFFFFFFFFFFFFFFF
+
+
+def store_field(record, offset, size, value):
+    record[offset:offset + size] = (value & ((1 << (8 * size)) - 1)).to_bytes(size, "little")
+
+
+class Decoder:
+    def __init__(self, fields, record_size):
+        self.fields = fields
+        self.record_size = record_size
+        self.previous = None
+        self.windows = []
+
+    def keyframe(self, record):
+        self.previous = bytearray(record)
+        self.windows = [(NO_WINDOW, 0)] * len(self.fields)
+        return bytes(record)
+
+    def delta(self, payload):
+        reader = BitReader(payload)
+        record = bytearray(self.previous)
+
+        for i, (_, offset, size, kind) in enumerate(self.fields):
+            prior = load_field(self.previous, offset, size, kind)
+            if kind == "Float":
+                width = size * 8
+                window_bits = 5 if width == 32 else 6
+                if reader.get(1) == 0:
+                    continue
+                if reader.get(1) == 0:
+                    leading, trailing = self.windows[i]
+                    if leading == NO_WINDOW:
+                        raise ValueError("Reused a window that was never sent")
+                else:
+                    leading = reader.get(window_bits)
+                    meaningful = reader.get(window_bits) + 1
+                    trailing = width - leading - meaningful
+                    self.windows[i] = (leading, trailing)
+                xored = reader.get(width - leading - trailing) << trailing
+                store_field(record, offset, size, prior ^ xored)
+            else:
+                prefix = 0
+                while prefix < 4 and reader.get(1) == 1:
+                    prefix += 1
+                zigzag = 0 if prefix == 0 else reader.get([7, 16, 32, 64][prefix - 1])
+                delta = (zigzag >> 1) ^ -(zigzag & 1)
+                store_field(record, offset, size, prior + delta)
+
+        self.previous = record
+        return bytes(record)
+
+
+def find_keyframe(data, start, record_size):
+    """Find the next keyframe with a valid crc at or after start. Returns its offset or None"""
+    pos = data.find(KEYFRAME_MARKER, start)
+    while pos >= 0:
+        body = data[pos + len(KEYFRAME_MARKER):pos + len(KEYFRAME_MARKER) + 4 + record_size + 2]
+        if len(body) == 4 + record_size + 2:
+            (crc,) = struct.unpack_from("<H", body, 4 + record_size)
+            if crc16_ccitt(body[:4 + record_size]) == crc:
+                return pos
+        pos = data.find(KEYFRAME_MARKER, pos + 1)
+    return None
+
+
+def decode(data, fields, record_size, start=HEADER_SIZE):
+    """
+    Decode a compressed log, skipping ahead to the next keyframe whenever something doesn't decode
+    :param start: offset to start decoding at. 0 for slices of a log that don't include its header (see log_index.py)
+    :return: list of (record index, raw record bytes)
+    """
+    decoder = Decoder(fields, record_size)
+    records = []
+    keyframe_size = len(KEYFRAME_MARKER) + 4 + record_size + 2
+    index = None
+    pos = start
+
+    while pos < len(data):
+        try:
+            if data.startswith(KEYFRAME_MARKER, pos):
+                body = data[pos + len(KEYFRAME_MARKER):pos + keyframe_size]
+                if len(body) < keyframe_size - len(KEYFRAME_MARKER):
+                    break
+                (crc,) = struct.unpack_from("<H", body, 4 + record_size)
+                if crc16_ccitt(body[:4 + record_size]) != crc:
+                    raise ValueError("Bad keyframe crc")
+                (index,) = struct.unpack_from("<I", body)
+                records.append((index, decoder.keyframe(body[4:4 + record_size])))
+                pos += keyframe_size
+            else:
+                length = data[pos]
+                if index is None or length == 0 or length > MAX_DELTA_SIZE or pos + 1 + length > len(data):
+                    raise ValueError("Bad delta record")
+                index += 1
+                records.append((index, decoder.delta(data[pos + 1:pos + 1 + length])))
+                pos += 1 + length
+        except ValueError as err:
+            resync = find_keyframe(data, pos + 1, record_size)
+            print(f"{err} at offset {pos}. " +
+                  ("Stopping" if resync is None else f"Skipping {resync - pos} bytes to the next keyframe"))
+            if resync is None:
+                break
+            pos = resync
+
+    return records
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode a log written by CCompressedDataLogger")
+    parser.add_argument("-f", "--files", nargs='+', required=True, help="Type YAML files the module was built with")
+    parser.add_argument("-t", "--type", required=True, help="Name of the logged type (e.g. SensorData)")
+    parser.add_argument("-i", "--input", required=True, help="Compressed log pulled off the module")
+    parser.add_argument("-o", "--output", required=True, help="File to write the decoded, uncompressed records to")
+    args = parser.parse_args()
+
+    layouts = {name: (fields, size, schema) for name, fields, size, schema in get_layouts(parse_yaml_types(args.files))}
+    if args.type not in layouts:
+        print(f"{args.type} is not an autocoded type made of primitive fields")
+        sys.exit(1)
+    fields, record_size, schema = layouts[args.type]
+
+    with open(args.input, "rb") as file:
+        data = file.read()
+
+    magic, version, header_record_size, num_fields, keyframe_interval, header_schema = \
+        struct.unpack_from(HEADER_FORMAT, data) if len(data) >= HEADER_SIZE else (0, 0, 0, 0, 0, 0)
+    start = HEADER_SIZE
+    if magic != HEADER_MAGIC or version != HEADER_VERSION:
+        # Slices cut with log_index.py or the TFTP server start wherever the index pointed, with no header
+        print("No compressed log header, so this is a slice (or the header was lost). Decoding from the first keyframe")
+        start = 0
+    elif header_record_size != record_size or num_fields != len(fields) or header_schema != schema:
+        print(f"Log was written with a different layout of {args.type} (schema {header_schema:08X}, "
+              f"expected {schema:08X})")
+        sys.exit(1)
+    else:
+        print(f"{args.type}: {record_size} byte records, keyframe every {keyframe_interval}")
+
+    records = decode(data, fields, record_size, start)
+    with open(args.output, "wb") as file:
+        for _, record in records:
+            file.write(record)
+
+    print(f"Decoded {len(records)} records from {len(data)} bytes "
+          f"({len(records) * record_size / max(len(data), 1):.2f}x compression)")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,119 @@
+"""
+Renders binary flight logs (see CFlightLog in f_core/os/flight_log.hpp) as the text a text flight log would have had.
+
+Format strings come from the dictionary the build writes (flight_log_dictionary.json in the build directory), or can be
+collected straight from the sources the module was built from.
+"""
+import argparse
+import json
+import os
+import re
+import struct
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "autocoders"))
+from ac_flight_log_dict import collect_formats
+
+FILE_HEADER_FORMAT = "<IH"
+FILE_HEADER_SIZE = struct.calcsize(FILE_HEADER_FORMAT)
+FILE_MAGIC = 0x42474C46
+FILE_VERSION = 1
+
+RECORD_HEADER_FORMAT = "<IIB"
+RECORD_HEADER_SIZE = struct.calcsize(RECORD_HEADER_FORMAT)
+TEXT_FORMAT_ID = 0
+
+ARG_FORMATS = {b"i": "<i", b"u": "<I", b"I": "<q", b"U": "<Q", b"f": "<f", b"d": "<d"}
+
+# C length modifiers mean nothing to Python's % formatting
+LENGTH_MODIFIER_PATTERN = re.compile(r"(%[-+ #0]*\d*(?:\.\d+)?)(?:hh|h|ll|l|z|j|t|L)([diouxXeEfgGcs])")
+
+
+def unpack_args(payload):
+    args = []
+    pos = 0
+    while pos < len(payload):
+        tag = payload[pos:pos + 1]
+        pos += 1
+        if tag == b"s":
+            length = payload[pos]
+            args.append(payload[pos + 1:pos + 1 + length].decode(errors="replace"))
+            pos += 1 + length
+        elif tag in ARG_FORMATS:
+            args.append(struct.unpack_from(ARG_FORMATS[tag], payload, pos)[0])
+            pos += struct.calcsize(ARG_FORMATS[tag])
+        else:
+            raise ValueError(f"Unknown argument type {tag}")
+    return args
+
+
+def render(fmt, args):
+    if not args:
+        # The device writes these as they are
+        return fmt
+    try:
+        return LENGTH_MODIFIER_PATTERN.sub(r"\1\2", fmt) % tuple(args)
+    except (TypeError, ValueError):
+        return f"{fmt} {args}"
+
+
+def decode(data, formats):
+    """
+    Render every record of a binary flight log. Stops at a record cut short (usually by power loss at the end of the
+    log)
+    :param formats: dict of format id to format string
+    :return: list of lines like a text flight log's
+    """
+    magic, version = struct.unpack_from(FILE_HEADER_FORMAT, data)
+    if magic != FILE_MAGIC or version != FILE_VERSION:
+        raise ValueError("Not a binary flight log")
+
+    lines = []
+    pos = FILE_HEADER_SIZE
+    while pos + RECORD_HEADER_SIZE <= len(data):
+        uptime, format_id, length = struct.unpack_from(RECORD_HEADER_FORMAT, data, pos)
+        pos += RECORD_HEADER_SIZE
+        if pos + length > len(data):
+            print(f"Record cut short at offset {pos - RECORD_HEADER_SIZE}", file=sys.stderr)
+            break
+        payload = data[pos:pos + length]
+        pos += length
+
+        if format_id == TEXT_FORMAT_ID:
+            message = payload.decode(errors="replace")
+        elif format_id in formats:
+            message = render(formats[format_id], unpack_args(payload))
+        else:
+            message = f"<unknown format {format_id:#010x}> {unpack_args(payload)}"
+        lines.append(f"{uptime:9d}: {message}")
+    return lines
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Render a binary flight log as text")
+    parser.add_argument("-i", "--input", required=True, help="Binary flight log pulled off the module")
+    parser.add_argument("-o", "--output", help="File to write the text log to. Printed if not given")
+    parser.add_argument("-d", "--dictionary", help="flight_log_dictionary.json from the module's build")
+    parser.add_argument("-s", "--sources", nargs='+', help="Source files and directories to collect formats from "
+                                                           "instead of a dictionary")
+    args = parser.parse_args()
+
+    formats = {}
+    if args.dictionary:
+        with open(args.dictionary) as file:
+            formats = {int(fid, 16): fmt for fid, fmt in json.load(file).items()}
+    if args.sources:
+        formats.update(collect_formats(args.sources))
+
+    with open(args.input, "rb") as file:
+        lines = decode(file.read(), formats)
+
+    if args.output:
+        with open(args.output, "w") as file:
+            file.writelines(line + "\n" for line in lines)
+    else:
+        print("\n".join(lines))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,187 @@
+"""
+Decoder for logs written by CFramedDataLogger (see detail::framed_datalogger in f_core/os/c_datalogger.h).
+
+Checks every block's crc, reports dropped samples and the real sample rate, and writes the records back out as plain
+packed structs (the same as an uncompressed CDataLogger file) for the other data_log_check scripts. Optionally writes
+a CSV of each record's sequence number and uptime, with its fields if the type YAML files are given.
+"""
+import argparse
+import csv
+import os
+import struct
+import sys
+import zlib
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "autocoders"))
+from ac_types import parse_yaml_types, get_layouts
+
+FILE_HEADER_FORMAT = "<IHHII32sI"
+FILE_HEADER_SIZE = struct.calcsize(FILE_HEADER_FORMAT)
+FILE_MAGIC = 0x474F4C46
+FILE_VERSION = 1
+
+BLOCK_HEADER_FORMAT = "<IHHIII"
+BLOCK_HEADER_SIZE = struct.calcsize(BLOCK_HEADER_FORMAT)
+BLOCK_MAGIC = 0x4B4C4246
+BLOCK_MAGIC_BYTES = struct.pack("<I", BLOCK_MAGIC)
+
+RECORD_HEADER_FORMAT = "<HH"
+RECORD_HEADER_SIZE = struct.calcsize(RECORD_HEADER_FORMAT)
+
+FIELD_FORMATS = {("Float", 4): "f", ("Float", 8): "d", ("Signed", 1): "b", ("Signed", 2): "h", ("Signed", 4): "i",
+                 ("Signed", 8): "q", ("Unsigned", 1): "B", ("Unsigned", 2): "H", ("Unsigned", 4): "I",
+                 ("Unsigned", 8): "Q"}
+
+
+def read_file_header(data):
+    magic, version, record_size, schema_hash, block_size, type_name, crc = struct.unpack_from(FILE_HEADER_FORMAT, data)
+    if magic != FILE_MAGIC or version != FILE_VERSION:
+        raise ValueError("Not a framed log")
+    if zlib.crc32(data[:FILE_HEADER_SIZE - 4]) != crc:
+        raise ValueError("Framed log header is corrupt")
+    return record_size, schema_hash, block_size, type_name.split(b"\0")[0].decode()
+
+
+def decode_block(data, pos, record_size):
+    """
+    Decode the block at pos
+    :return: (list of (sequence, uptime_ms, record bytes), offset just past the block)
+    """
+    if len(data) - pos < BLOCK_HEADER_SIZE:
+        raise ValueError("Truncated block header")
+    magic, length, count, first_sequence, base_uptime, crc = struct.unpack_from(BLOCK_HEADER_FORMAT, data, pos)
+    if magic != BLOCK_MAGIC:
+        raise ValueError("Bad block magic")
+    end = pos + BLOCK_HEADER_SIZE + length
+    if end > len(data) or length != count * (RECORD_HEADER_SIZE + record_size):
+        raise ValueError("Bad block length")
+
+    payload = data[pos + BLOCK_HEADER_SIZE:end]
+    if zlib.crc32(payload, zlib.crc32(data[pos:pos + BLOCK_HEADER_SIZE - 4])) != crc:
+        raise ValueError("Bad block crc")
+
+    records = []
+    uptime = base_uptime
+    for offset in range(0, length, RECORD_HEADER_SIZE + record_size):
+        uptime_delta, sequence_offset = struct.unpack_from(RECORD_HEADER_FORMAT, payload, offset)
+        uptime += uptime_delta
+        record = payload[offset + RECORD_HEADER_SIZE:offset + RECORD_HEADER_SIZE + record_size]
+        records.append((first_sequence + sequence_offset, uptime, record))
+
+    return records, end
+
+
+def skip_by_length(data, pos):
+    """
+    Find the end of a bad block from its length, if the length leads to another block (or the end of the file)
+    :return: offset of the next block, or None if the length can't be trusted
+    """
+    if len(data) - pos < BLOCK_HEADER_SIZE or not data.startswith(BLOCK_MAGIC_BYTES, pos):
+        return None
+    (length,) = struct.unpack_from("<H", data, pos + 4)
+    end = pos + BLOCK_HEADER_SIZE + length
+    if end == len(data) or data.startswith(BLOCK_MAGIC_BYTES, end):
+        return end
+    return None
+
+
+def decode(data, record_size, start=FILE_HEADER_SIZE):
+    """
+    Decode every intact block. A bad block is skipped by its length if that looks sane, otherwise by searching for the
+    next block magic from where it started
+    :return: (list of (sequence, uptime_ms, record bytes), number of bad blocks)
+    """
+    records = []
+    bad_blocks = 0
+    pos = start
+
+    while pos < len(data):
+        try:
+            block_records, pos = decode_block(data, pos, record_size)
+            records += block_records
+        except ValueError as err:
+            bad_blocks += 1
+            resync = skip_by_length(data, pos)
+            if resync is None:
+                resync = data.find(BLOCK_MAGIC_BYTES, pos + 1)
+            print(f"{err} at offset {pos}. " +
+                  ("Stopping" if resync < 0 else f"Skipping {resync - pos} bytes to the next block"))
+            if resync < 0:
+                break
+            pos = resync
+
+    return records, bad_blocks
+
+
+def print_summary(records, bad_blocks):
+    if not records:
+        print("No records")
+        return
+
+    dropped = sum(max(0, b[0] - a[0] - 1) for a, b in zip(records, records[1:]))
+    span_ms = records[-1][1] - records[0][1]
+    print(f"{len(records)} records, sequence {records[0][0]} - {records[-1][0]}, {dropped} dropped, "
+          f"{bad_blocks} bad blocks")
+    if span_ms > 0:
+        print(f"{span_ms / 1000:.3f} s of data, {1000 * (len(records) - 1) / span_ms:.2f} Hz average")
+
+    gaps = [(a, b) for a, b in zip(records, records[1:]) if b[0] - a[0] > 1]
+    for a, b in gaps[:10]:
+        print(f"  gap of {b[0] - a[0] - 1} records ({b[1] - a[1]} ms) after sequence {a[0]} at {a[1]} ms")
+    if len(gaps) > 10:
+        print(f"  ... and {len(gaps) - 10} more gaps")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode a log written by CFramedDataLogger")
+    parser.add_argument("-i", "--input", required=True, help="Framed log pulled off the module")
+    parser.add_argument("-o", "--output", help="File to write the unframed records to")
+    parser.add_argument("-c", "--csv", help="File to write a CSV of sequence numbers, uptimes and fields to")
+    parser.add_argument("-f", "--files", nargs='+', help="Type YAML files the module was built with (names fields)")
+    parser.add_argument("-r", "--record-size", type=int,
+                        help="Record size, for slices of a log that don't include its header (see log_index.py)")
+    args = parser.parse_args()
+
+    with open(args.input, "rb") as file:
+        data = file.read()
+
+    if args.record_size is not None:
+        record_size, schema_hash, type_name, start = args.record_size, None, "", 0
+        print(f"Decoding a slice with {record_size} byte records")
+    else:
+        record_size, schema_hash, block_size, type_name = read_file_header(data)
+        start = FILE_HEADER_SIZE
+        print(f"{type_name or 'Unnamed type'}: {record_size} byte records in blocks of up to {block_size} bytes")
+
+    fields = None
+    if args.files:
+        layouts = {name: (f, size, schema) for name, f, size, schema in get_layouts(parse_yaml_types(args.files))}
+        if schema_hash is None:
+            print("No header to check the layout against. Fields won't be named")
+        elif type_name not in layouts:
+            print(f"{type_name} is not in the given type files. Fields won't be named")
+        elif layouts[type_name][2] != schema_hash:
+            print(f"Log was written with a different layout of {type_name}. Fields won't be named")
+        else:
+            fields = layouts[type_name][0]
+
+    records, bad_blocks = decode(data, record_size, start)
+    print_summary(records, bad_blocks)
+
+    if args.output:
+        with open(args.output, "wb") as file:
+            for _, _, record in records:
+                file.write(record)
+
+    if args.csv:
+        with open(args.csv, "w", newline="") as file:
+            writer = csv.writer(file)
+            writer.writerow(["Sequence", "UptimeMs"] + ([f[0] for f in fields] if fields else []))
+            for sequence, uptime, record in records:
+                values = [struct.unpack_from("<" + FIELD_FORMATS[(kind, size)], record, offset)[0]
+                          for _, offset, size, kind in fields] if fields else []
+                writer.writerow([sequence, uptime] + values)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,71 @@
+"""
+Reader for the sparse time index kept next to indexed logs (<log>.idx, see detail::log_index_entry in
+f_core/os/c_datalogger.h).
+
+Cuts the part of a log written between two uptimes out of a log pulled off a module. The TFTP server can do the same on
+the device when asked for "<path>@<start ms>-<end ms>", which saves pulling the whole log in the first place.
+"""
+import argparse
+import bisect
+import struct
+
+ENTRY_FORMAT = "<II"
+ENTRY_SIZE = struct.calcsize(ENTRY_FORMAT)
+
+
+def load_index(index_path):
+    """
+    :return: (list of uptimes, list of offsets), both sorted
+    """
+    with open(index_path, "rb") as file:
+        data = file.read()
+
+    entries = [struct.unpack_from(ENTRY_FORMAT, data, i) for i in range(0, len(data) - ENTRY_SIZE + 1, ENTRY_SIZE)]
+    return [e[0] for e in entries], [e[1] for e in entries]
+
+
+def find(uptimes, offsets, uptime_ms):
+    """
+    Binary search the index for a time, the same way the device does
+    :return: (offset of the last entry written at or before uptime_ms (0 if none),
+              offset of the first entry written after it (None if none))
+    """
+    position = bisect.bisect_right(uptimes, uptime_ms)
+    before = offsets[position - 1] if position > 0 else 0
+    after = offsets[position] if position < len(offsets) else None
+    return before, after
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Cut a time range out of an indexed log")
+    parser.add_argument("-i", "--input", required=True, help="Log pulled off the module (its .idx must be next to it)")
+    parser.add_argument("-s", "--start", type=int, default=0, help="Uptime in ms to start at")
+    parser.add_argument("-e", "--end", type=int, default=None, help="Uptime in ms to end at")
+    parser.add_argument("-o", "--output", help="File to write the slice to")
+    args = parser.parse_args()
+
+    uptimes, offsets = load_index(args.input + ".idx")
+    if not uptimes:
+        print("Index is empty")
+        return
+    print(f"{len(uptimes)} index entries covering {uptimes[0]} - {uptimes[-1]} ms")
+
+    start, _ = find(uptimes, offsets, args.start)
+    end = None
+    if args.end is not None:
+        _, end = find(uptimes, offsets, args.end)
+
+    with open(args.input, "rb") as file:
+        file.seek(start)
+        data = file.read() if end is None else file.read(end - start)
+    print(f"Bytes {start} - {start + len(data)} cover {args.start} - {args.end if args.end is not None else 'end'} ms")
+
+    if args.output:
+        # Plain logs are cut on packet boundaries and framed logs on block boundaries (decode with --record-size).
+        # Compressed logs pick up at the first keyframe in the slice
+        with open(args.output, "wb") as file:
+            file.write(data)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,127 @@
+"""
+Decoder for logs written by CMultiStreamLogger (see detail::multi_stream_logger in f_core/os/c_datalogger.h).
+
+Splits the log into one file of plain packed structs per stream (the same as an uncompressed CDataLogger file) for the
+other data_log_check scripts. Optionally writes a CSV per stream of each record's uptime, with its fields if the stream
+is of an autocoded type and the type YAML files are given.
+"""
+import argparse
+import csv
+import os
+import struct
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "autocoders"))
+from ac_types import parse_yaml_types, get_layouts
+
+FILE_HEADER_FORMAT = "<IHH"
+FILE_HEADER_SIZE = struct.calcsize(FILE_HEADER_FORMAT)
+FILE_MAGIC = 0x474F4C4D
+FILE_VERSION = 1
+
+RECORD_HEADER_FORMAT = "<BI"
+RECORD_HEADER_SIZE = struct.calcsize(RECORD_HEADER_FORMAT)
+DEFINITION_STREAM = 0xFF
+
+DEFINITION_FORMAT = "<BHI24s"
+DEFINITION_SIZE = struct.calcsize(DEFINITION_FORMAT)
+
+FIELD_FORMATS = {("Float", 4): "f", ("Float", 8): "d", ("Signed", 1): "b", ("Signed", 2): "h", ("Signed", 4): "i",
+                 ("Signed", 8): "q", ("Unsigned", 1): "B", ("Unsigned", 2): "H", ("Unsigned", 4): "I",
+                 ("Unsigned", 8): "Q"}
+
+
+class Stream:
+    def __init__(self, stream_id, record_size, schema_hash, name):
+        self.stream_id = stream_id
+        self.record_size = record_size
+        self.schema_hash = schema_hash
+        self.name = name
+        self.records = []  # (uptime_ms, record bytes)
+
+
+def decode(data):
+    """
+    Split a multi-stream log into its streams. Stops at the first record that can't be made sense of (usually a record
+    cut short by power loss at the end of the log)
+    :return: dict of stream id to Stream
+    """
+    magic, version, max_streams = struct.unpack_from(FILE_HEADER_FORMAT, data)
+    if magic != FILE_MAGIC or version != FILE_VERSION:
+        raise ValueError("Not a multi-stream log")
+
+    streams = {}
+    pos = FILE_HEADER_SIZE
+    while pos + RECORD_HEADER_SIZE <= len(data):
+        stream_id, uptime = struct.unpack_from(RECORD_HEADER_FORMAT, data, pos)
+        pos += RECORD_HEADER_SIZE
+
+        if stream_id == DEFINITION_STREAM:
+            if pos + DEFINITION_SIZE > len(data):
+                print(f"Stream definition cut short at offset {pos}")
+                break
+            defined_id, record_size, schema_hash, name = struct.unpack_from(DEFINITION_FORMAT, data, pos)
+            pos += DEFINITION_SIZE
+            if defined_id >= max_streams:
+                print(f"Bad stream id {defined_id} defined at offset {pos}. Stopping")
+                break
+            streams[defined_id] = Stream(defined_id, record_size, schema_hash, name.split(b"\0")[0].decode())
+            continue
+
+        if stream_id not in streams:
+            print(f"Record of undefined stream {stream_id} at offset {pos - RECORD_HEADER_SIZE}. Stopping")
+            break
+        stream = streams[stream_id]
+        if pos + stream.record_size > len(data):
+            print(f"Record cut short at offset {pos - RECORD_HEADER_SIZE}")
+            break
+        stream.records.append((uptime, data[pos:pos + stream.record_size]))
+        pos += stream.record_size
+
+    return streams
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Split a log written by CMultiStreamLogger into its streams")
+    parser.add_argument("-i", "--input", required=True, help="Multi-stream log pulled off the module")
+    parser.add_argument("-o", "--output", help="Prefix of the files to write each stream's records to "
+                                               "(<prefix>_<stream name>.bin)")
+    parser.add_argument("-c", "--csv", help="Prefix of the CSVs to write each stream's uptimes and fields to "
+                                            "(<prefix>_<stream name>.csv)")
+    parser.add_argument("-f", "--files", nargs='+', help="Type YAML files the module was built with (names fields)")
+    args = parser.parse_args()
+
+    with open(args.input, "rb") as file:
+        data = file.read()
+
+    streams = decode(data)
+
+    # Streams are matched to their types by schema hash, since a stream's name doesn't have to be its type's
+    layouts = {}
+    if args.files:
+        layouts = {schema: (name, f) for name, f, _, schema in get_layouts(parse_yaml_types(args.files))}
+
+    for stream in streams.values():
+        type_name = layouts[stream.schema_hash][0] if stream.schema_hash in layouts else "unknown type"
+        span = f", {stream.records[0][0]} - {stream.records[-1][0]} ms" if stream.records else ""
+        print(f"Stream {stream.stream_id} '{stream.name}' ({type_name}): {len(stream.records)} records of "
+              f"{stream.record_size} bytes{span}")
+
+        if args.output:
+            with open(f"{args.output}_{stream.name}.bin", "wb") as file:
+                for _, record in stream.records:
+                    file.write(record)
+
+        if args.csv:
+            fields = layouts[stream.schema_hash][1] if stream.schema_hash in layouts else None
+            with open(f"{args.csv}_{stream.name}.csv", "w", newline="") as file:
+                writer = csv.writer(file)
+                writer.writerow(["UptimeMs"] + ([f[0] for f in fields] if fields else []))
+                for uptime, record in stream.records:
+                    values = [struct.unpack_from("<" + FIELD_FORMATS[(kind, size)], record, offset)[0]
+                              for _, offset, size, kind in fields] if fields else []
+                    writer.writerow([uptime] + values)
+
+
+if __name__ == "__main__":
+    main()
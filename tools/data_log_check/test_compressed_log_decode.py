@@ -0,0 +1,207 @@
+"""
+Round trip tests for compressed_log_decode.py against the encoding CCompressedDataLogger writes.
+
+CPP_LOG is what detail::compressed_datalogger wrote for RECORDS, so decoding it checks the C++ float and integer
+encoders against the decoder. The reference encoder here follows the format described in f_core/os/c_datalogger.h,
+and has to reproduce CPP_LOG byte for byte before it is trusted to round trip random records.
+
+Run with: python3 -m unittest discover -s tools/data_log_check
+"""
+import random
+import struct
+import unittest
+
+from compressed_log_decode import (HEADER_FORMAT, HEADER_MAGIC, HEADER_SIZE, HEADER_VERSION, KEYFRAME_MARKER,
+                                   MAX_DELTA_SIZE, NO_WINDOW, crc16_ccitt, decode, load_field)
+
+# One field of every width and kind the encoder handles differently
+RECORD_FORMAT = "<fdhIqB"
+RECORD_SIZE = struct.calcsize(RECORD_FORMAT)
+FIELDS = [
+    ("f", 0, 4, "Float"),
+    ("d", 4, 8, "Float"),
+    ("s", 12, 2, "Signed"),
+    ("u", 14, 4, "Unsigned"),
+    ("l", 18, 8, "Signed"),
+    ("b", 26, 1, "Unsigned"),
+]
+KEYFRAME_INTERVAL = 4
+SCHEMA_HASH = 0x12345678
+
+RECORDS = [
+    (1.5, -2.25, 100, 7, -1, 1),
+    (1.5, -2.25, 100, 7, -1, 1),  # unchanged
+    (1.75, -2.5, 99, 107, 0, 2),  # new float windows, 7 bit deltas
+    (1.625, -2.375, -30000, 60107, 1, 255),  # reused float windows, 16 bit deltas
+    (-1.0e30, 1.0e300, 30000, 4000000000, -2 ** 63, 0),  # keyframe
+    (3.0e-30, -1.0e-300, -32768, 1, 2 ** 63 - 1, 128),  # 32 and 64 bit deltas
+    (3.0e-30, -1.0e-300, 32767, 0xFFFFFFFF, 0, 127),
+]
+
+CPP_LOG = bytes.fromhex(
+    "434c4f4701001b000600040078563412ff4b4652000000000000c03f00000000000002c0640007000000ffffffffffff"
+    "ffff01ac9001000ad40e683c07006440a0400fd41f342fbac9780007530205807e80ff4b465204000000caf249f19c75"
+    "00883ce4377e307500286bee000000000000008000310a20c1eff3a915b81fffc94511a57c4362f0000f52ff80000000"
+    "ee6b27fec070080017380007fffbc00000007fffffff3ffffffffffffffff602")
+
+
+class BitWriter:
+    def __init__(self):
+        self.value = 0
+        self.num_bits = 0
+
+    def put(self, value, num_bits):
+        self.value = (self.value << num_bits) | (value & ((1 << num_bits) - 1))
+        self.num_bits += num_bits
+
+    def to_bytes(self):
+        padding = -self.num_bits % 8
+        return (self.value << padding).to_bytes((self.num_bits + padding) // 8, "big")
+
+
+class ReferenceEncoder:
+    """Encodes records the way detail::compressed_datalogger does"""
+
+    def __init__(self, fields, record_size, keyframe_interval):
+        self.fields = fields
+        self.record_size = record_size
+        self.keyframe_interval = keyframe_interval
+        self.previous = None
+        self.windows = []
+        self.records_written = 0
+
+    def header(self, schema_hash):
+        return struct.pack(HEADER_FORMAT, HEADER_MAGIC, HEADER_VERSION, self.record_size, len(self.fields),
+                           self.keyframe_interval, schema_hash)
+
+    def encode(self, record):
+        encoded = None
+        if self.records_written % self.keyframe_interval != 0:
+            encoded = self.delta(record)
+        if encoded is None:
+            encoded = self.keyframe(record)
+
+        self.previous = record
+        self.records_written += 1
+        return encoded
+
+    def keyframe(self, record):
+        index = struct.pack("<I", self.records_written)
+        self.windows = [(NO_WINDOW, 0)] * len(self.fields)
+        return KEYFRAME_MARKER + index + record + struct.pack("<H", crc16_ccitt(index + record))
+
+    def delta(self, record):
+        writer = BitWriter()
+        windows = list(self.windows)
+        for i, (_, offset, size, kind) in enumerate(self.fields):
+            current = load_field(record, offset, size, kind)
+            prior = load_field(self.previous, offset, size, kind)
+            if kind == "Float":
+                windows[i] = self.encode_float(writer, current, prior, size * 8, windows[i])
+            else:
+                self.encode_integer(writer, current, prior)
+
+        payload = writer.to_bytes()
+        if len(payload) > MAX_DELTA_SIZE:
+            return None
+        self.windows = windows
+        return bytes([len(payload)]) + payload
+
+    @staticmethod
+    def encode_float(writer, current, prior, width, window):
+        xored = current ^ prior
+        if xored == 0:
+            writer.put(0b0, 1)
+            return window
+
+        leading = width - xored.bit_length()
+        trailing = (xored & -xored).bit_length() - 1
+        window_bits = 5 if width == 32 else 6
+        if window[0] != NO_WINDOW and leading >= window[0] and trailing >= window[1]:
+            writer.put(0b10, 2)
+            writer.put(xored >> window[1], width - window[0] - window[1])
+            return window
+
+        meaningful = width - leading - trailing
+        writer.put(0b11, 2)
+        writer.put(leading, window_bits)
+        writer.put(meaningful - 1, window_bits)
+        writer.put(xored >> trailing, meaningful)
+        return leading, trailing
+
+    @staticmethod
+    def encode_integer(writer, current, prior):
+        delta = (current - prior) & 0xFFFFFFFFFFFFFFFF
+        signed = delta - (1 << 64) if delta >> 63 else delta
+        zigzag = ((signed << 1) ^ (signed >> 63)) & 0xFFFFFFFFFFFFFFFF
+        if zigzag == 0:
+            writer.put(0b0, 1)
+        elif zigzag < 1 << 7:
+            writer.put(0b10, 2)
+            writer.put(zigzag, 7)
+        elif zigzag < 1 << 16:
+            writer.put(0b110, 3)
+            writer.put(zigzag, 16)
+        elif zigzag < 1 << 32:
+            writer.put(0b1110, 4)
+            writer.put(zigzag, 32)
+        else:
+            writer.put(0b1111, 4)
+            writer.put(zigzag, 64)
+
+
+def pack(records):
+    return [struct.pack(RECORD_FORMAT, *record) for record in records]
+
+
+def encode(records):
+    encoder = ReferenceEncoder(FIELDS, RECORD_SIZE, KEYFRAME_INTERVAL)
+    return encoder.header(SCHEMA_HASH) + b"".join(encoder.encode(record) for record in records)
+
+
+class CompressedLogDecodeTest(unittest.TestCase):
+    def test_decodes_cpp_log(self):
+        records = decode(CPP_LOG, FIELDS, RECORD_SIZE)
+        self.assertEqual([index for index, _ in records], list(range(len(RECORDS))))
+        self.assertEqual([record for _, record in records], pack(RECORDS))
+
+    def test_reference_encoder_matches_cpp(self):
+        self.assertEqual(encode(pack(RECORDS)), CPP_LOG)
+
+    def test_random_round_trip(self):
+        rng = random.Random(1)
+        records = []
+        values = [0.0, 0.0, 0, 0, 0, 0]
+        for _ in range(2000):
+            # Mostly small steps like sensor data, with the odd jump across the whole range
+            if rng.random() < 0.05:
+                values = [rng.uniform(-1e30, 1e30), rng.uniform(-1e300, 1e300), rng.randint(-2 ** 15, 2 ** 15 - 1),
+                          rng.randint(0, 2 ** 32 - 1), rng.randint(-2 ** 63, 2 ** 63 - 1), rng.randint(0, 255)]
+            else:
+                values[0] += rng.gauss(0, 0.01) if rng.random() < 0.8 else 0
+                values[1] += rng.gauss(0, 0.01)
+                values[2] = max(-2 ** 15, min(2 ** 15 - 1, values[2] + rng.randint(-3, 3)))
+                values[3] = (values[3] + rng.randint(0, 1000)) % 2 ** 32
+                values[4] = max(-2 ** 63, min(2 ** 63 - 1, values[4] + rng.randint(-2 ** 40, 2 ** 40)))
+                values[5] = (values[5] + 1) % 256
+            records.append(struct.pack(RECORD_FORMAT, *values))
+
+        decoded = decode(encode(records), FIELDS, RECORD_SIZE)
+        self.assertEqual([index for index, _ in decoded], list(range(len(records))))
+        self.assertEqual([record for _, record in decoded], records)
+
+    def test_slice_starts_at_first_keyframe(self):
+        keyframe = CPP_LOG.find(KEYFRAME_MARKER, HEADER_SIZE + 1)
+        records = decode(CPP_LOG[keyframe - 3:], FIELDS, RECORD_SIZE, start=0)
+        self.assertEqual([index for index, _ in records], [4, 5, 6])
+        self.assertEqual([record for _, record in records], pack(RECORDS[4:]))
+
+    def test_resyncs_after_corruption(self):
+        corrupted = bytearray(CPP_LOG)
+        corrupted[HEADER_SIZE + len(KEYFRAME_MARKER) + 4 + RECORD_SIZE + 2] = 0  # length byte of the first delta
+        records = decode(bytes(corrupted), FIELDS, RECORD_SIZE)
+        self.assertEqual([index for index, _ in records], [0, 4, 5, 6])
+
+
+if __name__ == "__main__":
+    unittest.main()
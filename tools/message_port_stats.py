@@ -0,0 +1,44 @@
+import socket
+import struct
+import sys
+
+# Matches MessagePortStatsSnapshot in include/f_core/messaging/c_message_port_stats.h
+NAME_SIZE = 16
+LATENCY_BUCKETS = 24
+SNAPSHOT_FORMAT = f"<{NAME_SIZE}s5I{LATENCY_BUCKETS}I"
+SNAPSHOT_SIZE = struct.calcsize(SNAPSHOT_FORMAT)
+
+
+def format_snapshot(data):
+    fields = struct.unpack(SNAPSHOT_FORMAT, data)
+    name = fields[0].split(b"\0", 1)[0].decode(errors="replace")
+    sends, receives, drops, depth, max_depth = fields[1:6]
+    latencies = fields[6:]
+
+    used = len(latencies)
+    while used > 0 and latencies[used - 1] == 0:
+        used -= 1
+    histogram = " ".join(f"<{2 << i}us:{latencies[i]}" for i in range(used))
+
+    return (f"{name:<16} sent {sends:>8} received {receives:>8} dropped {drops:>6} depth {depth:>3} (max {max_depth:>3})"
+            f"  {histogram}")
+
+
+def listen(port):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    sock.bind(("", port))
+
+    while True:
+        data, (address, _) = sock.recvfrom(1024)
+        if len(data) != SNAPSHOT_SIZE:
+            continue
+        print(f"{address:<15} {format_snapshot(data)}")
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 2:
+        print("Usage: python message_port_stats.py <port>")
+        sys.exit(1)
+
+    listen(int(sys.argv[1]))
@@ -0,0 +1,45 @@
+import socket
+import struct
+import sys
+
+# Matches TenantProfileSnapshot in include/f_core/os/c_tenant_profile.h
+NAME_SIZE = 24
+DURATION_BUCKETS = 20
+SNAPSHOT_FORMAT = f"<{NAME_SIZE}s{NAME_SIZE}s4I{DURATION_BUCKETS}I"
+SNAPSHOT_SIZE = struct.calcsize(SNAPSHOT_FORMAT)
+
+
+def format_snapshot(data):
+    fields = struct.unpack(SNAPSHOT_FORMAT, data)
+    task = fields[0].split(b"\0", 1)[0].decode(errors="replace")
+    tenant = fields[1].split(b"\0", 1)[0].decode(errors="replace")
+    calls, min_us, mean_us, max_us = fields[2:6]
+    durations = fields[6:]
+
+    used = len(durations)
+    while used > 0 and durations[used - 1] == 0:
+        used -= 1
+    histogram = " ".join(f"<{2 << i}us:{durations[i]}" for i in range(used))
+
+    return (f"{task:<18} {tenant:<26} runs {calls:>9} min {min_us:>7}us mean {mean_us:>7}us max {max_us:>7}us"
+            f"  {histogram}")
+
+
+def listen(port):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    sock.bind(("", port))
+
+    while True:
+        data, (address, _) = sock.recvfrom(1024)
+        if len(data) != SNAPSHOT_SIZE:
+            continue
+        print(f"{address:<15} {format_snapshot(data)}")
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 2:
+        print("Usage: python tenant_profile.py <port>")
+        sys.exit(1)
+
+    listen(int(sys.argv[1]))